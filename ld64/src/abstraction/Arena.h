@@ -0,0 +1,165 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+#ifndef __ARENA_ABSTRACTION_H__
+#define __ARENA_ABSTRACTION_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+
+namespace ld {
+
+//
+// Bump allocator for data that lives as long as the owner of the arena.
+// Nothing allocated from an arena is freed or destructed on its own, all chunks
+// are released together when the arena is destroyed.  An arena is not thread safe.
+// Objects that live until the linker exits come from a per-thread arena instead.
+//
+// Chunks start small and double up to kMaxChunkSize, so small input files do not
+// reserve much more than they use.
+//
+class Arena
+{
+public:
+	enum { kDefaultChunkSize = 16*1024, kMaxChunkSize = 1024*1024 };
+
+	struct Statistics {
+		std::atomic<int64_t>	allocations;
+		std::atomic<int64_t>	bytesAllocated;
+		std::atomic<int64_t>	bytesReserved;
+		std::atomic<int32_t>	chunks;
+	};
+
+						Arena(size_t chunkSize=kDefaultChunkSize) : _chunkSize(chunkSize) { }
+						~Arena();
+						Arena(const Arena&) = delete;
+	Arena&				operator=(const Arena&) = delete;
+
+	void*				allocate(size_t size, size_t alignment=alignof(max_align_t));
+	template <typename T>
+	T*					allocateArray(size_t count);
+
+	// for objects that live until the linker exits, safe to call from any thread
+	static void*		allocateGlobal(size_t size);
+
+	// totals for all arenas, only counted after collectStatistics() (-print_statistics)
+	static void			collectStatistics() { _s_collectStatistics = true; }
+	static const Statistics& statistics() { return _s_statistics; }
+
+private:
+	struct Chunk {
+		Chunk*			next;
+		size_t			size;
+	};
+
+	void*				allocateInNewChunk(size_t size, size_t alignment);
+
+	size_t				_chunkSize;
+	Chunk*				_chunks		= nullptr;
+	uint8_t*			_cursor		= nullptr;
+	uint8_t*			_end		= nullptr;
+
+	static inline Statistics		_s_statistics = { {0}, {0}, {0}, {0} };
+	static inline bool				_s_collectStatistics = false;
+};
+
+
+inline Arena::~Arena()
+{
+	for (Chunk* chunk = _chunks; chunk != nullptr; ) {
+		Chunk* next = chunk->next;
+		::free(chunk);
+		chunk = next;
+	}
+}
+
+inline void* Arena::allocate(size_t size, size_t alignment)
+{
+	if ( _s_collectStatistics ) {
+		_s_statistics.allocations.fetch_add(1, std::memory_order_relaxed);
+		_s_statistics.bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+	}
+	uintptr_t start = ((uintptr_t)_cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	if ( (_cursor != nullptr) && (start + size <= (uintptr_t)_end) ) {
+		_cursor = (uint8_t*)(start + size);
+		return (void*)start;
+	}
+	return allocateInNewChunk(size, alignment);
+}
+
+template <typename T>
+inline T* Arena::allocateArray(size_t count)
+{
+	size_t size;
+	if ( __builtin_mul_overflow(count, sizeof(T), &size) )
+		throw "arena allocation overflow";
+	return (T*)allocate(size, alignof(T));
+}
+
+inline void* Arena::allocateInNewChunk(size_t size, size_t alignment)
+{
+	// large requests get a chunk of their own so the rest of the current chunk is not wasted
+	const bool dedicated = (size > _chunkSize/4);
+	size_t chunkSize = sizeof(Chunk) + alignment + (dedicated ? size : _chunkSize);
+	Chunk* chunk = (Chunk*)::malloc(chunkSize);
+	if ( chunk == nullptr )
+		throw "out of memory";
+	chunk->size = chunkSize;
+	if ( _s_collectStatistics ) {
+		_s_statistics.chunks.fetch_add(1, std::memory_order_relaxed);
+		_s_statistics.bytesReserved.fetch_add(chunkSize, std::memory_order_relaxed);
+	}
+
+	uint8_t* chunkStart = (uint8_t*)(chunk + 1);
+	uintptr_t start = ((uintptr_t)chunkStart + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	if ( dedicated && (_chunks != nullptr) ) {
+		chunk->next = _chunks->next;
+		_chunks->next = chunk;
+	}
+	else {
+		chunk->next = _chunks;
+		_chunks = chunk;
+		_cursor = (uint8_t*)(start + size);
+		_end = (uint8_t*)chunk + chunkSize;
+		_chunkSize = std::max(_chunkSize, std::min(2*_chunkSize, (size_t)kMaxChunkSize));
+	}
+	return (void*)start;
+}
+
+inline void* Arena::allocateGlobal(size_t size)
+{
+	// one arena per thread, so passes and parsers on different threads never contend.
+	// The arenas are never destroyed, like the objects allocated from them.
+	static thread_local Arena* threadArena = nullptr;
+	if ( threadArena == nullptr )
+		threadArena = new Arena();
+	return threadArena->allocate(size);
+}
+
+} // namespace ld
+
+#endif // __ARENA_ABSTRACTION_H__
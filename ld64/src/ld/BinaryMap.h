@@ -0,0 +1,81 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#ifndef __BINARY_MAP_H__
+#define __BINARY_MAP_H__
+
+#include <stdint.h>
+
+namespace ld {
+namespace binarymap {
+
+//
+// Layout of the file written by -binary_map, read by ld-map.  The file is meant to be
+// mapped: a header followed by tables that are each 8 byte aligned and in host byte order.
+// Atoms are stored by column, so a query only touches the columns it needs.  Atoms in
+// the output come first, in section and address order, followed by dead stripped atoms.
+// Names and paths are offsets into a pool of zero terminated strings.
+//
+
+static const char		kMagic[8]		= { 'l', 'd', '6', '4', 'm', 'a', 'p', '\0' };
+static const uint32_t	kVersion		= 1;
+static const uint32_t	kNone			= 0xFFFFFFFF;	// no section (dead atom), or no atom
+
+struct Header
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	atomCount;
+	uint32_t	deadAtomCount;		// included in atomCount, at the end
+	uint32_t	sectionCount;
+	uint32_t	fileCount;			// file 0 is "linker synthesized"
+	uint32_t	outputPath;			// string offset
+	uint32_t	arch;				// string offset
+	uint32_t	reserved;
+	uint64_t	sectionsOffset;		// Section[sectionCount]
+	uint64_t	filesOffset;		// uint32_t[fileCount], string offset of each path
+	uint64_t	addressesOffset;	// uint64_t[atomCount], 0 for dead atoms
+	uint64_t	sizesOffset;		// uint64_t[atomCount]
+	uint64_t	namesOffset;		// uint32_t[atomCount], string offset
+	uint64_t	sectionIndexesOffset;	// uint32_t[atomCount], kNone for dead atoms
+	uint64_t	fileIndexesOffset;	// uint32_t[atomCount]
+	uint64_t	aliasOfOffset;		// uint32_t[atomCount], atom this one is an alias of, or kNone
+	uint64_t	liveReferrersOffset;	// uint32_t[atomCount], atom that kept this one when dead stripping, or kNone
+	uint64_t	stringsOffset;
+	uint64_t	stringsSize;
+};
+
+struct Section
+{
+	uint64_t	address;
+	uint64_t	size;
+	uint32_t	segmentName;		// string offset
+	uint32_t	sectionName;		// string offset
+};
+
+} // namespace binarymap
+} // namespace ld
+
+#endif // __BINARY_MAP_H__
@@ -70,6 +70,7 @@
 #include "Containers.h"
 #include "Snapshot.h"
 #include "FatFile.h"
+#include "TraceEvents.h"
 
 const bool _s_logPThreads = false;
 
@@ -231,6 +232,8 @@ const char* InputFiles::extractFileInfo(const uint8_t* p, unsigned len, const ch
 
 ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib)
 {
+	const char* leafName = strrchr(info.path, '/');
+	TraceSpan span((leafName != NULL) ? leafName+1 : info.path, "parse", info.path);
 	bool fromSDK = _options.fromSDK(info.path);
 	// handle inlined framework first.
 	if (info.isInlined) {
@@ -433,6 +436,7 @@ ld::File* InputFiles::makeFile(const Options::FileInfo& info, bool indirectDylib
 	archOpts.objcABI2				= _options.objCABIVersion2POverride();
 	archOpts.verboseLoad			= _options.whyLoad();
 	archOpts.logAllFiles			= _options.logAllFiles();
+	archOpts.indexCachePath			= _options.archiveIndexCachePath();
 	// Set ObjSource Kind, libclang_rt is compiler static library
 	if ( isCompilerSupportLib(info.path) )
 		archOpts.objOpts.srcKind = ld::relocatable::File::kSourceCompilerArchive;
@@ -614,7 +618,9 @@ ld::dylib::File* InputFiles::findDylib(const char* installPath, const ld::dylib:
 		info.ordinal = _indirectDylibOrdinal;
 		info.options.fIndirectDylib = true;
 		try {
-			ld::File* reader = this->makeFile(info, true);
+			ld::File* reader = this->claimPrefetchedDylib(installPath, info);
+			if ( reader == NULL )
+				reader = this->makeFile(info, true);
 			ld::dylib::File* dylibReader = dynamic_cast<ld::dylib::File*>(reader);
 			if ( dylibReader != NULL ) {
 				//assert(_installPathToDylibs.find(installPath) !=  _installPathToDylibs.end());
@@ -790,6 +796,73 @@ void InputFiles::addLinkerOptionLibraries(ld::Internal& state, ld::File::AtomHan
 	}
 }
 
+// Parse the dylibs this round of createIndirectDylibs() is about to ask for on all cores.
+// The search for each file stays serial and findDylib() still adopts them one at a time
+// in the usual order, so ordinals and -t output do not change.
+void InputFiles::prefetchIndirectDylibs(const std::vector<ld::dylib::File*>& dylibs)
+{
+	// file searches have side effects that must stay in findDylib() order
+	if ( _options.dumpDependencyInfo() || _options.traceDylibSearching() )
+		return;
+
+	__block std::vector<std::string>		installPaths;
+	__block std::vector<Options::FileInfo>	infos;
+	for (ld::dylib::File* dylib : dylibs) {
+		dylib->forEachDependentDylib(^(const char* installPath) {
+			if ( _installPathToDylibs.count(installPath) || _prefetchedDylibs.count(installPath) )
+				return;
+			if ( std::find(installPaths.begin(), installPaths.end(), installPath) != installPaths.end() )
+				return;
+			for (const Options::DylibOverride& dylibOverride : _options.dylibOverrides()) {
+				if ( strcmp(dylibOverride.installName, installPath) == 0 )
+					return;
+			}
+			try {
+				Options::FileInfo info = _options.findIndirectDylib(installPath, dylib);
+				info.ordinal = _indirectDylibOrdinal;
+				info.options.fIndirectDylib = true;
+				installPaths.push_back(installPath);
+				infos.push_back(info);
+			}
+			catch (const char*) {
+				// leave it to findDylib() to report
+			}
+		});
+	}
+	if ( infos.size() < 2 )
+		return;
+
+	std::vector<ld::File*> parsed(infos.size(), NULL);
+	ld::File** files = parsed.data();
+	dispatch_apply(infos.size(), DISPATCH_APPLY_AUTO, ^(size_t index) {
+		try {
+			files[index] = this->makeFile(infos[index], true);
+		}
+		catch (const char*) {
+			// findDylib() will parse it again and report the error in order
+		}
+	});
+	for (size_t i=0; i < infos.size(); ++i) {
+		if ( files[i] != NULL )
+			_prefetchedDylibs[installPaths[i]] = { infos[i].path, files[i] };
+	}
+}
+
+ld::dylib::File* InputFiles::claimPrefetchedDylib(const char* installPath, const Options::FileInfo& info)
+{
+	auto pos = _prefetchedDylibs.find(installPath);
+	if ( pos == _prefetchedDylibs.end() )
+		return NULL;
+	PrefetchedDylib prefetched = pos->second;
+	_prefetchedDylibs.erase(pos);
+	if ( strcmp(prefetched.path, info.path) != 0 )
+		return NULL;
+	ld::dylib::File* dylib = dynamic_cast<ld::dylib::File*>(prefetched.file);
+	if ( dylib != NULL )
+		dylib->setOrdinal(info.ordinal);
+	return dylib;
+}
+
 void InputFiles::createIndirectDylibs()
 {	
 	// keep processing dylibs until no more dylibs are added
@@ -805,6 +878,7 @@ void InputFiles::createIndirectDylibs()
 		std::sort(unprocessedDylibs.begin(), unprocessedDylibs.end(), [](const ld::dylib::File* lhs, const ld::dylib::File* rhs) {
 			return strcmp(lhs->path(), rhs->path()) < 0;
 		});
+		this->prefetchIndirectDylibs(unprocessedDylibs);
 		for (ld::dylib::File* dylib : unprocessedDylibs) {
 			dylib->processIndirectLibraries(this, _options.implicitlyLinkIndirectPublicDylibs());
 			assert(dylib->indirectLibrariesProcessed() && "Internal error, dylib has indirect libraries processed but it's not marked");
@@ -1139,6 +1213,17 @@ void InputFiles::parseWorkerThread(InputFiles *inputFiles) {
 #endif
 
 
+void InputFiles::forEachLibrary(void (^handler)(const ld::File* file)) const
+{
+	for (ld::dylib::File* dylib : _allDylibs)
+		handler(dylib);
+	for (const LibraryInfo& lib : _searchLibraries) {
+		if ( !lib.isDylib() )
+			handler(lib.archive());
+	}
+}
+
+
 ld::File* InputFiles::addDylib(ld::dylib::File* reader, const Options::FileInfo& info)
 {
 	_allDylibs.insert(reader);
@@ -1270,6 +1355,14 @@ void InputFiles::waitForInputFiles(InputFiles *inputFiles) {
 #endif
 
 
+void InputFiles::forEachInitialObjectAtom(ld::File::AtomHandler& handler) const
+{
+	for (ld::File* file : _inputFiles) {
+		if ( file->type() == ld::File::Reloc )
+			file->forEachAtom(handler);
+	}
+}
+
 void InputFiles::forEachInitialAtom(ld::File::AtomHandler& handler, ld::Internal& state)
 {
 	// add all direct object, archives, and dylibs
@@ -64,12 +64,16 @@ public:
 	
 	// iterates all atoms in initial files
 	void						forEachInitialAtom(ld::File::AtomHandler&, ld::Internal& state);
+	// iterates atoms of object files on the command line, without loading anything
+	void						forEachInitialObjectAtom(ld::File::AtomHandler&) const;
 	// searches libraries for name
 	bool						searchLibraries(const char* name, bool searchDylibs, bool searchArchives,  
 																  bool dataSymbolOnly, ld::File::AtomHandler&) const;
 	// copy dylibs to link with in command line order
 	void						dylibs(ld::Internal& state);
 	const std::set<ld::dylib::File*>&		getAllDylibs() const { return _allDylibs; }
+	// iterates all dylibs and archives that were loaded, including indirect and auto-linked ones
+	void						forEachLibrary(void (^handler)(const ld::File* file)) const;
 	
 	void						archives(ld::Internal& state);
 
@@ -99,6 +103,8 @@ private:
 	void						createOpaqueFileSections();
 	bool						libraryAlreadyLoaded(const char* path);
 	bool						frameworkAlreadyLoaded(const char* path, const char* frameworkName);
+	void						prefetchIndirectDylibs(const std::vector<ld::dylib::File*>& dylibs);
+	ld::dylib::File*			claimPrefetchedDylib(const char* installPath, const Options::FileInfo& info);
 
 	// for pipelined linking
     void						waitForInputFiles();
@@ -118,6 +124,9 @@ private:
 	InstallNameToDylib			_installPathToDylibs;
 	std::set<ld::dylib::File*>	_allDylibs;
 	uint64_t					_numProcessedIndirectDylibs = 0;
+	// indirect dylibs parsed ahead of time, keyed by install path, until findDylib() asks for them
+	struct PrefetchedDylib { const char* path; ld::File* file; };
+	std::map<std::string, PrefetchedDylib>	_prefetchedDylibs;
 	ld::dylib::File*			_bundleLoader;
     struct strcompclass {
         bool operator() (const char *a, const char *b) const { return ::strcmp(a, b) < 0; }
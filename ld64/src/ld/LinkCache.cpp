@@ -0,0 +1,559 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <crt_externs.h>
+#include <mach-o/dyld.h>
+#include <copyfile.h>
+#include <dispatch/dispatch.h>
+#include <CommonCrypto/CommonDigest.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "LinkCache.h"
+#include "InputFiles.h"
+
+#define VAL(x) #x
+#define STRINGIFY(x) VAL(x)
+
+namespace ld {
+namespace tool {
+
+static const char* const kManifestMagic	= "ld64-incremental-link-cache v2";
+static const char* const kManifestName	= "manifest";
+static const char* const kOutputName	= "output";
+
+
+LinkCache::LinkCache(const Options& opts, int argc, const char* argv[])
+	: _options(opts), _cacheDir(opts.incrementalCachePath()), _missReason(NULL), _hashedBytes(0)
+{
+	if ( (mkdir(_cacheDir.c_str(), S_IRWXU|S_IRWXG|S_IRWXO) != 0) && (errno != EEXIST) )
+		throwf("can't create -incremental_cache_path directory '%s', errno=%d", _cacheDir.c_str(), errno);
+
+	// hash every command line input file in parallel
+	std::vector<std::string> paths;
+	for (const Options::FileInfo& info : _options.getInputFiles())
+		paths.push_back(info.path);
+	digestFiles(paths, _inputs);
+
+	// files read by options (export lists, order files, -sectcreate data, ...) and
+	// the libLTO that would be loaded can change the output just like an input file
+	std::vector<std::string> optionPaths = _options.referencedFiles();
+	optionPaths.push_back(libLTOPath());
+	std::vector<FileEntry> optionFiles;
+	digestFiles(optionPaths, optionFiles);
+
+	// the key covers everything that can change the output without changing an input file
+	CC_SHA256_CTX ctx;
+	CC_SHA256_Init(&ctx);
+	CC_SHA256_Update(&ctx, kManifestMagic, (CC_LONG)strlen(kManifestMagic)+1);
+#ifdef LD64_VERSION_NUM
+	const char* version = STRINGIFY(LD64_VERSION_NUM);
+	CC_SHA256_Update(&ctx, version, (CC_LONG)strlen(version)+1);
+#endif
+	char cwd[PATH_MAX];
+	if ( getcwd(cwd, sizeof(cwd)) != NULL )
+		CC_SHA256_Update(&ctx, cwd, (CC_LONG)strlen(cwd)+1);
+	for (int i=0; i < argc; ++i) {
+		CC_SHA256_Update(&ctx, argv[i], (CC_LONG)strlen(argv[i])+1);
+		// response files are expanded by Options, so their content is part of the command line
+		if ( argv[i][0] == '@' ) {
+			Digest responseFileDigest;
+			if ( digestFile(&argv[i][1], responseFileDigest) )
+				CC_SHA256_Update(&ctx, responseFileDigest.bytes, sizeof(Digest));
+		}
+	}
+	std::vector<const char*> envVars;
+	for (char** env = *_NSGetEnviron(); *env != NULL; ++env) {
+		const char* var = *env;
+		const char* equals = strchr(var, '=');
+		if ( equals == NULL )
+			continue;
+		std::string_view name(var, equals - var);
+		if ( name.starts_with("LD_") || name.starts_with("RC_") || name.ends_with("_DEPLOYMENT_TARGET")
+				|| (name == "SDKROOT") || (name == "ZERO_AR_DATE") )
+			envVars.push_back(var);
+	}
+	std::sort(envVars.begin(), envVars.end(), [](const char* l, const char* r) { return strcmp(l, r) < 0; });
+	for (const char* var : envVars)
+		CC_SHA256_Update(&ctx, var, (CC_LONG)strlen(var)+1);
+	for (const FileEntry& entry : _inputs)
+		CC_SHA256_Update(&ctx, entry.digest.bytes, sizeof(Digest));
+	for (const FileEntry& entry : optionFiles) {
+		CC_SHA256_Update(&ctx, entry.path.c_str(), (CC_LONG)entry.path.size()+1);
+		CC_SHA256_Update(&ctx, entry.digest.bytes, sizeof(Digest));
+	}
+	Digest key;
+	CC_SHA256_Final(key.bytes, &ctx);
+	_key = hexString(key);
+
+	// warnings from here on are stored with the entry, so a cache hit can repeat them
+	recordWarnings(&_warnings);
+}
+
+
+std::string LinkCache::libLTOPath() const
+{
+	// same lookup as lto_file.cpp, where @rpath is the lib directory next to ld
+	if ( _options.overridePathlibLTO() != NULL )
+		return _options.overridePathlibLTO();
+	char ldPath[PATH_MAX];
+	char realLdPath[PATH_MAX];
+	uint32_t bufSize = PATH_MAX;
+	if ( (_NSGetExecutablePath(ldPath, &bufSize) == -1) || (realpath(ldPath, realLdPath) == NULL) )
+		return "libLTO.dylib";
+	std::string path = realLdPath;
+	path.erase(path.rfind('/'));
+	return path + "/../lib/libLTO.dylib";
+}
+
+
+bool LinkCache::outputCanBeReused()
+{
+	// side outputs of a link are not stored in the cache
+	if ( _options.generatedMapPath() != NULL ) {
+		_missReason = "-map is used";
+		return false;
+	}
+	if ( _options.binaryMapPath() != NULL ) {
+		_missReason = "-binary_map is used";
+		return false;
+	}
+	if ( _options.dumpDependencyInfo() ) {
+		_missReason = "-dependency_info is used";
+		return false;
+	}
+	if ( _options.reverseSymbolMapPath() != NULL ) {
+		_missReason = "-bitcode_symbol_map is used";
+		return false;
+	}
+	if ( _options.tempLtoObjectPath() != NULL ) {
+		_missReason = "-object_path_lto is used";
+		return false;
+	}
+	if ( _options.UUIDMode() == Options::kUUIDRandom ) {
+		_missReason = "-random_uuid is used";
+		return false;
+	}
+	if ( _options.logAllFiles() || _options.traceDylibs() || _options.traceArchives() || (_options.traceOutputFile() != NULL) ) {
+		_missReason = "input files are traced";
+		return false;
+	}
+	if ( _options.whyLoad() || _options.printWhyLive() || _options.printOrderFileStatistics() ) {
+		_missReason = "-why_load, -why_live or -order_file_statistics is used";
+		return false;
+	}
+	struct stat statBuf;
+	if ( (stat(_options.outputFilePath(), &statBuf) == 0) && !S_ISREG(statBuf.st_mode) ) {
+		_missReason = "output is not a regular file";
+		return false;
+	}
+	return true;
+}
+
+
+bool LinkCache::digestFile(const char* path, Digest& digest)
+{
+	int fd = ::open(path, O_RDONLY, 0);
+	if ( fd == -1 )
+		return false;
+	struct stat statBuf;
+	if ( ::fstat(fd, &statBuf) != 0 ) {
+		::close(fd);
+		return false;
+	}
+	if ( statBuf.st_size == 0 ) {
+		::close(fd);
+		CC_SHA256(NULL, 0, digest.bytes);
+		return true;
+	}
+	void* p = ::mmap(NULL, statBuf.st_size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if ( p == MAP_FAILED )
+		return false;
+	CC_SHA256(p, (CC_LONG)statBuf.st_size, digest.bytes);
+	::munmap(p, statBuf.st_size);
+	__sync_fetch_and_add(&_hashedBytes, (uint64_t)statBuf.st_size);
+	return true;
+}
+
+
+void LinkCache::digestFiles(const std::vector<std::string>& paths, std::vector<FileEntry>& entries)
+{
+	entries.resize(paths.size());
+	dispatch_apply(paths.size(), DISPATCH_APPLY_AUTO, ^(size_t index) {
+		FileEntry& entry = entries[index];
+		entry.path = paths[index];
+		// a missing file gets an all zero digest, which never matches a real file
+		if ( !digestFile(entry.path.c_str(), entry.digest) )
+			bzero(entry.digest.bytes, sizeof(Digest));
+	});
+}
+
+
+std::string LinkCache::hexString(const Digest& digest)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+	std::string result;
+	result.reserve(2*sizeof(Digest));
+	for (uint8_t byte : digest.bytes) {
+		result.push_back(hexDigits[byte >> 4]);
+		result.push_back(hexDigits[byte & 0xF]);
+	}
+	return result;
+}
+
+
+bool LinkCache::parseHexString(const char* str, Digest& digest)
+{
+	for (unsigned i=0; i < sizeof(Digest); ++i) {
+		unsigned value;
+		if ( sscanf(&str[2*i], "%2x", &value) != 1 )
+			return false;
+		digest.bytes[i] = value;
+	}
+	return true;
+}
+
+
+std::string LinkCache::entryDir(const std::string& key) const
+{
+	return _cacheDir + "/" + key;
+}
+
+
+std::string LinkCache::lastLinkPath() const
+{
+	// remembers which entry was last used for this output so changes can be reported
+	Digest outputDigest;
+	const char* outputPath = _options.outputFilePath();
+	char realOutputPath[PATH_MAX];
+	if ( realpath(outputPath, realOutputPath) != NULL )
+		outputPath = realOutputPath;
+	CC_SHA256(outputPath, (CC_LONG)strlen(outputPath), outputDigest.bytes);
+	return _cacheDir + "/last-" + hexString(outputDigest).substr(0, 16);
+}
+
+
+bool LinkCache::readManifest(const std::string& path, Manifest& manifest) const
+{
+	FILE* file = fopen(path.c_str(), "r");
+	if ( file == NULL )
+		return false;
+	bool valid = false;
+	char* line = NULL;
+	size_t lineCapacity = 0;
+	if ( (getline(&line, &lineCapacity, file) != -1) && (strncmp(line, kManifestMagic, strlen(kManifestMagic)) == 0) ) {
+		valid = true;
+		ssize_t len;
+		while ( valid && ((len = getline(&line, &lineCapacity, file)) != -1) ) {
+			if ( (len > 0) && (line[len-1] == '\n') )
+				line[len-1] = '\0';
+			if ( strncmp(line, "output ", 7) == 0 ) {
+				manifest.outputSize = strtoull(&line[7], NULL, 10);
+			}
+			else if ( (strncmp(line, "input ", 6) == 0) || (strncmp(line, "library ", 8) == 0) ) {
+				const bool isInput = (line[0] == 'i');
+				const char* hex = &line[isInput ? 6 : 8];
+				FileEntry entry;
+				valid = (strlen(hex) > 2*sizeof(Digest)+1) && parseHexString(hex, entry.digest);
+				if ( valid ) {
+					entry.path = &hex[2*sizeof(Digest)+1];
+					(isInput ? manifest.inputs : manifest.libraries).push_back(entry);
+				}
+			}
+			else if ( strncmp(line, "section ", 8) == 0 ) {
+				char segName[32];
+				char sectName[32];
+				unsigned long long address, size, fileOffset;
+				valid = (sscanf(&line[8], "%31s %31s 0x%llX 0x%llX 0x%llX", segName, sectName, &address, &size, &fileOffset) == 5);
+				if ( valid )
+					manifest.sections.push_back({ segName, sectName, address, size, fileOffset });
+			}
+			else if ( strncmp(line, "warning ", 8) == 0 ) {
+				// undo the escaping done by writeManifest()
+				std::string msg;
+				for (const char* p = &line[8]; *p != '\0'; ++p) {
+					if ( (p[0] == '\\') && (p[1] == 'n') ) {
+						msg.push_back('\n');
+						++p;
+					}
+					else if ( (p[0] == '\\') && (p[1] == '\\') ) {
+						msg.push_back('\\');
+						++p;
+					}
+					else {
+						msg.push_back(*p);
+					}
+				}
+				manifest.warnings.push_back(msg);
+			}
+		}
+	}
+	free(line);
+	fclose(file);
+	return valid;
+}
+
+
+void LinkCache::writeManifest(const std::string& path, const Manifest& manifest) const
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if ( file == NULL )
+		throwf("can't create %s, errno=%d", path.c_str(), errno);
+	fprintf(file, "%s\n", kManifestMagic);
+	fprintf(file, "output %llu\n", manifest.outputSize);
+	for (const FileEntry& entry : manifest.inputs)
+		fprintf(file, "input %s %s\n", hexString(entry.digest).c_str(), entry.path.c_str());
+	for (const FileEntry& entry : manifest.libraries)
+		fprintf(file, "library %s %s\n", hexString(entry.digest).c_str(), entry.path.c_str());
+	for (const SectionEntry& entry : manifest.sections)
+		fprintf(file, "section %s %s 0x%llX 0x%llX 0x%llX\n", entry.segment.c_str(), entry.section.c_str(), entry.address, entry.size, entry.fileOffset);
+	for (const std::string& msg : manifest.warnings) {
+		// one warning per line, so escape newlines and the escape character
+		fputs("warning ", file);
+		for (char c : msg) {
+			if ( c == '\n' )
+				fputs("\\n", file);
+			else if ( c == '\\' )
+				fputs("\\\\", file);
+			else
+				fputc(c, file);
+		}
+		fputc('\n', file);
+	}
+	if ( fclose(file) != 0 )
+		throwf("can't write %s, errno=%d", path.c_str(), errno);
+}
+
+
+void LinkCache::copyFile(const char* fromPath, const char* toPath, mode_t permissions) const
+{
+	// write to a temp file then rename, so that a partial copy is never observed
+	std::string tempPath = std::string(toPath) + ".ld_cache";
+	(void)unlink(tempPath.c_str());
+	if ( copyfile(fromPath, tempPath.c_str(), NULL, COPYFILE_DATA | COPYFILE_CLONE) != 0 )
+		throwf("can't copy %s to %s, errno=%d", fromPath, tempPath.c_str(), errno);
+	if ( ::chmod(tempPath.c_str(), permissions) == -1 ) {
+		unlink(tempPath.c_str());
+		throwf("can't set permissions on %s, errno=%d", tempPath.c_str(), errno);
+	}
+	if ( ::rename(tempPath.c_str(), toPath) == -1 ) {
+		unlink(tempPath.c_str());
+		throwf("can't move %s in place, errno=%d", toPath, errno);
+	}
+}
+
+
+bool LinkCache::reuseCachedOutput()
+{
+	if ( !outputCanBeReused() )
+		return false;
+
+	Manifest manifest;
+	const std::string dir = entryDir(_key);
+	if ( !readManifest(dir + "/" + kManifestName, manifest) ) {
+		_missReason = "no cache entry for these inputs";
+		return false;
+	}
+
+	// the key only covers command line inputs, verify the libraries the cached link found by searching
+	std::vector<std::string> libraryPaths;
+	for (const FileEntry& entry : manifest.libraries)
+		libraryPaths.push_back(entry.path);
+	std::vector<FileEntry> libraries;
+	digestFiles(libraryPaths, libraries);
+	for (size_t i=0; i < libraries.size(); ++i) {
+		if ( memcmp(libraries[i].digest.bytes, manifest.libraries[i].digest.bytes, sizeof(Digest)) != 0 ) {
+			_missReason = "a library used by the cached link changed";
+			return false;
+		}
+	}
+
+	const std::string cachedOutput = dir + "/" + kOutputName;
+	struct stat statBuf;
+	if ( (stat(cachedOutput.c_str(), &statBuf) != 0) || ((uint64_t)statBuf.st_size != manifest.outputSize) ) {
+		_missReason = "cache entry is incomplete";
+		return false;
+	}
+
+	// use the same permissions OutputFile::writeOutputFile() would
+	mode_t permissions = (_options.outputKind() == Options::kObjectFile) ? 0666 : 0777;
+	mode_t umask = ::umask(0);
+	::umask(umask);
+	permissions &= ~umask;
+	if ( (access(_options.outputFilePath(), F_OK) == 0) && (access(_options.outputFilePath(), W_OK) == -1) )
+		throwf("can't write output file: %s", _options.outputFilePath());
+	copyFile(cachedOutput.c_str(), _options.outputFilePath(), permissions);
+
+	// update the last link pointer, ignoring failures
+	FILE* last = fopen(lastLinkPath().c_str(), "w");
+	if ( last != NULL ) {
+		fprintf(last, "%s\n", _key.c_str());
+		fclose(last);
+	}
+
+	// repeat the warnings the cached link printed after option parsing
+	recordWarnings(NULL);
+	for (const std::string& msg : manifest.warnings)
+		warning("%s", msg.c_str());
+	return true;
+}
+
+
+void LinkCache::reportChanges(const Manifest& previous, const Manifest& current) const
+{
+	std::unordered_map<std::string, const FileEntry*> previousFiles;
+	for (const FileEntry& entry : previous.inputs)
+		previousFiles[entry.path] = &entry;
+	for (const FileEntry& entry : previous.libraries)
+		previousFiles[entry.path] = &entry;
+	unsigned changedCount = 0;
+	unsigned totalCount = 0;
+	auto checkFiles = [&](const std::vector<FileEntry>& files) {
+		for (const FileEntry& entry : files) {
+			++totalCount;
+			const auto pos = previousFiles.find(entry.path);
+			if ( pos == previousFiles.end() ) {
+				fprintf(stderr, "incremental link: new input %s\n", entry.path.c_str());
+				++changedCount;
+			}
+			else if ( memcmp(pos->second->digest.bytes, entry.digest.bytes, sizeof(Digest)) != 0 ) {
+				fprintf(stderr, "incremental link: changed input %s\n", entry.path.c_str());
+				++changedCount;
+			}
+		}
+	};
+	checkFiles(current.inputs);
+	checkFiles(current.libraries);
+	fprintf(stderr, "incremental link: %u of %u inputs changed since last link\n", changedCount, totalCount);
+
+	// any change in section addresses or sizes means every following section moved
+	bool layoutChanged = (previous.sections.size() != current.sections.size());
+	for (size_t i=0; !layoutChanged && (i < current.sections.size()); ++i) {
+		const SectionEntry& prev = previous.sections[i];
+		const SectionEntry& cur  = current.sections[i];
+		if ( (prev.segment != cur.segment) || (prev.section != cur.section) || (prev.address != cur.address)
+				|| (prev.size != cur.size) || (prev.fileOffset != cur.fileOffset) ) {
+			fprintf(stderr, "incremental link: layout changed at %s,%s (size 0x%llX -> 0x%llX)\n",
+					cur.segment.c_str(), cur.section.c_str(), prev.size, cur.size);
+			layoutChanged = true;
+		}
+	}
+	if ( !layoutChanged )
+		fprintf(stderr, "incremental link: section layout unchanged\n");
+}
+
+
+void LinkCache::recordLink(const ld::Internal& state, const InputFiles& inputFiles)
+{
+	recordWarnings(NULL);
+	if ( !outputCanBeReused() )
+		return;
+	// a link that fails because of -fatal_warnings must not turn into a successful cache hit
+	if ( _options.errorBecauseOfWarnings() )
+		return;
+	try {
+		Manifest manifest;
+		manifest.inputs = _inputs;
+		manifest.warnings = _warnings;
+
+		// record libraries that were not on the command line, such as indirect dylibs and auto-linked libraries
+		__block std::unordered_set<std::string> seen;
+		for (const FileEntry& entry : _inputs)
+			seen.insert(entry.path);
+		__block std::vector<std::string> libraryPaths;
+		inputFiles.forEachLibrary(^(const ld::File* file) {
+			if ( seen.insert(file->path()).second )
+				libraryPaths.push_back(file->path());
+		});
+		std::sort(libraryPaths.begin(), libraryPaths.end());
+		digestFiles(libraryPaths, manifest.libraries);
+
+		for (const ld::Internal::FinalSection* sect : state.sections) {
+			manifest.sections.push_back({ sect->segmentName(), sect->sectionName(), sect->address, sect->size, sect->fileOffset });
+		}
+
+		struct stat statBuf;
+		if ( stat(_options.outputFilePath(), &statBuf) != 0 )
+			throwf("can't stat output file, errno=%d", errno);
+		manifest.outputSize = statBuf.st_size;
+
+		if ( _options.printStatistics() || _options.verbose() ) {
+			char lastKey[2*sizeof(Digest)+2];
+			FILE* last = fopen(lastLinkPath().c_str(), "r");
+			if ( last != NULL ) {
+				Manifest previous;
+				if ( (fgets(lastKey, sizeof(lastKey), last) != NULL) && readManifest(entryDir(std::string(lastKey, 2*sizeof(Digest))) + "/" + kManifestName, previous) )
+					reportChanges(previous, manifest);
+				fclose(last);
+			}
+		}
+
+		// build the entry in a private directory, then publish it with one rename()
+		std::string tempDir = _cacheDir + "/tmp.XXXXXX";
+		if ( mkdtemp(&tempDir[0]) == NULL )
+			throwf("can't create temp directory in %s, errno=%d", _cacheDir.c_str(), errno);
+		copyFile(_options.outputFilePath(), (tempDir + "/" + kOutputName).c_str(), S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+		writeManifest(tempDir + "/" + kManifestName, manifest);
+		const std::string dir = entryDir(_key);
+		if ( ::rename(tempDir.c_str(), dir.c_str()) != 0 ) {
+			// an identical link may have published the same entry, or a stale entry is in the way
+			(void)unlink((dir + "/" + kOutputName).c_str());
+			(void)unlink((dir + "/" + kManifestName).c_str());
+			(void)rmdir(dir.c_str());
+			if ( ::rename(tempDir.c_str(), dir.c_str()) != 0 ) {
+				(void)unlink((tempDir + "/" + kOutputName).c_str());
+				(void)unlink((tempDir + "/" + kManifestName).c_str());
+				(void)rmdir(tempDir.c_str());
+			}
+		}
+
+		FILE* last = fopen(lastLinkPath().c_str(), "w");
+		if ( last != NULL ) {
+			fprintf(last, "%s\n", _key.c_str());
+			fclose(last);
+		}
+	}
+	catch (const char* msg) {
+		// the cache is an optimization, never fail the link because of it
+		warning("could not update -incremental_cache_path: %s", msg);
+	}
+}
+
+
+} // namespace tool
+} // namespace ld
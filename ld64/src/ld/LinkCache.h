@@ -0,0 +1,106 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#ifndef __LINK_CACHE_H__
+#define __LINK_CACHE_H__
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "Options.h"
+#include "ld.hpp"
+
+namespace ld {
+namespace tool {
+
+class InputFiles;
+
+//
+// LinkCache implements -incremental_cache_path.  Each link is keyed by the
+// ld version, the command line and a SHA-256 digest of every input file and
+// of every file read because of an option (export lists, order files,
+// -sectcreate data, libLTO).  A cache entry records the final image plus a
+// manifest of every file the link actually loaded (including indirect dylibs
+// and libraries found via auto-linking), the final section layout and the
+// warnings printed after option parsing, which are repeated on a cache hit.
+//
+// If the key of a new link matches an entry and every file recorded in its
+// manifest is unchanged, the cached image is reused and no atoms are parsed.
+// Otherwise a full link is done, the inputs that changed since the previous
+// link of the same output are reported, and the entry is refreshed.
+//
+class LinkCache
+{
+public:
+								LinkCache(const Options& opts, int argc, const char* argv[]);
+
+	// returns true if the output file was restored from the cache
+	bool						reuseCachedOutput();
+	// records the just written output file and its layout in the cache
+	void						recordLink(const ld::Internal& state, const InputFiles& inputFiles);
+
+	const char*					missReason() const	{ return _missReason; }
+	uint64_t					hashedBytes() const	{ return _hashedBytes; }
+
+private:
+	struct Digest				{ uint8_t bytes[32]; };
+	struct FileEntry			{ std::string path; Digest digest; };
+	struct SectionEntry			{ std::string segment; std::string section; uint64_t address; uint64_t size; uint64_t fileOffset; };
+	struct Manifest {
+		uint64_t					outputSize = 0;
+		std::vector<FileEntry>		inputs;
+		std::vector<FileEntry>		libraries;
+		std::vector<SectionEntry>	sections;
+		std::vector<std::string>	warnings;
+	};
+
+	bool						outputCanBeReused();
+	std::string					libLTOPath() const;
+	bool						digestFile(const char* path, Digest& digest);
+	void						digestFiles(const std::vector<std::string>& paths, std::vector<FileEntry>& entries);
+	static std::string			hexString(const Digest& digest);
+	static bool					parseHexString(const char* str, Digest& digest);
+	std::string					entryDir(const std::string& key) const;
+	std::string					lastLinkPath() const;
+	bool						readManifest(const std::string& path, Manifest& manifest) const;
+	void						writeManifest(const std::string& path, const Manifest& manifest) const;
+	void						reportChanges(const Manifest& previous, const Manifest& current) const;
+	void						copyFile(const char* fromPath, const char* toPath, mode_t permissions) const;
+
+	const Options&				_options;
+	std::string					_cacheDir;
+	std::string					_key;
+	std::vector<FileEntry>		_inputs;
+	std::vector<std::string>	_warnings;
+	const char*					_missReason;
+	uint64_t					_hashedBytes;
+};
+
+} // namespace tool
+} // namespace ld
+
+#endif // __LINK_CACHE_H__
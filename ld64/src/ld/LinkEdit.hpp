@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <CommonCrypto/CommonDigest.h>
 #include <CommonCrypto/CommonDigestSPI.h>
+#include <dispatch/dispatch.h>
 
 #include <vector>
 #include <unordered_map>
@@ -1435,7 +1436,7 @@ template <typename A>
 void ExportInfoAtom<A>::encode() const
 {
 	uint64_t 							imageBaseAddress = this->_writer.headerAndLoadCommandsSection->address;
-	__block unsigned int				padding          = 0;
+	unsigned int						padding          = 0;
 
 
 	std::vector<const ld::Atom*> exportedAtoms;
@@ -1452,8 +1453,9 @@ void ExportInfoAtom<A>::encode() const
 		exportedAtoms.push_back(atom);
 	}
 
+	const ld::Atom* const* exportedAtomsData = exportedAtoms.data();
     mach_o::ExportsTrie::Getter get = ^(size_t index) {
-		const ld::Atom* atom = exportedAtoms[index];
+		const ld::Atom* atom = exportedAtomsData[index];
         mach_o::ExportsTrie::Export exportedSymbol;
 		exportedSymbol.name = atom->name();
 		exportedSymbol.flags = (atom->contentType() == ld::Atom::typeTLV) ? EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL : EXPORT_SYMBOL_FLAGS_KIND_REGULAR;
@@ -1502,17 +1504,38 @@ void ExportInfoAtom<A>::encode() const
 					exportedSymbol.offset |= 1;
 			}
 		}
-
-		if ( _options.sharedRegionEligible() && (strncmp(atom->section().segmentName(), "__DATA", 6) == 0) ) {
-			// Maximum address is 64bit which is 10 bytes as a uleb128. Minimum is 1 byte
-			// Pad the section out so we can deal with addresses getting larger when __DATA segment
-			// is moved before __TEXT in dyld shared cache
-			padding += 9;
-		}
         return exportedSymbol;
     };
 
-	mach_o::ExportsTrie trie(exportedAtoms.size(), get);
+	// export info for each atom is independent, so compute it in parallel and hand the trie builder the results
+	std::vector<mach_o::ExportsTrie::Export> exports(exportedAtoms.size());
+	mach_o::ExportsTrie::Export*	exportsData = exports.data();
+	__block const char*				exception   = NULL;
+	dispatch_apply(exports.size(), DISPATCH_APPLY_AUTO, ^(size_t index) {
+		try {
+			exportsData[index] = get(index);
+		}
+		catch (const char* msg) {
+			exception = msg;
+		}
+	});
+	if ( exception != NULL )
+		throw exception;
+
+	if ( _options.sharedRegionEligible() ) {
+		for (const ld::Atom* atom : exportedAtoms) {
+			if ( strncmp(atom->section().segmentName(), "__DATA", 6) == 0 ) {
+				// Maximum address is 64bit which is 10 bytes as a uleb128. Minimum is 1 byte
+				// Pad the section out so we can deal with addresses getting larger when __DATA segment
+				// is moved before __TEXT in dyld shared cache
+				padding += 9;
+			}
+		}
+	}
+
+	mach_o::ExportsTrie trie(exports.size(), ^(size_t index) {
+		return exportsData[index];
+	});
 	if ( mach_o::Error err = std::move(trie.buildError()) )
 		throwf("error creating exports trie: %s\n", err.message());
 	size_t          trieSize  = 0;
@@ -2198,6 +2221,12 @@ public:
 	virtual void								encode() const;
 
 			void								hash(uint8_t* wholeFileBuffer) const;
+			// lets OutputFile hash pages while it measures the UUID, so hash() need not reread them
+			void								beginPageHashing() const;
+			void								hashPage(const uint8_t* wholeFileBuffer, uint64_t pageIndex) const;
+			uint64_t							pageSize() const	{ return libcd_page_size(); }
+			// everything before the code signature is signed
+			uint64_t							signedSize() const;
 
 private:
 	const Options& 				_opts;
@@ -2209,6 +2238,15 @@ private:
 
 ld::Section CodeSignatureAtom::_s_section("__LINKEDIT", "__code_sign", ld::Section::typeLinkEdit, true);
 
+uint64_t CodeSignatureAtom::signedSize() const
+{
+	for (const ld::Internal::FinalSection* sect : _state.sections) {
+		if ( (sect->type() == ld::Section::typeLinkEdit) && (strcmp(sect->sectionName(), _s_section.sectionName()) == 0) )
+			return sect->fileOffset;
+	}
+	throw "code signature section not found";
+}
+
 void CodeSignatureAtom::encode() const
 {
 	// calculate pages in binary to know how big codesignature needs to be
@@ -2284,6 +2322,17 @@ void CodeSignatureAtom::encode() const
 	this->_encoded = true;
 }
 
+void CodeSignatureAtom::beginPageHashing() const
+{
+	if ( !libcd_prepare_page_hashes(_sigRef) )
+		throw "can't allocate code signature page hashes";
+}
+
+void CodeSignatureAtom::hashPage(const uint8_t* wholeFileBuffer, uint64_t pageIndex) const
+{
+	libcd_hash_page_mem(_sigRef, pageIndex, &wholeFileBuffer[pageIndex * pageSize()]);
+}
+
 void CodeSignatureAtom::hash(uint8_t* wholeFileBuffer) const
 {
 	Internal::FinalSection* codeSignSect = _state.sections.back();
@@ -41,6 +41,7 @@
 #include <vector>
 #include <map>
 #include <sstream>
+#include <mutex>
 
 #include "ld.hpp"
 #include "Options.h"
@@ -82,10 +83,48 @@ static bool			sFatalWarnings = false;
 static const char*	sWarningsSideFilePath = NULL;
 static FILE*		sWarningsSideFile = NULL;
 static int			sWarningsCount = 0;
+static std::vector<std::string>*	sRecordedWarnings = NULL;
+static std::mutex					sRecordedWarningsLock;
+static thread_local std::vector<std::string>*	sDeferredWarnings = NULL;
+
+void recordWarnings(std::vector<std::string>* warnings)
+{
+	std::lock_guard<std::mutex> guard(sRecordedWarningsLock);
+	sRecordedWarnings = warnings;
+}
+
+void deferWarnings(std::vector<std::string>* warnings)
+{
+	sDeferredWarnings = warnings;
+}
 
 void warning(const char* format, ...)
 {
+	if ( sDeferredWarnings != NULL ) {
+		va_list	list;
+		char*	p;
+		va_start(list, format);
+		if ( vasprintf(&p, format, list) != -1 ) {
+			sDeferredWarnings->push_back(p);
+			free(p);
+		}
+		va_end(list);
+		return;
+	}
 	++sWarningsCount;
+	{
+		std::lock_guard<std::mutex> guard(sRecordedWarningsLock);
+		if ( sRecordedWarnings != NULL ) {
+			va_list	list;
+			char*	p;
+			va_start(list, format);
+			if ( vasprintf(&p, format, list) != -1 ) {
+				sRecordedWarnings->push_back(p);
+				free(p);
+			}
+			va_end(list);
+		}
+	}
 	if ( sEmitWarnings ) {
 		va_list	list;
 		if ( sWarningsSideFilePath != NULL ) {
@@ -228,6 +267,8 @@ Options::Options(int argc, const char* argv[])
 	this->addDependency(depOutputFile, fOutputFile);
 	if ( fMapPath != NULL )
 		this->addDependency(depOutputFile, fMapPath);
+	if ( fBinaryMapPath != NULL )
+		this->addDependency(depOutputFile, fBinaryMapPath);
 }
 
 Options::~Options()
@@ -504,6 +545,7 @@ void Options::loadSymbolOrderFile(const char* fileOfExports, NameToOrder& orderM
 	int fd = ::open(fileOfExports, O_RDONLY, 0);
 	if ( fd == -1 )
 		throwf("can't open -exported_symbols_order file: %s", fileOfExports);
+	this->addReferencedFile(fileOfExports);
 	struct stat stat_buf;
 	::fstat(fd, &stat_buf);
 	char* p = (char*)malloc(stat_buf.st_size);
@@ -574,6 +616,7 @@ void Options::loadImplictZipperFile(const char *path, std::vector<const char*>&
 	// read in whole file
 	int fd = ::open(path, O_RDONLY, 0);
 	if ( fd == -1 ) return; // Early exist if the file is not present
+	this->addReferencedFile(path);
 	struct stat stat_buf;
 	::fstat(fd, &stat_buf);
 	char* p = (char*)malloc(stat_buf.st_size);
@@ -1281,14 +1324,19 @@ void Options::loadFileList(const char* fileOfPaths, ld::File::Ordinal baseOrdina
 			if ( file == NULL )
 				throwf("-filelist file '%s' could not be opened, errno=%d (%s)\n", realFileOfPaths, errno, strerror(errno));
 			this->addDependency(Options::depFileList, realFileOfPaths);
-		} else
+			this->addReferencedFile(realFileOfPaths);
+		}
+		else {
 			this->addDependency(Options::depFileList, fileOfPaths);
+			this->addReferencedFile(fileOfPaths);
+		}
 	}
 	else {
 		file = fopen(fileOfPaths, "r");
 		if ( file == NULL )
 			throwf("-filelist file '%s' could not be opened, errno=%d (%s)\n", fileOfPaths, errno, strerror(errno));
 		this->addDependency(Options::depFileList, fileOfPaths);
+		this->addReferencedFile(fileOfPaths);
 	}
 
 	char path[PATH_MAX];
@@ -1482,6 +1530,7 @@ void Options::loadExportFile(const char* fileOfExports, const char* option, SetW
 		throwf("can't read %s file: %s", option, fileOfExports);
 
 	this->addDependency(Options::depMisc, fileOfExports);
+	this->addReferencedFile(fileOfExports);
 
 	::close(fd);
 
@@ -1555,6 +1604,7 @@ void Options::parseAliasFile(const char* fileOfAliases)
 	p[stat_buf.st_size] = '\n';
 	::close(fd);
 	this->addDependency(Options::depMisc, fileOfAliases);
+	this->addReferencedFile(fileOfAliases);
 
 	// parse into symbols and add to fAliases
 	AliasPair pair;
@@ -1926,6 +1976,7 @@ void Options::parseOrderFile(const char* path, bool cstring)
 	::close(fd);
 	p[stat_buf.st_size] = '\n';
 	this->addDependency(Options::depMisc, path);
+	this->addReferencedFile(path);
 	fOrderFilePath = strdup(path);
 
 	// parse into vector of pairs
@@ -2062,6 +2113,7 @@ void Options::addSection(const char* segment, const char* section, const char* p
 		int fd = ::open(path, O_RDONLY, 0);
 		if ( fd == -1 )
 			throwf("can't open -sectcreate file: %s", path);
+		this->addReferencedFile(path);
 		struct stat stat_buf;
 		::fstat(fd, &stat_buf);
 
@@ -2524,6 +2576,7 @@ void Options::parse(int argc, const char* argv[])
             int snapshotArgIndex = i;
             int snapshotArgCount = -1; // -1 means compute count based on change in index
             int snapshotFileArgIndex = -1; // -1 means no data file parameter to arg
+            int snapshotOutputArgIndex = -1; // -1 means no output path parameter to arg
 
 			// Since we don't care about the files passed, just the option names, we do this here.
 			if (fPrintOptions)
@@ -2637,10 +2690,15 @@ void Options::parse(int argc, const char* argv[])
 					throw "missing argument to -lto_library";
 			}
 			else if ( strcmp(arg, "-cache_path_lto") == 0 ) {
+				snapshotOutputArgIndex = 1;
 				fLtoCachePath = argv[++i];
 				if ( fLtoCachePath == NULL )
 					throw "missing argument to -cache_path_lto";
 			}
+			else if ( strcmp(arg, "-incremental_cache_path") == 0 ) {
+				snapshotOutputArgIndex = 1;
+				fIncrementalCachePath = checkForNullArgument(arg, argv[++i]);
+			}
 			else if ( strcmp(arg, "-prune_interval_lto") == 0 ) {
 				const char* value = argv[++i];
 				if ( value == NULL )
@@ -3510,6 +3568,17 @@ void Options::parse(int argc, const char* argv[])
 			else if ( strcmp(arg, "-print_statistics") == 0 ) {
 				fStatistics = true;
 			}
+			else if ( strcmp(arg, "-trace_file") == 0 ) {
+				snapshotOutputArgIndex = 1;
+				fTraceFilePath = checkForNullArgument(arg, argv[++i]);
+			}
+			else if ( strcmp(arg, "-archive_index_cache_path") == 0 ) {
+				snapshotOutputArgIndex = 1;
+				fArchiveIndexCachePath = checkForNullArgument(arg, argv[++i]);
+			}
+			else if ( strcmp(arg, "-keep_unchanged_output") == 0 ) {
+				fKeepUnchangedOutput = true;
+			}
 			else if ( strcmp(arg, "-d") == 0 ) {
 				fMakeTentativeDefinitionsReal = true;
 			}
@@ -3620,8 +3689,13 @@ void Options::parse(int argc, const char* argv[])
 				warnObsolete(arg);
 			}
 			else if ( strcmp(arg, "-map") == 0 ) {
+				snapshotOutputArgIndex = 1;
 				fMapPath = checkForNullArgument(arg, argv[++i]);
 			}
+			else if ( strcmp(arg, "-binary_map") == 0 ) {
+				snapshotOutputArgIndex = 1;
+				fBinaryMapPath = checkForNullArgument(arg, argv[++i]);
+			}
 			else if ( strcmp(arg, "-pie") == 0 ) {
 				fPositionIndependentExecutable = true;
 				fPIEOnCommandLine = true;
@@ -3827,6 +3901,7 @@ void Options::parse(int argc, const char* argv[])
 				fDataInCodeInfoLoadCommandForcedOff = false;
 			}
 			else if ( strcmp(arg, "-object_path_lto") == 0 ) {
+				snapshotOutputArgIndex = 1;
 				fTempLtoObjectPath = checkForNullArgument(arg, argv[++i]);
 			}
 			else if ( strcmp(arg, "-no_objc_category_merging") == 0 ) {
@@ -3889,6 +3964,14 @@ void Options::parse(int argc, const char* argv[])
 				fSnapshotRequested = true;
 				cannotBeUsedWithBitcode(arg);
             }
+			else if (strcmp(arg, "-benchmark_snapshot_dir") == 0) {
+				const char* path = checkForNullArgument(arg, argv[++i]);
+				fLinkSnapshot.setSnapshotMode(Snapshot::SNAPSHOT_BENCHMARK);
+				fLinkSnapshot.setSnapshotPath(path);
+				fSnapshotRequested = true;
+				snapshotArgCount = 0;
+				cannotBeUsedWithBitcode(arg);
+			}
 			else if ( strcmp(arg, "-source_version") == 0 ) {
 				 const char* vers = argv[++i];
 				 if ( vers == NULL )
@@ -4251,7 +4334,7 @@ void Options::parse(int argc, const char* argv[])
             if (snapshotArgCount == -1)
                 snapshotArgCount = i-snapshotArgIndex+1;
             if (snapshotArgCount > 0)
-                fLinkSnapshot.addSnapshotLinkArg(snapshotArgIndex, snapshotArgCount, snapshotFileArgIndex);
+                fLinkSnapshot.addSnapshotLinkArg(snapshotArgIndex, snapshotArgCount, snapshotFileArgIndex, snapshotOutputArgIndex);
 		}
 		else {
 			FileInfo info = findFile(arg);
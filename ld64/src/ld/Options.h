@@ -41,6 +41,11 @@
 
 extern void throwf (const char* format, ...) __attribute__ ((noreturn,format(printf, 1, 2)));
 extern void warning(const char* format, ...) __attribute__((format(printf, 1, 2)));
+// while set, the text of every warning() is also appended to the vector
+extern void recordWarnings(std::vector<std::string>* warnings);
+// while set, warning() on the calling thread only appends the text to the vector,
+// so that warnings from concurrent tasks can be reported in a stable order
+extern void deferWarnings(std::vector<std::string>* warnings);
 
 class Snapshot;
 
@@ -380,6 +385,9 @@ public:
 	bool						warnStabs();
 	bool						pauseAtEnd() { return fPause; }
 	bool						printStatistics() const { return fStatistics; }
+	const char*					traceFilePath() const { return fTraceFilePath; }
+	const char*					archiveIndexCachePath() const { return fArchiveIndexCachePath; }
+	bool						keepUnchangedOutput() const { return fKeepUnchangedOutput; }
 	bool						printArchPrefix() const { return fMessagesPrefixedWithArchitecture; }
 	void						gotoPrimeLinker(int argc, const char* argv[]);
 	bool						sharedRegionEligible() const { return fSharedRegionEligible; }
@@ -406,6 +414,7 @@ public:
 	bool						readOnlyx86Stubs() { return fReadOnlyx86Stubs; }
 	const std::vector<DylibOverride>&	dylibOverrides() const { return fDylibOverrides; }
 	const char*					generatedMapPath() const { return fMapPath; }
+	const char*					binaryMapPath() const { return fBinaryMapPath; }
 	bool						positionIndependentExecutable() const { return fPositionIndependentExecutable; }
 	Options::FileInfo			findIndirectDylib(const std::string& installName, const ld::dylib::File* fromDylib) const;
 	bool						deadStripDylibs() const { return fDeadStripDylibs; }
@@ -458,6 +467,8 @@ public:
 	bool						addDataInCodeInfo() const { return fDataInCodeInfoLoadCommand; }
 	bool						canReExportSymbols() const { return fCanReExportSymbols; }
 	const char*					ltoCachePath() const { return fLtoCachePath; }
+	const char*					incrementalCachePath() const { return fIncrementalCachePath; }
+	const std::vector<std::string>& referencedFiles() const { return fReferencedFiles; }
 	bool						ltoPruneIntervalOverwrite() const { return fLtoPruneIntervalOverwrite; }
 	int							ltoPruneInterval() const { return fLtoPruneInterval; }
 	int							ltoPruneAfter() const { return fLtoPruneAfter; }
@@ -528,6 +539,7 @@ public:
     const char*					pipelineFifo() const { return fPipelineFifo; }
 	bool						dumpDependencyInfo() const { return (fDependencyInfoPath != NULL); }
 	const char*					dependencyInfoPath() const { return fDependencyInfoPath; }
+	bool						traceDylibSearching() const { return fTraceDylibSearching; }
 	bool						targetIOSSimulator() const { return platforms().contains(ld::simulatorPlatforms); }
 	ld::relocatable::File::LinkerOptionsList&
 								linkerOptions() const { return fLinkerOptions; }
@@ -648,6 +660,7 @@ private:
 	void						addSymbolMove(const char* dstSegment, const char* symbolList, std::vector<SymbolsMove>& list, const char* optionName, SymbolMatchingMode);
 	void						cannotBeUsedWithBitcode(const char* arg);
 	void						loadImplictZipperFile(const char *path,std::vector<const char*>& paths);
+	void						addReferencedFile(const char* path) { fReferencedFiles.push_back(path); }
 	void 						inferArchAndPlatform();
 
 
@@ -705,6 +718,11 @@ private:
 	const char*							fMapPath;
 	const char*							fDyldInstallPath;
 	const char*							fLtoCachePath;
+	const char*							fIncrementalCachePath = NULL;
+	const char*							fTraceFilePath = NULL;
+	const char*							fArchiveIndexCachePath = NULL;
+	const char*							fBinaryMapPath = NULL;
+	bool								fKeepUnchangedOutput = false;
 	bool								fLtoPruneIntervalOverwrite;
 	int									fLtoPruneInterval;
 	int									fLtoPruneAfter;
@@ -924,6 +942,7 @@ private:
 	uint8_t								fMaxDefaultCommonAlign;
 	UnalignedPointerTreatment			fUnalignedPointerTreatment;
 	mutable std::vector<DependencyEntry> fDependencies;
+	std::vector<std::string>			fReferencedFiles;	// files read by options, such as -exported_symbols_list
 	mutable std::vector<Options::TAPIInterface> fTAPIFiles;
 	bool								fPreferTAPIFile;
 	const char*							fOSOPrefixPath;
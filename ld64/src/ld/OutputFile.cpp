@@ -70,6 +70,8 @@ extern "C" {
 #include "LinkEditClassic.hpp"
 #include "generic_dylib_file.hpp"
 #include "Containers.h"
+#include "TraceEvents.h"
+#include "BinaryMap.h"
 
 namespace ld {
 namespace tool {
@@ -164,7 +166,25 @@ void OutputFile::write(ld::Internal& state)
 	this->setLoadCommandsPadding(state);
 	_fileSize = state.assignFileOffsets();
 	this->assignAtomAddresses(state);
+	// addresses outside of LINKEDIT are final now, so the binary map is written while LINKEDIT is built
+	dispatch_group_t mapGroup = dispatch_group_create();
+	__block const char* mapExceptionMsg = nullptr;
+	if ( _options.binaryMapPath() != NULL ) {
+		dispatch_group_async(mapGroup, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+			TraceSpan span("writeBinaryMapFile", "linkedit");
+			try {
+				this->writeBinaryMapFile(state);
+			}
+			catch (const char* msg) {
+				mapExceptionMsg = msg;
+			}
+		});
+	}
 	this->buildLINKEDITContent(state);
+	dispatch_group_wait(mapGroup, DISPATCH_TIME_FOREVER);
+	dispatch_release(mapGroup);
+	if ( mapExceptionMsg != nullptr )
+		warning("%s", mapExceptionMsg);
 	this->updateLINKEDITAddresses(state);
 	//this->dumpAtomsBySection(state, false);
 	this->writeOutputFile(state);
@@ -3230,6 +3250,185 @@ bool OutputFile::hasZeroForFileOffset(const ld::Section* sect)
 	return false;
 }
 
+//
+// Appends the atom's fixups to the kernel batches if every one of them can be lowered,
+// and returns false (leaving the batches as they were) if applyFixUps() is needed.
+//
+bool OutputFile::lowerFixUps(const ld::Internal& state, const ld::Atom* atom, uint32_t atomIndex, LoweredFixups& lowered)
+{
+	size_t startCounts[kernelCount];
+	for (int k=0; k < kernelCount; ++k)
+		startCounts[k] = lowered.fixupAddress[k].size();
+
+	bool lowerable = true;
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); lowerable && (fit != end); ++fit) {
+		FixupKernel kernel;
+		switch ( (ld::Fixup::Kind)(fit->kind) ) {
+			case ld::Fixup::kindNone:
+			case ld::Fixup::kindNoneFollowOn:
+			case ld::Fixup::kindNoneGroupSubordinate:
+			case ld::Fixup::kindNoneGroupSubordinateFDE:
+			case ld::Fixup::kindNoneGroupSubordinateLSDA:
+			case ld::Fixup::kindNoneGroupSubordinatePersonality:
+			case ld::Fixup::kindLazyTarget:
+			case ld::Fixup::kindIslandTarget:
+			case ld::Fixup::kindDataInCodeStartData:
+			case ld::Fixup::kindDataInCodeStartJT8:
+			case ld::Fixup::kindDataInCodeStartJT16:
+			case ld::Fixup::kindDataInCodeStartJT32:
+			case ld::Fixup::kindDataInCodeStartJTA32:
+			case ld::Fixup::kindDataInCodeEnd:
+				// nothing to apply
+				continue;
+#if SUPPORT_ARCH_arm64
+			case ld::Fixup::kindStoreTargetAddressARM64Branch26:
+				kernel = kernelARM64Branch26;
+				break;
+			case ld::Fixup::kindStoreTargetAddressARM64GOTLeaPage21:
+			case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPage21:
+			case ld::Fixup::kindStoreTargetAddressARM64Page21:
+			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPage21:
+			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPage21:
+				kernel = kernelARM64Page21;
+				break;
+			case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPageOff12:
+			case ld::Fixup::kindStoreTargetAddressARM64PageOff12:
+			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPageOff12:
+				kernel = kernelARM64PageOff12;
+				break;
+#endif
+			case ld::Fixup::kindStoreTargetAddressX86PCRel32:
+			case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
+			case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoad:
+			case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoad:
+				kernel = kernelX86PCRel32;
+				break;
+			default:
+				// includes linker optimization hints, which need the whole atom
+				lowerable = false;
+				continue;
+		}
+		if ( (fit->clusterSize != ld::Fixup::k1of1) || fit->contentAddendOnly || fit->contentDetlaToAddendOnly ) {
+			lowerable = false;
+			continue;
+		}
+		const ld::Atom* target = NULL;
+		switch ( fit->binding ) {
+			case ld::Fixup::bindingByContentBound:
+			case ld::Fixup::bindingDirectlyBound:
+				target = fit->u.target;
+				break;
+			case ld::Fixup::bindingsIndirectlyBound:
+				target = state.indirectBindingTable[fit->u.bindingIndex];
+				break;
+			default:
+				break;
+		}
+		// anything unusual is left for applyFixUps() to handle and report
+		if ( (target == NULL) || !target->finalAddressMode() ) {
+			lowerable = false;
+			continue;
+		}
+		lowered.fixupAddress[kernel].push_back(atom->finalAddress() + fit->offsetInAtom);
+		lowered.targetAddress[kernel].push_back(target->finalAddress());
+		lowered.atomIndex[kernel].push_back(atomIndex);
+	}
+
+	if ( !lowerable ) {
+		for (int k=0; k < kernelCount; ++k) {
+			lowered.fixupAddress[k].resize(startCounts[k]);
+			lowered.targetAddress[k].resize(startCounts[k]);
+			lowered.atomIndex[k].resize(startCounts[k]);
+		}
+	}
+	return lowerable;
+}
+
+//
+// Runs each kernel over its batch.  These match the corresponding cases in applyFixUps(),
+// except that a fixup that is out of range or misaligned is not reported here: its atom
+// is added to failedAtoms, so that applyFixUps() can redo it and throw the usual error.
+//
+void OutputFile::applyLoweredFixUps(const ld::Internal::FinalSection* sect, const LoweredFixups& lowered,
+									uint8_t* wholeBuffer, std::vector<uint32_t>& failedAtoms)
+{
+	uint8_t* sectionBuffer = &wholeBuffer[sect->fileOffset];
+	const uint64_t sectionAddress = sect->address;
+
+	// b/bl: imm26 is the distance to the target in instructions
+	{
+		const uint64_t* from  = lowered.fixupAddress[kernelARM64Branch26].data();
+		const uint64_t* to    = lowered.targetAddress[kernelARM64Branch26].data();
+		const size_t    count = lowered.fixupAddress[kernelARM64Branch26].size();
+		for (size_t i=0; i < count; ++i) {
+			const int64_t delta = to[i] - from[i];
+			if ( (delta > 0x07FFFFFF) || (delta < -0x07FFFFFF) ) {
+				failedAtoms.push_back(lowered.atomIndex[kernelARM64Branch26][i]);
+				continue;
+			}
+			uint8_t* loc = &sectionBuffer[from[i] - sectionAddress];
+			set32LE(loc, (get32LE(loc) & 0xFC000000) | ((uint32_t)(delta >> 2) & 0x03FFFFFF));
+		}
+	}
+
+	// adrp: imm21 is the distance from the page of the instruction to the page of the target
+	{
+		const uint64_t* from  = lowered.fixupAddress[kernelARM64Page21].data();
+		const uint64_t* to    = lowered.targetAddress[kernelARM64Page21].data();
+		const size_t    count = lowered.fixupAddress[kernelARM64Page21].size();
+		for (size_t i=0; i < count; ++i) {
+			const int64_t delta = (to[i] & (-4096)) - (from[i] & (-4096));
+			if ( (delta > 0x100000000LL) || (delta < -0x100000000LL) ) {
+				failedAtoms.push_back(lowered.atomIndex[kernelARM64Page21][i]);
+				continue;
+			}
+			uint8_t* loc = &sectionBuffer[from[i] - sectionAddress];
+			const uint32_t immhi = (delta >> 9) & (0x00FFFFE0);
+			const uint32_t immlo = (delta << 17) & (0x60000000);
+			set32LE(loc, (get32LE(loc) & 0x9F00001F) | immlo | immhi);
+		}
+	}
+
+	// add/ldr/str: imm12 is the offset of the target in its page, scaled by the size of a load or store
+	{
+		const uint64_t* from  = lowered.fixupAddress[kernelARM64PageOff12].data();
+		const uint64_t* to    = lowered.targetAddress[kernelARM64PageOff12].data();
+		const size_t    count = lowered.fixupAddress[kernelARM64PageOff12].size();
+		for (size_t i=0; i < count; ++i) {
+			uint8_t* loc = &sectionBuffer[from[i] - sectionAddress];
+			const uint32_t instruction = get32LE(loc);
+			uint32_t offset = to[i] & 0x00000FFF;
+			if ( instruction & 0x08000000 ) {
+				uint32_t implictShift = ((instruction >> 30) & 0x3);
+				// vector and byte LDR/STR have same "size" bits
+				if ( (implictShift == 0) && ((instruction & 0x04800000) == 0x04800000) )
+					implictShift = 4;
+				if ( (offset & ((1 << implictShift) - 1)) != 0 ) {
+					failedAtoms.push_back(lowered.atomIndex[kernelARM64PageOff12][i]);
+					continue;
+				}
+				offset >>= implictShift;
+			}
+			set32LE(loc, (instruction & 0xFFC003FF) | (offset << 10));
+		}
+	}
+
+	// x86_64 rip relative: rel32 is the distance from the end of the field to the target
+	{
+		const uint64_t* from  = lowered.fixupAddress[kernelX86PCRel32].data();
+		const uint64_t* to    = lowered.targetAddress[kernelX86PCRel32].data();
+		const size_t    count = lowered.fixupAddress[kernelX86PCRel32].size();
+		for (size_t i=0; i < count; ++i) {
+			const int64_t delta = to[i] - (from[i] + 4);
+			if ( (delta > 0x7FFFFFFF) || (delta < -0x7FFFFFFF) ) {
+				failedAtoms.push_back(lowered.atomIndex[kernelX86PCRel32][i]);
+				continue;
+			}
+			set32LE(&sectionBuffer[from[i] - sectionAddress], (uint32_t)delta);
+		}
+	}
+}
+
 void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 {
 	const bool logThreadedFixups = false;
@@ -3241,6 +3440,16 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 			baseAddress = sect->address;
 	}
 	__block const char* exception = nullptr;
+	void (^saveException)(const ld::Atom*, const char*) = ^(const ld::Atom* atom, const char* msg) {
+		// applyFixUps() are now done in parallel, if there is an error, just save the last error
+		if ( atom->file() != NULL )
+			asprintf((char**)&exception, "%s in '%s' from %s", msg, atom->name(), atom->safeFilePath());
+		else
+			asprintf((char**)&exception, "%s in '%s'", msg, atom->name());
+	};
+	// the common fixup kinds are lowered into flat batches and applied per kind after the
+	// section's content is copied, instead of one at a time through applyFixUps()
+	const bool lowerFixups = (_options.outputKind() != Options::kObjectFile);
 	dispatch_apply(state.sections.size(), DISPATCH_APPLY_AUTO, ^(size_t index) {
 		ld::Internal::FinalSection* sect = state.sections[index];
 		if ( takesNoDiskSpace(sect) )
@@ -3250,7 +3459,9 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 		bool 		lastAtomWasThumb 		  = false;
 		bool 		lastAtomUsesNoOps 		  = false;
 		uint64_t 	fileOffsetOfEndOfLastAtom = sect->fileOffset;
-		for (const ld::Atom* atom : sect->atoms) {
+		LoweredFixups lowered;
+		for (uint32_t atomIndex=0; atomIndex < sect->atoms.size(); ++atomIndex) {
+			const ld::Atom* atom = sect->atoms[atomIndex];
 			if ( atom->definition() == ld::Atom::definitionProxy )
 				continue;
 			try {
@@ -3263,17 +3474,31 @@ void OutputFile::writeAtoms(ld::Internal& state, uint8_t* wholeBuffer)
 				// copy atom content
 				atom->copyRawContent(atomBufferLoc);
 				// apply fix ups
-				this->applyFixUps(state, baseAddress, atom, atomBufferLoc);
+				if ( !lowerFixups || !this->lowerFixUps(state, atom, atomIndex, lowered) )
+					this->applyFixUps(state, baseAddress, atom, atomBufferLoc);
 				fileOffsetOfEndOfLastAtom = fileOffset+atom->size();
 				lastAtomUsesNoOps = sectionUsesNops;
 				lastAtomWasThumb = atom->isThumb();
 			}
 			catch (const char* msg) {
-				// applyFixUps() are now done in parallel, if there is an error, just save the last error
-				if ( atom->file() != NULL )
-					asprintf((char**)&exception, "%s in '%s' from %s", msg, atom->name(), atom->safeFilePath());
-				else
-					asprintf((char**)&exception, "%s in '%s'", msg, atom->name());
+				saveException(atom, msg);
+			}
+		}
+
+		// atoms with a lowered fixup that is out of range are redone by applyFixUps(), which reports it
+		std::vector<uint32_t> failedAtoms;
+		this->applyLoweredFixUps(sect, lowered, wholeBuffer, failedAtoms);
+		std::sort(failedAtoms.begin(), failedAtoms.end());
+		failedAtoms.erase(std::unique(failedAtoms.begin(), failedAtoms.end()), failedAtoms.end());
+		for (uint32_t atomIndex : failedAtoms) {
+			const ld::Atom* atom = sect->atoms[atomIndex];
+			try {
+				uint8_t* atomBufferLoc = &wholeBuffer[atom->finalAddress() - sect->address + sect->fileOffset];
+				atom->copyRawContent(atomBufferLoc);
+				this->applyFixUps(state, baseAddress, atom, atomBufferLoc);
+			}
+			catch (const char* msg) {
+				saveException(atom, msg);
 			}
 		}
 	});
@@ -3889,6 +4114,27 @@ void OutputFile::computeContentUUID(ld::Internal& state, uint8_t* wholeBuffer)
 			ccdigest_update(di, ctx, strlen(buildName), buildName);
 		}
 
+		// If code signing, hash the pages for the code directory on other threads while the
+		// UUID is computed.  Pages with load commands are done after the UUID is set.
+		const bool     hashPages     = _hasCodeSignature;
+		const uint64_t signedSize    = hashPages ? _codeSignatureAtom->signedSize() : 0;
+		const uint64_t pageSize      = hashPages ? _codeSignatureAtom->pageSize() : 1;
+		const uint64_t deferredPages = (headerAndLoadCommandsEnd(state) + pageSize - 1) / pageSize;
+		dispatch_group_t pageGroup = dispatch_group_create();
+		if ( hashPages ) {
+			_codeSignatureAtom->beginPageHashing();
+			const uint64_t pageCount = (signedSize + pageSize - 1) / pageSize;
+			const uint64_t pagesPerBatch = 256;
+			dispatch_group_async(pageGroup, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+				const size_t batchCount = (size_t)((pageCount + pagesPerBatch - 1) / pagesPerBatch);
+				dispatch_apply(batchCount, DISPATCH_APPLY_AUTO, ^(size_t batch) {
+					const uint64_t end = std::min(pageCount, (batch + 1) * pagesPerBatch);
+					for (uint64_t pageIndex = std::max(deferredPages, batch * pagesPerBatch); pageIndex < end; ++pageIndex)
+						_codeSignatureAtom->hashPage(wholeBuffer, pageIndex);
+				});
+			});
+		}
+
 		if ( !excludeRegions.empty() ) {
 			// Work out which ranges of the file to measure, ignoring the exluded regions
 			std::sort(excludeRegions.begin(), excludeRegions.end());
@@ -3924,6 +4170,8 @@ void OutputFile::computeContentUUID(ld::Internal& state, uint8_t* wholeBuffer)
 		} else {
 			ccdigest_update(di, ctx, _fileSize, wholeBuffer);
 		}
+		dispatch_group_wait(pageGroup, DISPATCH_TIME_FOREVER);
+		dispatch_release(pageGroup);
 
 		ccdigest_final(di, ctx, digest);
 		if ( log ) fprintf(stderr, "uuid=%02X, %02X, %02X, %02X, %02X, %02X, %02X, %02X\n", digest[0], digest[1], digest[2],
@@ -3935,7 +4183,76 @@ void OutputFile::computeContentUUID(ld::Internal& state, uint8_t* wholeBuffer)
 		// update buffer with new UUID
 		_headersAndLoadCommandAtom->setUUID(digest);
 		_headersAndLoadCommandAtom->recopyUUIDCommand();
+
+		// now the load commands are final, hash the pages they are on
+		if ( hashPages ) {
+			for (uint64_t pageIndex = 0; (pageIndex < deferredPages) && (pageIndex * pageSize < signedSize); ++pageIndex)
+				_codeSignatureAtom->hashPage(wholeBuffer, pageIndex);
+		}
+	}
+}
+
+uint64_t OutputFile::headerAndLoadCommandsEnd(ld::Internal& state) const
+{
+	for (const ld::Internal::FinalSection* sect : state.sections) {
+		if ( sect->type() == ld::Section::typeMachHeader )
+			return sect->fileOffset + sect->size;
 	}
+	return 0;
+}
+
+void OutputFile::hashOutput(ld::Internal& state, uint8_t* wholeBuffer)
+{
+	// compute UUID 
+	if ( _options.UUIDMode() == Options::kUUIDContent )
+		computeContentUUID(state, wholeBuffer);
+
+	// now that file output buffer is complete, if codesigned, compute each page's hash
+	if ( _hasCodeSignature )
+		_codeSignatureAtom->hash(wholeBuffer);
+}
+
+//
+// Once writeAtoms() is done, the only parts of the buffer still to change are the
+// mach header (which gets the content UUID) and the code signature at the end of
+// the file.  Everything in between is queued to be written, 8MB at a time, on a
+// serial queue so the disk I/O overlaps with hashing the image.  The header and
+// code signature are written last, once they are complete.
+//
+void OutputFile::hashAndWriteOutput(ld::Internal& state, int fd, uint8_t* wholeBuffer)
+{
+	const uint64_t headerEnd  = headerAndLoadCommandsEnd(state);
+	const uint64_t bodyEnd    = _hasCodeSignature ? _codeSignatureAtom->signedSize() : _fileSize;
+	const uint64_t windowSize = 0x800000;
+
+	__block int writeErrno = 0;
+	dispatch_queue_t writeQueue = dispatch_queue_create("com.apple.ld.output", DISPATCH_QUEUE_SERIAL);
+	dispatch_group_t writeGroup = dispatch_group_create();
+	for (uint64_t offset = headerEnd; offset < bodyEnd; offset += windowSize) {
+		const uint64_t size = std::min(windowSize, bodyEnd - offset);
+		dispatch_group_async(writeGroup, writeQueue, ^{
+			ld::tool::TraceSpan span("write", "output");
+			if ( writeErrno != 0 )
+				return;
+			if ( ld::utils::pwrite64(fd, &wholeBuffer[offset], size, offset) == -1 )
+				writeErrno = errno;
+		});
+	}
+
+	// hashing only modifies the header and code signature, which are not queued yet
+	hashOutput(state, wholeBuffer);
+
+	dispatch_group_wait(writeGroup, DISPATCH_TIME_FOREVER);
+	dispatch_release(writeGroup);
+	dispatch_release(writeQueue);
+	if ( writeErrno == 0 ) {
+		if ( ld::utils::pwrite64(fd, wholeBuffer, headerEnd, 0) == -1 )
+			writeErrno = errno;
+		else if ( ld::utils::pwrite64(fd, &wholeBuffer[bodyEnd], _fileSize - bodyEnd, bodyEnd) == -1 )
+			writeErrno = errno;
+	}
+	if ( writeErrno != 0 )
+		throwf("can't write to output file: %s, errno=%d", _options.outputFilePath(), writeErrno);
 }
 
 static int sDescriptorOfPathToRemove = -1;
@@ -3968,12 +4285,17 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 	// Lastly, only delete existing file if it is a normal file (e.g. not /dev/null).
 	struct stat stat_buf;
 	bool outputIsRegularFile = false;
+	// with -keep_unchanged_output, an existing file of the right size is only removed once the
+	// new image is known to differ from it
+	bool mayKeepExistingOutput = false;
 	if ( stat(_options.outputFilePath(), &stat_buf) != -1 ) {
 		if (stat_buf.st_mode & S_IFREG) {
 			outputIsRegularFile = true;
 
-			// <rdar://problem/72136053>
-			(void)unlink(_options.outputFilePath());
+			if ( _options.keepUnchangedOutput() && ((uint64_t)stat_buf.st_size == _fileSize) )
+				mayKeepExistingOutput = true;
+			else
+				(void)unlink(_options.outputFilePath()); // <rdar://problem/72136053>
 		} 
 		else {
 			outputIsRegularFile = false;
@@ -4006,6 +4328,10 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 	if (getenv("LD_FORCE_PWRITE_FILE") != NULL)
 		outputIsMappableFile = false;
 
+	// the new image is built in memory, so it can be compared before anything is written
+	if ( mayKeepExistingOutput )
+		outputIsMappableFile = false;
+
 	// rdar://106830469 (ld should make fewer statfs syscalls)
 	// do a statfs call only if LD_FORCE_PWRITE_FILE isn't set
 	if ( outputIsRegularFile && outputIsMappableFile ) {
@@ -4030,7 +4356,7 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 
 	//fprintf(stderr, "outputIsMappableFile=%d, outputIsRegularFile=%d, path=%s\n", outputIsMappableFile, outputIsRegularFile, _options.outputFilePath());
 	
-	int fd;
+	int fd = -1;
 	// Construct a temporary path of the form {outputFilePath}.ld_XXXXXX
 	const char filenameTemplate[] = ".ld_XXXXXX";
 	char tmpOutput[PATH_MAX];
@@ -4065,6 +4391,14 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 		if ( wholeBuffer == MAP_FAILED )
 			throwf("can't create buffer of %llu bytes for output", _fileSize);
 	} 
+	else if ( mayKeepExistingOutput ) {
+		// output file is opened later, if it needs to be rewritten
+		wholeBuffer = (uint8_t*)calloc(_fileSize, 1);
+		if ( wholeBuffer == NULL ) {
+			(void)unlink(_options.outputFilePath()); // <rdar://problem/72136053>
+			throwf("can't create buffer of %llu bytes for output", _fileSize);
+		}
+	}
 	else {
 		if ( outputIsRegularFile )
 			fd = open(_options.outputFilePath(),  O_RDWR|O_CREAT, permissions);
@@ -4084,15 +4418,37 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 		_headersAndLoadCommandAtom->setUUID(bits);
 	}
 
-	writeAtoms(state, wholeBuffer);
-	
-	// compute UUID 
-	if ( _options.UUIDMode() == Options::kUUIDContent )
-		computeContentUUID(state, wholeBuffer);
+	try {
+		writeAtoms(state, wholeBuffer);
+		if ( mayKeepExistingOutput ) {
+			hashOutput(state, wholeBuffer);
+			_outputUnchanged = existingOutputMatches(wholeBuffer);
+		}
+	}
+	catch (...) {
+		// a failed link must not leave the previous output behind <rdar://problem/72136053>
+		if ( mayKeepExistingOutput )
+			(void)unlink(_options.outputFilePath());
+		throw;
+	}
 
-	// now that file output buffer is complete, if codesigned, compute each page's hash
-	if ( _hasCodeSignature )
-		_codeSignatureAtom->hash(wholeBuffer);
+	bool contentWritten = false;
+	if ( mayKeepExistingOutput ) {
+		if ( !_outputUnchanged ) {
+			(void)unlink(_options.outputFilePath()); // <rdar://problem/72136053>
+			fd = open(_options.outputFilePath(),  O_RDWR|O_CREAT, permissions);
+			if ( fd == -1 )
+				throwf("can't open output file for writing: %s, errno=%d", _options.outputFilePath(), errno);
+		}
+	}
+	else if ( outputIsRegularFile && !outputIsMappableFile ) {
+		// write out what is already final while the UUID and code signature are computed
+		hashAndWriteOutput(state, fd, wholeBuffer);
+		contentWritten = true;
+	}
+	else {
+		hashOutput(state, wholeBuffer);
+	}
 
 	if ( outputIsRegularFile && outputIsMappableFile ) {
 		::close(fd);
@@ -4105,8 +4461,8 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 			throwf("can't move output file in place, errno=%d", errno);
 		}
 	} 
-	else {
-		if ( ld::utils::write64(fd, wholeBuffer, _fileSize) == -1 ) {
+	else if ( !_outputUnchanged ) {
+		if ( !contentWritten && (ld::utils::write64(fd, wholeBuffer, _fileSize) == -1) ) {
 			throwf("can't write to output file: %s, errno=%d", _options.outputFilePath(), errno);
 		}
 		sDescriptorOfPathToRemove = -1;
@@ -4129,6 +4485,24 @@ void OutputFile::writeOutputFile(ld::Internal& state)
 	}
 }
 
+bool OutputFile::existingOutputMatches(const uint8_t* wholeBuffer) const
+{
+	int fd = ::open(_options.outputFilePath(), O_RDONLY);
+	if ( fd == -1 )
+		return false;
+	bool matches = false;
+	struct stat statBuf;
+	if ( (::fstat(fd, &statBuf) == 0) && ((uint64_t)statBuf.st_size == _fileSize) && (_fileSize != 0) ) {
+		void* p = ::mmap(NULL, _fileSize, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+		if ( p != MAP_FAILED ) {
+			matches = (memcmp(p, wholeBuffer, _fileSize) == 0);
+			::munmap(p, _fileSize);
+		}
+	}
+	::close(fd);
+	return matches;
+}
+
 struct AtomByNameSorter
 {
 	bool operator()(const ld::Atom* left, const ld::Atom* right) const
@@ -5661,7 +6035,9 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 	const char* 						curSegName   = "";
 	const ld::Internal::FinalSection* 	firstSegSect = nullptr;
 	const ld::Internal::FinalSection* 	lastSect     = nullptr;
-	for (ld::Internal::FinalSection* sect : state.sections) {
+	std::vector<size_t>					firstSectionOfSegment;
+	for (size_t sectIndex = 0; sectIndex < state.sections.size(); ++sectIndex) {
+		ld::Internal::FinalSection* sect = state.sections[sectIndex];
 		if ( strcmp(sect->segmentName(), curSegName) != 0 ) {
 			if ( firstSegSect != nullptr ) {
 				uint64_t segSize = pageAlign(lastSect->address + lastSect->size - firstSegSect->address);
@@ -5677,196 +6053,257 @@ void OutputFile::buildChainedFixupInfo(ld::Internal& state)
 			seg.pageSize      = pageSize;
 			seg.pointerFormat = chainedPointerFormat();
 			_chainedFixupSegments.push_back(seg);
+			firstSectionOfSegment.push_back(sectIndex);
 		}
-		for (const ld::Atom* atom : sect->atoms) {
-			// Record regular atoms that override a dylib's weak definitions
-			if ( (atom->scope() == ld::Atom::scopeGlobal) && atom->overridesDylibsWeakDef() ) {
-				this->overridesWeakExternalSymbols = true;
-				if ( _options.warnWeakExports()	)
-					warning("overrides weak external symbol: %s", atom->name());
-			}
+		lastSect = sect;
+	}
+	firstSectionOfSegment.push_back(state.sections.size());
 
-			const ld::Atom* target;
-			const ld::Atom* fromTarget;
-			bool hadSubtract;
-			uint64_t accumulator;
-			bool isBind = false;
-			bool isAuthPtr = false;
-			for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-				if ( fit->firstInCluster() ) {
-					accumulator = 0;
-					target = NULL;
-					hadSubtract = false;
-					isBind = false;
-					isAuthPtr = false;
-				}
-				if ( this->setsTarget(*fit) ) {
-					switch ( fit->binding ) {
-						case ld::Fixup::bindingNone:
-						case ld::Fixup::bindingByNameUnbound:
+	// Walk the fixups of each section in parallel, recording the pointers that need to be in a chain.
+	// Everything with a side effect (warnings, bind targets, page starts) is then applied in section
+	// order below, so the output and diagnostics are the same as walking the sections serially.
+	struct ChainedFixupSite
+	{
+		const ld::Atom*	atom;
+		const ld::Atom*	target;			// nullptr if this site only records that atom overrides a weak def
+		uint64_t		fixUpAddr;
+		uint64_t		addend;
+		uint32_t		offsetInAtom;
+		bool			isAuthPtr;
+		bool			isRebase;
+	};
+	struct SectionFixupSites
+	{
+		std::vector<ChainedFixupSite>	sites;
+		const char*						exception = nullptr;
+	};
+	std::vector<SectionFixupSites> sectionSites(state.sections.size());
+	SectionFixupSites* sectionSitesData = sectionSites.data();
+	dispatch_apply(state.sections.size(), DISPATCH_APPLY_AUTO, ^(size_t sectIndex) {
+		ld::Internal::FinalSection* sect = state.sections[sectIndex];
+		std::vector<ChainedFixupSite>& sites = sectionSitesData[sectIndex].sites;
+		try {
+			for (const ld::Atom* atom : sect->atoms) {
+				// Record regular atoms that override a dylib's weak definitions
+				if ( (atom->scope() == ld::Atom::scopeGlobal) && atom->overridesDylibsWeakDef() )
+					sites.push_back({ atom, nullptr, 0, 0, 0, false, false });
+
+				const ld::Atom* target;
+				const ld::Atom* fromTarget;
+				bool hadSubtract;
+				uint64_t accumulator;
+				bool isBind = false;
+				bool isAuthPtr = false;
+				for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+					if ( fit->firstInCluster() ) {
+						accumulator = 0;
+						target = NULL;
+						hadSubtract = false;
+						isBind = false;
+						isAuthPtr = false;
+					}
+					if ( this->setsTarget(*fit) ) {
+						switch ( fit->binding ) {
+							case ld::Fixup::bindingNone:
+							case ld::Fixup::bindingByNameUnbound:
+								break;
+							case ld::Fixup::bindingByContentBound:
+								target = fit->u.target;
+								break;
+							case ld::Fixup::bindingDirectlyBound:
+								target = fit->u.target;
+								break;
+							case ld::Fixup::bindingsIndirectlyBound:
+								target = state.indirectBindingTable[fit->u.bindingIndex];
+								break;
+						}
+						assert(target != NULL);
+					}
+					switch ( fit->kind ) {
+						case ld::Fixup::kindSetTargetAddress:
+							accumulator = addressOf(state, fit, &target);
+							if ( targetIsThumb(state, fit) )
+								accumulator |= 1;
+							if ( fit->contentAddendOnly || fit->contentDetlaToAddendOnly )
+								accumulator = 0;
 							break;
-						case ld::Fixup::bindingByContentBound:
-							target = fit->u.target;
+						case ld::Fixup::kindSubtractTargetAddress:
+							accumulator -= addressOf(state, fit, &fromTarget);
+							hadSubtract = true;
 							break;
-						case ld::Fixup::bindingDirectlyBound:
-							target = fit->u.target;
+						case ld::Fixup::kindAddAddend:
+							accumulator += fit->u.addend;
 							break;
-						case ld::Fixup::bindingsIndirectlyBound:
-							target = state.indirectBindingTable[fit->u.bindingIndex];
+						case ld::Fixup::kindSubtractAddend:
+							accumulator -= fit->u.addend;
+							break;
+						case ld::Fixup::kindSetTargetImageOffset:
+							hadSubtract = true;
+							break;
+						case ld::Fixup::kindStoreLittleEndian32:
+						case ld::Fixup::kindStoreLittleEndian64:
+							isBind = true;
+							break;
+						case ld::Fixup::kindStoreTargetAddressLittleEndian32:
+							accumulator = addressOf(state, fit, &target);
+							if ( targetIsThumb(state, fit) )
+								accumulator |= 1;
+							if ( fit->contentAddendOnly )
+								accumulator = 0;
+							isBind = true;
+							break;
+						case ld::Fixup::kindStoreTargetAddressLittleEndian64:
+							accumulator = addressOf(state, fit, &target);
+							if ( fit->contentAddendOnly )
+								accumulator = 0;
+							isBind = true;
 							break;
-					}
-					assert(target != NULL);
-				}
-				switch ( fit->kind ) {
-					case ld::Fixup::kindSetTargetAddress:
-						accumulator = addressOf(state, fit, &target);
-						if ( targetIsThumb(state, fit) )
-							accumulator |= 1;
-						if ( fit->contentAddendOnly || fit->contentDetlaToAddendOnly )
-							accumulator = 0;
-						break;
-					case ld::Fixup::kindSubtractTargetAddress:
-                        accumulator -= addressOf(state, fit, &fromTarget);
-						hadSubtract = true;
-						break;
-                    case ld::Fixup::kindAddAddend:
-						accumulator += fit->u.addend;
-						break;
-                    case ld::Fixup::kindSubtractAddend:
-						accumulator -= fit->u.addend;
-						break;
-                    case ld::Fixup::kindSetTargetImageOffset:
-                        hadSubtract = true;
-                        break;
-					case ld::Fixup::kindStoreLittleEndian32:
-					case ld::Fixup::kindStoreLittleEndian64:
-						isBind = true;
-						break;
-					case ld::Fixup::kindStoreTargetAddressLittleEndian32:
-						accumulator = addressOf(state, fit, &target);
-						if ( targetIsThumb(state, fit) )
-							accumulator |= 1;
-						if ( fit->contentAddendOnly )
-							accumulator = 0;
-						isBind = true;
-						break;
-					case ld::Fixup::kindStoreTargetAddressLittleEndian64:
-						accumulator = addressOf(state, fit, &target);
-						if ( fit->contentAddendOnly )
-							accumulator = 0;
-						isBind = true;
-						break;
 #if SUPPORT_ARCH_arm64e
-					case ld::Fixup::kindStoreLittleEndianAuth64:
-						if ( fit->contentAddendOnly ) {
-							// ld -r mode.  We want to write out the original relocation again
+						case ld::Fixup::kindStoreLittleEndianAuth64:
+							if ( fit->contentAddendOnly ) {
+								// ld -r mode.  We want to write out the original relocation again
+								break;
+							}
+							isBind = true;
+							break;
+						case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
+							accumulator = addressOf(state, fit, &target);
+							if ( fit->contentAddendOnly )
+								accumulator = 0;
+							isBind = true;
+							break;
+						case ld::Fixup::kindSetAuthData:
+							isAuthPtr = true;
 							break;
-						}
-						isBind = true;
-						break;
-					case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
-						accumulator = addressOf(state, fit, &target);
-						if ( fit->contentAddendOnly )
-							accumulator = 0;
-						isBind = true;
-						break;
-					case ld::Fixup::kindSetAuthData:
-						isAuthPtr = true;
-						break;
 #endif
-					default:
-						break;
-				}
-				if ( fit->lastInCluster() && isBind ) {
-					// this is an absolute pointer which means it needs to be in fixup chain
-					if ( (target != NULL) && !hadSubtract ) {
-						uint64_t fixUpAddr = atom->finalAddress() + fit->offsetInAtom;
-						//fprintf(stderr, "fixUpAddr=0x%0llX\n",fixUpAddr);
-
-						// Diagnose unaligned pointers
-						switch (_chainedFixupSegments.back().pointerFormat) {
-							case DYLD_CHAINED_PTR_ARM64E:
-							case DYLD_CHAINED_PTR_ARM64E_USERLAND:
-							case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
-								if ( fixUpAddr % 8 ) {
-									warning("pointer not aligned at address 0x%llX ('%s' + %u from %s)",
-											fixUpAddr, _options.demangleSymbol(atom->name()), fit->offsetInAtom, atom->safeFilePath());
-									_hasUnalignedFixup = true;
-								}
-								break;
-							case DYLD_CHAINED_PTR_ARM64E_KERNEL:
-							case DYLD_CHAINED_PTR_64:
-							case DYLD_CHAINED_PTR_64_OFFSET:
-							case DYLD_CHAINED_PTR_ARM64E_FIRMWARE:
-							case DYLD_CHAINED_PTR_32:
-							case DYLD_CHAINED_PTR_32_FIRMWARE:
-								if ( fixUpAddr % 4 ) {
-									warning("pointer not aligned at address 0x%llX ('%s' + %u from %s)",
-										   fixUpAddr, _options.demangleSymbol(atom->name()), fit->offsetInAtom, atom->safeFilePath());
-									_hasUnalignedFixup = true;
-								}
-								break;
-							default:
-								assert(0 && "unknown pointer format");
+						default:
+							break;
+					}
+					if ( fit->lastInCluster() && isBind ) {
+						// this is an absolute pointer which means it needs to be in fixup chain
+						if ( (target != NULL) && !hadSubtract ) {
+							uint64_t fixUpAddr = atom->finalAddress() + fit->offsetInAtom;
+							//fprintf(stderr, "fixUpAddr=0x%0llX\n",fixUpAddr);
+							const ld::Atom* bindTarget = target;
+							uint64_t        addend     = accumulator;
+							bool isRebase = !needsBind(bindTarget, isAuthPtr, &addend);
+							sites.push_back({ atom, bindTarget, fixUpAddr, addend, fit->offsetInAtom, isAuthPtr, isRebase });
 						}
+					}
+				}
+			}
+		}
+		catch (const char* msg) {
+			sectionSitesData[sectIndex].exception = msg;
+		}
+	});
 
-						// rdar://94340387 pointers at page boundaries can't be properly
-						// fixed up by the kernel when using pagein linking
-						if ( diagnosePointersOnPageBoundary ) {
-							uint64_t pageEnd = (fixUpAddr & ~((uint64_t)pageSize - 1)) + pageSize;
-							switch (_chainedFixupSegments.back().pointerFormat) {
-								case DYLD_CHAINED_PTR_ARM64E:
-								case DYLD_CHAINED_PTR_ARM64E_USERLAND:
-								case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
-								case DYLD_CHAINED_PTR_ARM64E_KERNEL:
-								case DYLD_CHAINED_PTR_64:
-								case DYLD_CHAINED_PTR_64_OFFSET:
-								case DYLD_CHAINED_PTR_ARM64E_FIRMWARE:
-									if ( (fixUpAddr + 8) > pageEnd ) {
-										warning("pointer not aligned at page boundary address 0x%llX ('%s' + %u from %s)",
-												fixUpAddr, _options.demangleSymbol(atom->name()), fit->offsetInAtom, atom->safeFilePath());
-										_hasUnalignedFixup = true;
-									}
-									break;
-								case DYLD_CHAINED_PTR_32:
-								case DYLD_CHAINED_PTR_32_FIRMWARE:
-									if ( (fixUpAddr + 4) > pageEnd ) {
-										warning("pointer not aligned at page boundary address 0x%llX ('%s' + %u from %s)",
-											   fixUpAddr, _options.demangleSymbol(atom->name()), fit->offsetInAtom, atom->safeFilePath());
-										_hasUnalignedFixup = true;
-									}
-									break;
-								default:
-									assert(0 && "unknown pointer format");
-							}
+	// diagnose and record bind targets in section order
+	for (size_t segIndex = 0; segIndex < _chainedFixupSegments.size(); ++segIndex) {
+		const uint32_t pointerFormat = _chainedFixupSegments[segIndex].pointerFormat;
+		for (size_t sectIndex = firstSectionOfSegment[segIndex]; sectIndex < firstSectionOfSegment[segIndex+1]; ++sectIndex) {
+			for (const ChainedFixupSite& site : sectionSites[sectIndex].sites) {
+				const ld::Atom* atom = site.atom;
+				if ( site.target == nullptr ) {
+					this->overridesWeakExternalSymbols = true;
+					if ( _options.warnWeakExports()	)
+						warning("overrides weak external symbol: %s", atom->name());
+					continue;
+				}
+				uint64_t fixUpAddr = site.fixUpAddr;
+
+				// Diagnose unaligned pointers
+				switch (pointerFormat) {
+					case DYLD_CHAINED_PTR_ARM64E:
+					case DYLD_CHAINED_PTR_ARM64E_USERLAND:
+					case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
+						if ( fixUpAddr % 8 ) {
+							warning("pointer not aligned at address 0x%llX ('%s' + %u from %s)",
+									fixUpAddr, _options.demangleSymbol(atom->name()), site.offsetInAtom, atom->safeFilePath());
+							_hasUnalignedFixup = true;
 						}
-
-						unsigned pageIndex = (fixUpAddr - _chainedFixupSegments.back().startAddr)/pageSize;
-						while ( pageIndex >= _chainedFixupSegments.back().pages.size() ) {
-							ChainedFixupPageInfo emptyPage;
-							_chainedFixupSegments.back().pages.push_back(emptyPage);
+						break;
+					case DYLD_CHAINED_PTR_ARM64E_KERNEL:
+					case DYLD_CHAINED_PTR_64:
+					case DYLD_CHAINED_PTR_64_OFFSET:
+					case DYLD_CHAINED_PTR_ARM64E_FIRMWARE:
+					case DYLD_CHAINED_PTR_32:
+					case DYLD_CHAINED_PTR_32_FIRMWARE:
+						if ( fixUpAddr % 4 ) {
+							warning("pointer not aligned at address 0x%llX ('%s' + %u from %s)",
+								   fixUpAddr, _options.demangleSymbol(atom->name()), site.offsetInAtom, atom->safeFilePath());
+							_hasUnalignedFixup = true;
 						}
-						uint16_t pageOffset = fixUpAddr - (_chainedFixupSegments.back().startAddr + pageIndex*pageSize);
-						bool isRebase = !needsBind(target, isAuthPtr, &accumulator);
-						if ( !isRebase || _options.outputSlidable() )
-							_chainedFixupSegments.back().pages[pageIndex].fixupOffsets.push_back(pageOffset);
-						if ( !isRebase )
-							_chainedFixupBinds.ensureTarget(target, isAuthPtr, accumulator);
+						break;
+					default:
+						assert(0 && "unknown pointer format");
+				}
+
+				// rdar://94340387 pointers at page boundaries can't be properly
+				// fixed up by the kernel when using pagein linking
+				if ( diagnosePointersOnPageBoundary ) {
+					uint64_t pageEnd = (fixUpAddr & ~((uint64_t)pageSize - 1)) + pageSize;
+					switch (pointerFormat) {
+						case DYLD_CHAINED_PTR_ARM64E:
+						case DYLD_CHAINED_PTR_ARM64E_USERLAND:
+						case DYLD_CHAINED_PTR_ARM64E_USERLAND24:
+						case DYLD_CHAINED_PTR_ARM64E_KERNEL:
+						case DYLD_CHAINED_PTR_64:
+						case DYLD_CHAINED_PTR_64_OFFSET:
+						case DYLD_CHAINED_PTR_ARM64E_FIRMWARE:
+							if ( (fixUpAddr + 8) > pageEnd ) {
+								warning("pointer not aligned at page boundary address 0x%llX ('%s' + %u from %s)",
+										fixUpAddr, _options.demangleSymbol(atom->name()), site.offsetInAtom, atom->safeFilePath());
+								_hasUnalignedFixup = true;
+							}
+							break;
+						case DYLD_CHAINED_PTR_32:
+						case DYLD_CHAINED_PTR_32_FIRMWARE:
+							if ( (fixUpAddr + 4) > pageEnd ) {
+								warning("pointer not aligned at page boundary address 0x%llX ('%s' + %u from %s)",
+									   fixUpAddr, _options.demangleSymbol(atom->name()), site.offsetInAtom, atom->safeFilePath());
+								_hasUnalignedFixup = true;
+							}
+							break;
+						default:
+							assert(0 && "unknown pointer format");
 					}
 				}
+
+				if ( !site.isRebase )
+					_chainedFixupBinds.ensureTarget(site.target, site.isAuthPtr, site.addend);
 			}
+			if ( sectionSites[sectIndex].exception != nullptr )
+				throw sectionSites[sectIndex].exception;
 		}
-		lastSect = sect;
 	}
 	if ( _hasUnalignedFixup )
 		throw "unaligned pointer(s)";
 
-	// sort all fixups on each page, so chain can be built
-	for (ChainedFixupSegInfo& segInfo : _chainedFixupSegments) {
+	// build the page starts of each segment in parallel, then sort all fixups on each page, so chain can be built
+	const bool               recordRebases      = _options.outputSlidable();
+	ChainedFixupSegInfo*     segmentsData       = _chainedFixupSegments.data();
+	const size_t*            firstSectionData   = firstSectionOfSegment.data();
+	dispatch_apply(_chainedFixupSegments.size(), DISPATCH_APPLY_AUTO, ^(size_t segIndex) {
+		ChainedFixupSegInfo& segInfo = segmentsData[segIndex];
+		for (size_t sectIndex = firstSectionData[segIndex]; sectIndex < firstSectionData[segIndex+1]; ++sectIndex) {
+			for (const ChainedFixupSite& site : sectionSitesData[sectIndex].sites) {
+				if ( site.target == nullptr )
+					continue;
+				unsigned pageIndex = (site.fixUpAddr - segInfo.startAddr)/pageSize;
+				while ( pageIndex >= segInfo.pages.size() ) {
+					ChainedFixupPageInfo emptyPage;
+					segInfo.pages.push_back(emptyPage);
+				}
+				uint16_t pageOffset = site.fixUpAddr - (segInfo.startAddr + pageIndex*pageSize);
+				if ( !site.isRebase || recordRebases )
+					segInfo.pages[pageIndex].fixupOffsets.push_back(pageOffset);
+			}
+		}
 		for (ChainedFixupPageInfo& pageInfo : segInfo.pages) {
 			std::sort(pageInfo.fixupOffsets.begin(), pageInfo.fixupOffsets.end());
 		}
-	}
+	});
 
     if ( _hasChainedFixups && (_chainedInfoAtom != nullptr) )
         _chainedInfoAtom->encode();
@@ -7328,6 +7765,139 @@ void OutputFile::writeMapFile(ld::Internal& state)
 	}
 }
 
+void OutputFile::writeBinaryMapFile(ld::Internal& state)
+{
+	// see BinaryMap.h for the layout
+	std::string strings;
+	auto addString = [&](const char* str) -> uint32_t {
+		if ( strings.size() + strlen(str) + 1 > UINT32_MAX )
+			throwf("too many symbols for binary map file: %s", _options.binaryMapPath());
+		uint32_t offset = (uint32_t)strings.size();
+		strings.append(str);
+		strings.push_back('\0');
+		return offset;
+	};
+	ld::binarymap::Header header;
+	bzero(&header, sizeof(header));
+	memcpy(header.magic, ld::binarymap::kMagic, sizeof(header.magic));
+	header.version		= ld::binarymap::kVersion;
+	header.outputPath	= addString(_options.outputFilePath());
+	header.arch			= addString(_options.architectureName());
+
+	// files are numbered by ordinal like in the -map file, 0 is linker synthesized
+	std::vector<const ld::Atom*> atoms;
+	std::map<ld::File::Ordinal, const ld::File*> ordinalToReader;
+	std::vector<ld::binarymap::Section> sections;
+	std::vector<uint32_t> sectionIndexes;
+	for (ld::Internal::FinalSection* sect : state.sections) {
+		if ( sect->isSectionHidden() )
+			continue;
+		uint32_t sectionIndex = (uint32_t)sections.size();
+		sections.push_back({ sect->address, sect->size, addString(sect->segmentName()), addString(sect->sectionName()) });
+		for (const ld::Atom* atom : sect->atoms) {
+			atoms.push_back(atom);
+			sectionIndexes.push_back(sectionIndex);
+		}
+	}
+	header.deadAtomCount = (uint32_t)state.deadAtoms.size();
+	for (const ld::Atom* atom : state.deadAtoms) {
+		atoms.push_back(atom);
+		sectionIndexes.push_back(ld::binarymap::kNone);
+	}
+	std::unordered_map<const ld::Atom*, uint32_t> atomIndexes;
+	atomIndexes.reserve(atoms.size());
+	for (const ld::Atom* atom : atoms) {
+		atomIndexes.insert({ atom, (uint32_t)atomIndexes.size() });
+		if ( const ld::File* reader = atom->originalFile() )
+			ordinalToReader[reader->ordinal()] = reader;
+	}
+	std::unordered_map<const ld::File*, uint32_t> readerToFileIndex;
+	std::vector<uint32_t> files;
+	files.push_back(addString("linker synthesized"));
+	for (const auto& entry : ordinalToReader) {
+		readerToFileIndex[entry.second] = (uint32_t)files.size();
+		files.push_back(addString(entry.second->path()));
+	}
+	auto indexOf = [&](const ld::Atom* atom) -> uint32_t {
+		const auto pos = atomIndexes.find(atom);
+		return ( pos != atomIndexes.end() ) ? pos->second : ld::binarymap::kNone;
+	};
+
+	// fill in atom columns
+	const size_t atomCount = atoms.size();
+	std::vector<uint64_t> addresses(atomCount);
+	std::vector<uint64_t> sizes(atomCount);
+	std::vector<uint32_t> names(atomCount);
+	std::vector<uint32_t> fileIndexes(atomCount);
+	std::vector<uint32_t> aliasOf(atomCount, ld::binarymap::kNone);
+	std::vector<uint32_t> liveReferrers(atomCount, ld::binarymap::kNone);
+	for (size_t i=0; i < atomCount; ++i) {
+		const ld::Atom* atom = atoms[i];
+		addresses[i] = (sectionIndexes[i] != ld::binarymap::kNone) ? atom->finalAddress() : 0;
+		sizes[i] = atom->size();
+		names[i] = addString((atom->name() != NULL) ? atom->name() : "");
+		const ld::File* reader = atom->originalFile();
+		fileIndexes[i] = (reader != NULL) ? readerToFileIndex[reader] : 0;
+		// an alias (from -alias or code de-duplication) has no content and follows on to the atom it names
+		if ( atom->size() == 0 ) {
+			for (ld::Fixup::iterator fit = atom->fixupsBegin(); fit != atom->fixupsEnd(); ++fit) {
+				if ( (fit->kind == ld::Fixup::kindNoneFollowOn) && (fit->binding == ld::Fixup::bindingDirectlyBound) ) {
+					aliasOf[i] = indexOf(fit->u.target);
+					break;
+				}
+			}
+		}
+		const auto pos = state.liveReferrers.find(atom);
+		if ( pos != state.liveReferrers.end() )
+			liveReferrers[i] = indexOf(pos->second);
+	}
+	header.atomCount	= (uint32_t)atomCount;
+	header.sectionCount	= (uint32_t)sections.size();
+	header.fileCount	= (uint32_t)files.size();
+
+	// lay out tables
+	uint64_t offset = sizeof(header);
+	auto place = [&](uint64_t& tableOffset, uint64_t size) {
+		tableOffset = offset;
+		offset = (offset + size + 7) & (~7ULL);
+	};
+	place(header.sectionsOffset,		sections.size()*sizeof(ld::binarymap::Section));
+	place(header.filesOffset,			files.size()*sizeof(uint32_t));
+	place(header.addressesOffset,		atomCount*sizeof(uint64_t));
+	place(header.sizesOffset,			atomCount*sizeof(uint64_t));
+	place(header.namesOffset,			atomCount*sizeof(uint32_t));
+	place(header.sectionIndexesOffset,	atomCount*sizeof(uint32_t));
+	place(header.fileIndexesOffset,		atomCount*sizeof(uint32_t));
+	place(header.aliasOfOffset,			atomCount*sizeof(uint32_t));
+	place(header.liveReferrersOffset,	atomCount*sizeof(uint32_t));
+	place(header.stringsOffset,			strings.size());
+	header.stringsSize = strings.size();
+
+	FILE* mapFile = fopen(_options.binaryMapPath(), "w");
+	if ( mapFile == NULL )
+		throwf("could not write binary map file: %s, errno=%d", _options.binaryMapPath(), errno);
+	bool ok = true;
+	auto writeTable = [&](uint64_t tableOffset, const void* content, size_t size) {
+		if ( ok && (fseeko(mapFile, tableOffset, SEEK_SET) != 0 || fwrite(content, 1, size, mapFile) != size) )
+			ok = false;
+	};
+	writeTable(0,							&header, sizeof(header));
+	writeTable(header.sectionsOffset,		sections.data(), sections.size()*sizeof(ld::binarymap::Section));
+	writeTable(header.filesOffset,			files.data(), files.size()*sizeof(uint32_t));
+	writeTable(header.addressesOffset,		addresses.data(), atomCount*sizeof(uint64_t));
+	writeTable(header.sizesOffset,			sizes.data(), atomCount*sizeof(uint64_t));
+	writeTable(header.namesOffset,			names.data(), atomCount*sizeof(uint32_t));
+	writeTable(header.sectionIndexesOffset,	sectionIndexes.data(), atomCount*sizeof(uint32_t));
+	writeTable(header.fileIndexesOffset,	fileIndexes.data(), atomCount*sizeof(uint32_t));
+	writeTable(header.aliasOfOffset,		aliasOf.data(), atomCount*sizeof(uint32_t));
+	writeTable(header.liveReferrersOffset,	liveReferrers.data(), atomCount*sizeof(uint32_t));
+	writeTable(header.stringsOffset,		strings.data(), strings.size());
+	if ( fclose(mapFile) != 0 )
+		ok = false;
+	if ( !ok )
+		throwf("could not write binary map file: %s, errno=%d", _options.binaryMapPath(), errno);
+}
+
 static std::string realPathString(const char* path)
 {
 	char realName[MAXPATHLEN];
@@ -7887,6 +8457,7 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 	// phase 1: build state.stabs and _importedAtoms, _exportedAtoms, _localAtoms in parallel
 	__block const char* exceptionMsg = nullptr;
 	dispatch_group_async(group, queue, ^{
+		TraceSpan span("synthesizeDebugNotes", "linkedit");
 		try {
 			this->synthesizeDebugNotes(state);	// needs state.section.atoms, updates: state.stabs
 		}
@@ -7895,6 +8466,7 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 		}
 	});
 	dispatch_group_async(group, queue, ^{
+		TraceSpan span("partitionSymbolTable", "linkedit");
 		try {
 			this->partitionSymbolTable(state);	// needs state.section.atoms, updates: _importedAtoms, _exportedAtoms, _localAtoms, `Atom::_outputSymbolIndex`
 		}
@@ -7912,6 +8484,7 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 	// phase 3: build linkedit parts in parallel that depend on results of phase 1
 	if ( _hasDyldInfo || _hasSectionRelocations || _hasLocalRelocations || _hasExternalRelocations || _hasThreadedPageStarts ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("buildLinkEditOpcodes", "linkedit");
 			try {
 				this->buildLinkEditOpcodes(state);	// needs state.section.atoms, `Atom::_outputSymbolIndex`, updates: _rebasingInfoAtom, _bindingInfoAtom, _weakBindingInfoAtom, _weakBindingInfoAtom, _sectionsRelocationsAtom
 			}
@@ -7922,6 +8495,7 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 	}
 	else if ( _hasChainedFixups ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("buildChainedFixupInfo", "linkedit");
 			try {
 				this->buildChainedFixupInfo(state);  // needs state.section.atoms, updates: _chainedFixupSegments, _importedSymbolsCount, _chainedInfoAtom
 			}
@@ -7932,12 +8506,14 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 	}
 	if ( _options.sharedRegionEligible() ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("makeSplitSegInfo", "linkedit");
 			this->makeSplitSegInfo(state);	 // needs state.section.atoms, updates: _splitSegInfoAtom
 			_splitSegInfoAtom->encode();
 		});
 	}
 	if ( _exportInfoAtom != nullptr ) {
 		dispatch_group_async(group, queue, ^{
+				TraceSpan span("exportInfo", "linkedit");
 				try {
 					_exportInfoAtom->encode(); 		// needs _exportedAtoms, updates: _exportInfoAtom
 				} catch ( const char* msg ) {
@@ -7946,6 +8522,7 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 		});
 	}
 	dispatch_group_async(group, queue, ^{
+		TraceSpan span("symbolTable", "linkedit");
 		try {
 			_symbolTableAtom->encode();			// needs _importedAtoms, _exportedAtoms, _localAtoms, state.stabs, updates: _symbolTableAtom
 			_indirectSymbolTableAtom->encode(); // needs state.section.atoms, `Atom::_outputSymbolIndex`, updates:  _indirectSymbolTableAtom
@@ -7956,16 +8533,19 @@ void OutputFile::buildLINKEDITContent(ld::Internal& state)
 	});
 	if ( _functionStartsAtom != nullptr ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("functionStarts", "linkedit");
 			_functionStartsAtom->encode();	// needs state.section.atoms
 		});
 	}
 	if ( _dataInCodeAtom != nullptr ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("dataInCode", "linkedit");
 			_dataInCodeAtom->encode();		// needs state.section.atoms
 		});
 	}
 	if ( _optimizationHintsAtom != nullptr ) {
 		dispatch_group_async(group, queue, ^{
+			TraceSpan span("optimizationHints", "linkedit");
 			_optimizationHintsAtom->encode(); // needs state.section.atoms
 		});
 	}
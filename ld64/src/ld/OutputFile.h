@@ -66,6 +66,7 @@ public:
 	uint32_t					encryptedTextEndOffset()	{ return _encryptedTEXTendOffset; }
 	int							compressedOrdinalForAtom(const ld::Atom* target) const;
 	uint64_t					fileSize() const { return _fileSize; }
+	bool						outputUnchanged() const { return _outputUnchanged; }
 
 	bool						needsBind(const ld::Atom*& toTarget, bool authPtr, uint64_t* accumulator = nullptr,
 										  uint64_t* inlineAddend = nullptr, uint32_t* bindOrdinal = nullptr,
@@ -180,6 +181,9 @@ public:
 private:
 	void						writeAtoms(ld::Internal& state, uint8_t* wholeBuffer);
 	void						computeContentUUID(ld::Internal& state, uint8_t* wholeBuffer);
+	uint64_t					headerAndLoadCommandsEnd(ld::Internal& state) const;
+	void						hashOutput(ld::Internal& state, uint8_t* wholeBuffer);
+	void						hashAndWriteOutput(ld::Internal& state, int fd, uint8_t* wholeBuffer);
 	void						buildDylibOrdinalMapping(ld::Internal&);
 	bool						hasOrdinalForInstallPath(const char* path, int* ordinal);
 	void						addLoadCommands(ld::Internal& state);
@@ -189,6 +193,7 @@ private:
 	void						buildLinkEditOpcodes(ld::Internal& state);
 	void						partitionSymbolTable(ld::Internal& state);
 	void						writeOutputFile(ld::Internal& state);
+	bool						existingOutputMatches(const uint8_t* wholeBuffer) const;
 	void						assignSymbolIndexes(ld::Internal& state);
 	void						addSectionRelocs(ld::Internal& state, ld::Internal::FinalSection* sect,  
 												const ld::Atom* atom, ld::Fixup* fixupWithTarget, 
@@ -233,6 +238,18 @@ private:
 	void						encodeLINKEDIT(ld::Internal& state);
 	void						buildLINKEDITContent(ld::Internal& state);
 	void						applyFixUps(ld::Internal& state, uint64_t mhAddress, const ld::Atom*  atom, uint8_t* buffer);
+	// Fixups of a section lowered out of the atom graph for writeAtoms(), as struct-of-arrays
+	// batches per kernel.  Each entry is a one fixup cluster whose result depends only on the
+	// fixup's address and its already resolved target address.
+	enum FixupKernel			{ kernelARM64Branch26, kernelARM64Page21, kernelARM64PageOff12, kernelX86PCRel32, kernelCount };
+	struct LoweredFixups {
+		std::vector<uint64_t>		fixupAddress[kernelCount];
+		std::vector<uint64_t>		targetAddress[kernelCount];
+		std::vector<uint32_t>		atomIndex[kernelCount];		// index into the section's atoms
+	};
+	bool						lowerFixUps(const ld::Internal& state, const ld::Atom* atom, uint32_t atomIndex, LoweredFixups& lowered);
+	void						applyLoweredFixUps(const ld::Internal::FinalSection* sect, const LoweredFixups& lowered,
+													uint8_t* wholeBuffer, std::vector<uint32_t>& failedAtoms);
 	uint64_t					addressOf(const ld::Internal& state, const ld::Fixup* fixup, const ld::Atom** target);
 	uint64_t					addressAndTarget(const ld::Internal& state, const ld::Fixup* fixup, const ld::Atom** target);
 	bool						targetIsThumb(ld::Internal& state, const ld::Fixup* fixup);
@@ -252,6 +269,7 @@ private:
 	void						makeSplitSegInfo(ld::Internal& state);
 	void						makeSplitSegInfoV2(ld::Internal& state);
 	void						writeMapFile(ld::Internal& state);
+	void						writeBinaryMapFile(ld::Internal& state);
 	void						writeJSONEntry(ld::Internal& state);
 	uint64_t					lookBackAddend(ld::Fixup::iterator fit);
 	bool						takesNoDiskSpace(const ld::Section* sect);
@@ -385,6 +403,7 @@ private:
 		  bool								_hasOptimizationHints;
 		  bool								_hasCodeSignature;
 	uint64_t								_fileSize;
+	bool									_outputUnchanged = false;
 	std::map<uint64_t, uint32_t>			_lazyPointerAddressToInfoOffset;
 	uint32_t								_encryptedTEXTstartOffset;
 	uint32_t								_encryptedTEXTendOffset;
@@ -322,6 +322,7 @@ void Resolver::buildAtomList()
 {
 	// each input files contributes initial atoms
 	_atoms.reserve(1024);
+	this->bindInitialNames();
 	_inputFiles.forEachInitialAtom(*this, _internal);
     
 	_completedInitialObjectFiles = true;
@@ -329,6 +330,23 @@ void Resolver::buildAtomList()
 	//_symbolTable.printStatistics();
 }
 
+void Resolver::bindInitialNames()
+{
+	// object files on the command line are already parsed, so the names they use can be
+	// interned on all cores before doAtom() visits their atoms one at a time
+	ld::File::AtomSinkHandler sink;
+	_inputFiles.forEachInitialObjectAtom(sink);
+	if ( _options.removeSwiftReflectionMetadataSections() ) {
+		sink.atoms.erase(std::remove_if(sink.atoms.begin(), sink.atoms.end(), [&](const ld::Atom* atom) {
+			return this->isRemovedSwiftReflectionAtom(*atom);
+		}), sink.atoms.end());
+	}
+	// in final linked images convertReferencesToIndirect() removes dtrace probe references instead
+	const bool keepDtraceProbes = (_options.outputKind() == Options::kObjectFile);
+	_symbolTable.bindNamesConcurrently(sink.atoms, ^(const ld::Fixup& fixup) {
+		return keepDtraceProbes || !isDtraceProbe(fixup.kind);
+	});
+}
 
 void Resolver::doLinkerOption(const std::vector<const char*>& linkerOption, const char* fileName)
 {
@@ -719,14 +737,8 @@ void Resolver::doAtom(const ld::Atom& atom)
 		warning("'%s' is implemented in bitcode, but it was loaded too late", atom.name());
 
 	// If asked to do so, drop any atoms from three sections that store reflection metadata from the Swift compiler.
-	if ( _options.removeSwiftReflectionMetadataSections() ) {
-		if ( strcmp(atom.section().sectionName(), "__swift5_reflstr") == 0 )
-			return;
-		if ( strcmp(atom.section().sectionName(), "__swift5_fieldmd") == 0 )
-			return;
-		if ( strcmp(atom.section().sectionName(), "__swift5_assocty") == 0 )
-			return;
-	}
+	if ( _options.removeSwiftReflectionMetadataSections() && isRemovedSwiftReflectionAtom(atom) )
+		return;
 
 	// add to list of known atoms
 	_atoms.push_back(&atom);
@@ -849,6 +861,17 @@ void Resolver::doAtom(const ld::Atom& atom)
 	}
 }
 
+bool Resolver::isRemovedSwiftReflectionAtom(const ld::Atom& atom) const
+{
+	if ( strcmp(atom.section().sectionName(), "__swift5_reflstr") == 0 )
+		return true;
+	if ( strcmp(atom.section().sectionName(), "__swift5_fieldmd") == 0 )
+		return true;
+	if ( strcmp(atom.section().sectionName(), "__swift5_assocty") == 0 )
+		return true;
+	return false;
+}
+
 bool Resolver::isDtraceProbe(ld::Fixup::Kind kind)
 {
 	switch (kind) {
@@ -1091,6 +1114,91 @@ void Resolver::resolveAllUndefines()
 }
 
 
+// fixups of these kinds keep their target alive when dead stripping
+static bool fixupKeepsTargetLive(ld::Fixup::Kind kind)
+{
+	switch ( kind ) {
+		case ld::Fixup::kindNone:
+		case ld::Fixup::kindNoneFollowOn:
+		case ld::Fixup::kindNoneGroupSubordinate:
+		case ld::Fixup::kindNoneGroupSubordinateFDE:
+		case ld::Fixup::kindNoneGroupSubordinateLSDA:
+		case ld::Fixup::kindNoneGroupSubordinatePersonality:
+		case ld::Fixup::kindSetTargetAddress:
+		case ld::Fixup::kindSubtractTargetAddress:
+		case ld::Fixup::kindStoreTargetAddressLittleEndian32:
+		case ld::Fixup::kindStoreTargetAddressLittleEndian64:
+#if SUPPORT_ARCH_arm64e
+		case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
+#endif
+		case ld::Fixup::kindStoreTargetAddressBigEndian32:
+		case ld::Fixup::kindStoreTargetAddressBigEndian64:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32:
+		case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoad:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoad:
+		case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoad:
+		case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoadNowLEA:
+		case ld::Fixup::kindStoreTargetAddressARMBranch24:
+		case ld::Fixup::kindStoreTargetAddressThumbBranch22:
+#if SUPPORT_ARCH_arm64
+		case ld::Fixup::kindStoreTargetAddressARM64Branch26:
+		case ld::Fixup::kindStoreTargetAddressARM64Page21:
+		case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64GOTLeaPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPage21:
+		case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPage21:
+#endif
+			return true;
+		default:
+			return false;
+	}
+}
+
+// binds a fixup that was not yet bound to a slot and returns the atom it keeps alive, if any
+const ld::Atom* Resolver::deadStripTarget(ld::Fixup* fit)
+{
+	if ( fit->binding == ld::Fixup::bindingByContentBound ) {
+		// normally this was done in convertReferencesToIndirect()
+		// but a archive loaded .o file may have a forward reference
+		SymbolTable::IndirectBindingSlot slot;
+		const ld::Atom* dummy;
+		switch ( fit->u.target->combine() ) {
+			case ld::Atom::combineNever:
+			case ld::Atom::combineByName:
+				assert(0 && "wrong combine type for bind by content");
+				break;
+			case ld::Atom::combineByNameAndContent:
+				slot = _symbolTable.findSlotForContent(fit->u.target, &dummy);
+				fit->binding = ld::Fixup::bindingsIndirectlyBound;
+				fit->u.bindingIndex = slot;
+				break;
+			case ld::Atom::combineByNameAndReferences:
+				slot = _symbolTable.findSlotForReferences(fit->u.target, &dummy);
+				fit->binding = ld::Fixup::bindingsIndirectlyBound;
+				fit->u.bindingIndex = slot;
+				break;
+		}
+	}
+	switch ( fit->binding ) {
+		case ld::Fixup::bindingDirectlyBound:
+			return fit->u.target;
+		case ld::Fixup::bindingByNameUnbound:
+			// doAtom() did not convert to indirect in dead-strip mode, so that now
+			fit->u.bindingIndex = _symbolTable.findSlotForName(fit->u.name);
+			fit->binding = ld::Fixup::bindingsIndirectlyBound;
+			// fall into next case
+			[[clang::fallthrough]];
+		case ld::Fixup::bindingsIndirectlyBound:
+			return _internal.indirectBindingTable[fit->u.bindingIndex];
+		default:
+			assert(0 && "bad binding during dead stripping");
+	}
+	return NULL;
+}
+
 void Resolver::markLive(const ld::Atom& atom, WhyLiveBackChain* previous)
 {
 	//fprintf(stderr, "markLive(%p) %s\n", &atom, atom.name());
@@ -1114,94 +1222,107 @@ void Resolver::markLive(const ld::Atom& atom, WhyLiveBackChain* previous)
 		
 	// mark this atom is live
 	(const_cast<ld::Atom*>(&atom))->setLive();
+	if ( _recordLiveReferrers && (previous->referer != &atom) )
+		_internal.liveReferrers[&atom] = previous->referer;
 	
 	// mark all atoms it references as live
 	WhyLiveBackChain thisChain;
 	thisChain.previous = previous;
 	thisChain.referer = &atom;
 	for (ld::Fixup::iterator fit = atom.fixupsBegin(), end=atom.fixupsEnd(); fit != end; ++fit) {
-		const ld::Atom* target;
-		switch ( fit->kind ) {
-			case ld::Fixup::kindNone:
-			case ld::Fixup::kindNoneFollowOn:
-			case ld::Fixup::kindNoneGroupSubordinate:
-			case ld::Fixup::kindNoneGroupSubordinateFDE:
-			case ld::Fixup::kindNoneGroupSubordinateLSDA:
-			case ld::Fixup::kindNoneGroupSubordinatePersonality:
-			case ld::Fixup::kindSetTargetAddress:
-			case ld::Fixup::kindSubtractTargetAddress:
-			case ld::Fixup::kindStoreTargetAddressLittleEndian32:
-			case ld::Fixup::kindStoreTargetAddressLittleEndian64:
-#if SUPPORT_ARCH_arm64e
-			case ld::Fixup::kindStoreTargetAddressLittleEndianAuth64:
-#endif
-			case ld::Fixup::kindStoreTargetAddressBigEndian32:
-			case ld::Fixup::kindStoreTargetAddressBigEndian64:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32:
-			case ld::Fixup::kindStoreTargetAddressX86BranchPCRel32:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoad:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32GOTLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoad:
-			case ld::Fixup::kindStoreTargetAddressX86PCRel32TLVLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoad:
-			case ld::Fixup::kindStoreTargetAddressX86Abs32TLVLoadNowLEA:
-			case ld::Fixup::kindStoreTargetAddressARMBranch24:
-			case ld::Fixup::kindStoreTargetAddressThumbBranch22:
-#if SUPPORT_ARCH_arm64
-			case ld::Fixup::kindStoreTargetAddressARM64Branch26:
-			case ld::Fixup::kindStoreTargetAddressARM64Page21:
-			case ld::Fixup::kindStoreTargetAddressARM64GOTLoadPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64GOTLeaPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadPage21:
-			case ld::Fixup::kindStoreTargetAddressARM64TLVPLoadNowLeaPage21:
-#endif
-				if ( fit->binding == ld::Fixup::bindingByContentBound ) {
-					// normally this was done in convertReferencesToIndirect()
-					// but a archive loaded .o file may have a forward reference
+		if ( !fixupKeepsTargetLive(fit->kind) )
+			continue;
+		if ( const ld::Atom* target = deadStripTarget(fit) )
+			markLive(*target, &thisChain);
+	}
+
+}
+
+//
+// Marks everything reachable from roots live, one breadth first level at a time.  The fixups
+// of the atoms in a level are scanned in parallel, with live bits and the symbol table only
+// read.  Fixups that need a new slot, and the targets found, are then handled serially, so
+// the live set is the same as markLive() builds.  Not used with -why_live, which needs the
+// chain of references to each atom.
+//
+void Resolver::markLiveConcurrently(const std::vector<const ld::Atom*>& roots)
+{
+	const size_t kAtomsPerChunk = 1024;
+	struct Reference { const ld::Atom* target; const ld::Atom* referer; };
+	struct LateBinding { ld::Fixup* fixup; const ld::Atom* referer; };
+	std::vector<const ld::Atom*> level;
+	for (const ld::Atom* root : roots) {
+		if ( !root->live() ) {
+			(const_cast<ld::Atom*>(root))->setLive();
+			level.push_back(root);
+		}
+	}
+
+	while ( !level.empty() ) {
+		const size_t chunkCount = (level.size() + kAtomsPerChunk - 1) / kAtomsPerChunk;
+		std::vector<std::vector<Reference>> found(chunkCount);
+		std::vector<std::vector<LateBinding>> deferred(chunkCount);
+		const ld::Atom* const* levelAtoms = level.data();
+		const size_t levelCount = level.size();
+		std::vector<Reference>* chunkFound = found.data();
+		std::vector<LateBinding>* chunkDeferred = deferred.data();
+		const ld::Atom* const* indirectTable = _internal.indirectBindingTable.data();
+		const SymbolTable& symbolTable = _symbolTable;
+
+		// each atom is in one level only, so its fixups are updated by one thread
+		dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+			const size_t end = std::min(levelCount, (chunk+1)*kAtomsPerChunk);
+			for (size_t i=chunk*kAtomsPerChunk; i < end; ++i) {
+				const ld::Atom* atom = levelAtoms[i];
+				for (ld::Fixup::iterator fit = atom->fixupsBegin(), fend=atom->fixupsEnd(); fit != fend; ++fit) {
+					if ( !fixupKeepsTargetLive(fit->kind) )
+						continue;
+					const ld::Atom* target = NULL;
 					SymbolTable::IndirectBindingSlot slot;
-					const ld::Atom* dummy;
-					switch ( fit->u.target->combine() ) {
-						case ld::Atom::combineNever:
-						case ld::Atom::combineByName:
-							assert(0 && "wrong combine type for bind by content");
+					switch ( fit->binding ) {
+						case ld::Fixup::bindingDirectlyBound:
+							target = fit->u.target;
 							break;
-						case ld::Atom::combineByNameAndContent:
-							slot = _symbolTable.findSlotForContent(fit->u.target, &dummy);
-							fit->binding = ld::Fixup::bindingsIndirectlyBound;
-							fit->u.bindingIndex = slot;
+						case ld::Fixup::bindingsIndirectlyBound:
+							target = indirectTable[fit->u.bindingIndex];
 							break;
-						case ld::Atom::combineByNameAndReferences:
-							slot = _symbolTable.findSlotForReferences(fit->u.target, &dummy);
-							fit->binding = ld::Fixup::bindingsIndirectlyBound;
-							fit->u.bindingIndex = slot;
+						case ld::Fixup::bindingByNameUnbound:
+							if ( symbolTable.findExistingSlotForName(fit->u.name, slot) ) {
+								fit->u.bindingIndex = slot;
+								fit->binding = ld::Fixup::bindingsIndirectlyBound;
+								target = indirectTable[slot];
+							}
+							else {
+								chunkDeferred[chunk].push_back({ fit, atom });
+							}
+							break;
+						default:
+							chunkDeferred[chunk].push_back({ fit, atom });
 							break;
 					}
+					if ( (target != NULL) && !target->live() )
+						chunkFound[chunk].push_back({ target, atom });
 				}
-				switch ( fit->binding ) {
-					case ld::Fixup::bindingDirectlyBound:
-						markLive(*(fit->u.target), &thisChain);
-						break;
-					case ld::Fixup::bindingByNameUnbound:
-						// doAtom() did not convert to indirect in dead-strip mode, so that now
-						fit->u.bindingIndex = _symbolTable.findSlotForName(fit->u.name);
-						fit->binding = ld::Fixup::bindingsIndirectlyBound;
-						// fall into next case
-						[[clang::fallthrough]];
-					case ld::Fixup::bindingsIndirectlyBound:
-						target = _internal.indirectBindingTable[fit->u.bindingIndex];
-						if ( target != NULL ) {
-							this->markLive(*target, &thisChain);
-						}
-						break;
-					default:
-						assert(0 && "bad binding during dead stripping");
-				}
-				break;
-            default:
-                break;    
+			}
+		});
+
+		std::vector<const ld::Atom*> nextLevel;
+		auto claim = [&](const ld::Atom* target, const ld::Atom* referer) {
+			if ( (target != NULL) && !target->live() ) {
+				(const_cast<ld::Atom*>(target))->setLive();
+				if ( _recordLiveReferrers )
+					_internal.liveReferrers[target] = referer;
+				nextLevel.push_back(target);
+			}
+		};
+		for (size_t chunk=0; chunk < chunkCount; ++chunk) {
+			for (const Reference& reference : found[chunk])
+				claim(reference.target, reference.referer);
+			for (const LateBinding& binding : deferred[chunk])
+				claim(deadStripTarget(binding.fixup), binding.referer);
 		}
+		level.swap(nextLevel);
 	}
-
 }
 
 class NotLiveLTO {
@@ -1339,15 +1460,25 @@ void Resolver::deadStripOptimize(bool force)
 		for (const ld::Atom* atom : _atoms) {
 			(const_cast<ld::Atom*>(atom))->setLive(false);
 		}
+		_internal.liveReferrers.clear();
 	}
 
 	// mark all roots as live, and all atoms they reference
-	forEachDeadStripRoot(dontDeadStripIfReferencesLive, force, [this](const ld::Atom * atom) {
-		WhyLiveBackChain rootChain;
-		rootChain.previous = NULL;
-		rootChain.referer = atom;
-		this->markLive(*atom, &rootChain);
-	});
+	if ( _printWhyLive ) {
+		forEachDeadStripRoot(dontDeadStripIfReferencesLive, force, [this](const ld::Atom * atom) {
+			WhyLiveBackChain rootChain;
+			rootChain.previous = NULL;
+			rootChain.referer = atom;
+			this->markLive(*atom, &rootChain);
+		});
+	}
+	else {
+		std::vector<const ld::Atom*> roots;
+		forEachDeadStripRoot(dontDeadStripIfReferencesLive, force, [&roots](const ld::Atom * atom) {
+			roots.push_back(atom);
+		});
+		markLiveConcurrently(roots);
+	}
 	
 	// special case atoms that need to be live if they reference something live
 	for (const Atom* liveIfRefLiveAtom : dontDeadStripIfReferencesLive) {
@@ -1377,7 +1508,7 @@ void Resolver::deadStripOptimize(bool force)
 		// <rdar://problem/9777977> don't remove combinable atoms, they may come back in lto output
 		 auto notLiveIt = std::remove_if(_atoms.begin(), _atoms.end(), NotLiveLTO());
 		 // add dead atoms to internal state only when map file was requested
-		 if ( _options.generatedMapPath() != nullptr ) {
+		 if ( (_options.generatedMapPath() != nullptr) || (_options.binaryMapPath() != nullptr) ) {
 			 std::copy(notLiveIt, _atoms.end(), std::back_inserter(_internal.deadAtoms));
 		 }
 		_atoms.erase(notLiveIt, _atoms.end());
@@ -1386,7 +1517,7 @@ void Resolver::deadStripOptimize(bool force)
 	else {
 		 auto notLiveIt = std::remove_if(_atoms.begin(), _atoms.end(), NotLive());
 		 // add dead atoms to internal state only when map file was requested
-		 if ( _options.generatedMapPath() != nullptr ) {
+		 if ( (_options.generatedMapPath() != nullptr) || (_options.binaryMapPath() != nullptr) ) {
 			 std::copy(notLiveIt, _atoms.end(), std::back_inserter(_internal.deadAtoms));
 		 }
 		_atoms.erase(notLiveIt, _atoms.end());
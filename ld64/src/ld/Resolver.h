@@ -67,6 +67,7 @@ public:
 								  _ltoCodeGenFinished(false),
 								  _haveAliases(false), _havellvmProfiling(false),
 								  _printWhyLive(opts.printWhyLive()),
+								  _recordLiveReferrers(opts.binaryMapPath() != nullptr),
 								  _synthesizeObjcMsgSendStubs(opts.dyldLoadsOutput()),
 								  _needsObjcMsgSendProxy(false) {}
 								
@@ -86,6 +87,7 @@ private:
 
 	void					initializeState();
 	void					buildAtomList();
+	void					bindInitialNames();
 	void					addInitialUndefines();
 	void					deadStripOptimize(bool force=false);
 	template<typename T>
@@ -109,7 +111,10 @@ private:
 	const ld::Atom*			entryPoint(bool searchArchives);
 	bool					diagnoseAtomsWithUnalignedPointers() const;
 	void					markLive(const ld::Atom& atom, WhyLiveBackChain* previous);
+	void					markLiveConcurrently(const std::vector<const ld::Atom*>& roots);
+	const ld::Atom*			deadStripTarget(ld::Fixup* fixup);
 	bool					isDtraceProbe(ld::Fixup::Kind kind);
+	bool					isRemovedSwiftReflectionAtom(const ld::Atom& atom) const;
 	void					liveUndefines(std::vector<std::string_view>&);
 	void					remainingUndefines(std::vector<std::string_view>&);
 	bool					printReferencedBy(const char* name, SymbolTable::IndirectBindingSlot slot);
@@ -146,6 +151,7 @@ private:
 	bool							_haveAliases;
 	bool							_havellvmProfiling;
 	bool							_printWhyLive;
+	bool							_recordLiveReferrers;
 	bool							_synthesizeObjcMsgSendStubs;
 	bool							_needsObjcMsgSendProxy;
 };
@@ -35,6 +35,7 @@ static const char *frameworkStubsString     = "framework_stubs";    // directory
 static const char *dataFilesString          = "data_files";         // arbitrary data files referenced on the command line
 static const char *dylibStubsString         = "dylib_stubs";        // directory containing dylib stub info (text files)
 static const char *filesString              = "files";              // directory containing files
+static const char *outputsString            = "outputs";            // directory for files written when replaying the link command
 static const char *origCommandLineString    = "orig_command_line";  // text file containing the original command line
 static const char *linkCommandString        = "link_command";       // text file containing the snapshot equivalent command line
 static const char *assertFileString         = "assert_info";        // text file containing assertion failure logs
@@ -42,7 +43,7 @@ static const char *compileFileString        = "compile_stubs";      // text file
 
 Snapshot *Snapshot::globalSnapshot = NULL;
 
-Snapshot::Snapshot(const Options * opts) : fOptions(opts), fRecordArgs(false), fRecordObjects(false), fRecordDylibSymbols(false), fRecordArchiveFiles(false), fRecordUmbrellaFiles(false), fRecordDataFiles(false), fFrameworkArgAdded(false), fRecordKext(false), fSnapshotLocation(NULL), fSnapshotName(NULL), fRootDir(NULL), fFilelistFile(-1), fCopiedArchives(NULL)
+Snapshot::Snapshot(const Options * opts) : fOptions(opts), fRecordArgs(false), fRecordObjects(false), fRecordDylibSymbols(false), fRecordArchiveFiles(false), fRecordUmbrellaFiles(false), fRecordDataFiles(false), fFrameworkArgAdded(false), fRecordKext(false), fBenchmark(false), fOutputArgCount(0), fSnapshotLocation(NULL), fSnapshotName(NULL), fRootDir(NULL), fFilelistFile(-1), fCopiedArchives(NULL)
 {
     if (globalSnapshot != NULL)
         throw "only one snapshot supported";
@@ -79,6 +80,7 @@ void Snapshot::setSnapshotMode(SnapshotMode mode)
         fRecordUmbrellaFiles = false;
         fRecordDataFiles = false;
         fRecordKext = false;
+        fBenchmark = false;
 
         switch (mode) {
             case SNAPSHOT_DISABLED:
@@ -86,6 +88,10 @@ void Snapshot::setSnapshotMode(SnapshotMode mode)
             case SNAPSHOT_DEBUG:
                 fRecordArgs = fRecordObjects = fRecordDylibSymbols = fRecordArchiveFiles = fRecordUmbrellaFiles = fRecordDataFiles = true;
                 break;
+            case SNAPSHOT_BENCHMARK:
+                fRecordArgs = fRecordObjects = fRecordDylibSymbols = fRecordArchiveFiles = fRecordUmbrellaFiles = fRecordDataFiles = true;
+                fBenchmark = true;
+                break;
             default:
                 break;
         }
@@ -107,6 +113,9 @@ void Snapshot::setSnapshotName()
             if (fRecordKext) {
                 fSnapshotLocation = strdup(dirname((char *)fOutputPath));
                 asprintf((char **)&fSnapshotName, "%s.%s.ld", base, fArchString);
+            } else if (fBenchmark) {
+                // no time stamp, so corpus entries have predictable names
+                asprintf((char **)&fSnapshotName, "%s.ld-bench", base);
             } else {
                 time_t now = time(NULL);
                 struct tm t;
@@ -370,15 +379,23 @@ void Snapshot::recordRawArgs(int argc, const char *argv[])
 // argCount is the count of args to copy from the raw args vector
 // fileArg is the index relative to argIndex of a file arg. The file is copied into the
 // snapshot and the path is fixed up in the snapshot link command. (skipped if fileArg==-1)
-void Snapshot::addSnapshotLinkArg(int argIndex, int argCount, int fileArg)
+// outputArg is the index relative to argIndex of an output path, which benchmark snapshots
+// redirect into the snapshot outputs directory. (skipped if outputArg==-1)
+void Snapshot::addSnapshotLinkArg(int argIndex, int argCount, int fileArg, int outputArg)
 {
     if (fRootDir == NULL) {
-        fLog.push_back(Block_copy(^{ this->addSnapshotLinkArg(argIndex, argCount, fileArg); }));
+        fLog.push_back(Block_copy(^{ this->addSnapshotLinkArg(argIndex, argCount, fileArg, outputArg); }));
     } else {
         char buf[PATH_MAX];
         fArgIndicies.push_back(fArgs.size());
         for (int i=0, arg=argIndex; i<argCount && argIndex+1<(int)fRawArgs.size(); i++, arg++) {
-            if (i != fileArg) {
+            if (fBenchmark && i == outputArg) {
+                // redirect into the snapshot, creating the outputs directory.  The index
+                // keeps two outputs with the same leaf name (e.g. cache dirs) apart.
+                buildPath(buf, subdir(outputsString), NULL);
+                snprintf(buf, sizeof(buf), "%s/%s.%u", subdir(outputsString), basename((char *)fRawArgs[arg]), fOutputArgCount++);
+                fArgs.push_back(strdup(buf));
+            } else if (i != fileArg) {
                 fArgs.push_back(fRawArgs[arg]);
             } else {
                 if (fRecordDataFiles) {
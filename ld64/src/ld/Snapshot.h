@@ -26,6 +26,7 @@ public:
     typedef enum { 
         SNAPSHOT_DISABLED, // nothing is recorded
         SNAPSHOT_DEBUG, // records: .o, .dylib, .framework, .a, and other data files
+        SNAPSHOT_BENCHMARK, // records the same as SNAPSHOT_DEBUG, under a stable name, for replay by ld-bench
     } SnapshotMode;
     
     Snapshot(const Options * opts);
@@ -50,8 +51,11 @@ public:
     // argCount is the count of args to copy from the raw args vector
     // fileArg is the index relative to argIndex of a file arg. The file is copied into the
     // snapshot and the path is fixed up in the snapshot link command. (skipped if fileArg==-1)
+    // outputArg is the index relative to argIndex of a path the linker writes to. In benchmark
+    // snapshots the path is replaced by one in the snapshot "outputs" directory, so replaying
+    // the snapshot link command never writes outside the snapshot. (skipped if outputArg==-1)
     // recordRawArgs() must be called prior to the first call to addSnapshotLinkArg()
-    void addSnapshotLinkArg(int argIndex, int argCount=1, int fileArg=-1);
+    void addSnapshotLinkArg(int argIndex, int argCount=1, int fileArg=-1, int outputArg=-1);
     
     // record the -arch string
     void recordArch(const char *arch);
@@ -144,6 +148,8 @@ private:
     bool fRecordDataFiles;      // record other data files
     bool fFrameworkArgAdded;
     bool fRecordKext;
+    bool fBenchmark;            // snapshot is a benchmark corpus entry
+    unsigned fOutputArgCount;   // output path args redirected into the outputs dir so far
 
     const char *fSnapshotLocation; // parent directory of frootDir
     const char *fSnapshotName;    // a string to use in constructing the snapshot name
@@ -33,6 +33,7 @@
 #include <limits.h>
 #include <unistd.h>
 #include <assert.h>
+#include <dispatch/dispatch.h>
 
 #include <iostream>
 #include <sstream>
@@ -623,6 +624,116 @@ SymbolTable::IndirectBindingSlot SymbolTable::findSlotForName(const std::string_
 	return slot;
 }
 
+// find existing slot without creating one, safe to call concurrently while no slots are added
+bool SymbolTable::findExistingSlotForName(const std::string_view& name, IndirectBindingSlot& slot) const
+{
+	const auto pos = _byNameTable.find(name);
+	if ( pos == _byNameTable.end() )
+		return false;
+	slot = pos->second;
+	return true;
+}
+
+//
+// Interns the names defined and referenced by atoms that are about to be added, and binds their
+// by-name fixups to slots, so that add() and convertReferencesToIndirect() mostly find work done.
+// Names are split by hash into shards that are uniqued without locks, and new slots are then
+// handed out in the order the names were first used, so slot numbers do not depend on scheduling.
+// Which atom wins a name is still decided by add(), one atom at a time in command line order.
+//
+// The table itself is not sharded and add() is not made concurrent.  Which definition wins a
+// name, how weak, tentative and duplicate definitions combine, and which errors and warnings are
+// reported all depend on the order atoms are added in.  Slot numbers are also handed out as
+// names are first seen and end up in the fixups.  Parallel inserts would make all of these depend
+// on scheduling.  Only this pre-pass runs in parallel.  It creates a slot for each name the
+// atoms define or reference that is not yet in the table, numbered in the order the names are
+// first used in the atom list, and points the by-name fixups at those slots.  It does not
+// decide which atom a slot holds, and its result depends on the atom order, not on scheduling.
+//
+void SymbolTable::bindNamesConcurrently(const std::vector<const ld::Atom*>& atoms, bool (^canBindByName)(const ld::Fixup& fixup))
+{
+	const size_t kShardCount	= 64;
+	const size_t kAtomsPerChunk = 4096;
+	struct NameUse { std::string_view name; uint64_t order; };
+
+	const size_t atomCount = atoms.size();
+	const size_t chunkCount = (atomCount + kAtomsPerChunk - 1) / kAtomsPerChunk;
+	if ( chunkCount < 2 )
+		return;
+	const ld::Atom* const* atomList = atoms.data();
+	std::vector<std::vector<NameUse>> uses(chunkCount * kShardCount);
+	std::vector<NameUse>* chunkUses = uses.data();
+
+	// find every name used, in each chunk of atoms in parallel
+	dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+		uint64_t order = (uint64_t)chunk << 32;
+		auto addUse = [&](std::string_view name) {
+			size_t shard = std::hash<std::string_view>{}(name) % kShardCount;
+			chunkUses[chunk*kShardCount + shard].push_back({ name, order++ });
+		};
+		const size_t end = std::min(atomCount, (chunk+1)*kAtomsPerChunk);
+		for (size_t i=chunk*kAtomsPerChunk; i < end; ++i) {
+			const ld::Atom* atom = atomList[i];
+			if ( atom->scope() != ld::Atom::scopeTranslationUnit ) {
+				switch ( atom->combine() ) {
+					case ld::Atom::combineNever:
+					case ld::Atom::combineByName:
+						addUse(atom->name());
+						break;
+					default:
+						break;
+				}
+			}
+			for (ld::Fixup::iterator fit=atom->fixupsBegin(), fend=atom->fixupsEnd(); fit != fend; ++fit) {
+				if ( (fit->binding == ld::Fixup::bindingByNameUnbound) && canBindByName(*fit) )
+					addUse(fit->u.name);
+			}
+		}
+	});
+
+	// unique names not yet in the table, each shard in parallel.  Nothing writes _byNameTable here.
+	std::vector<std::vector<NameUse>> newNames(kShardCount);
+	std::vector<NameUse>* shardNewNames = newNames.data();
+	dispatch_apply(kShardCount, DISPATCH_APPLY_AUTO, ^(size_t shard) {
+		StringViewSet seen;
+		for (size_t chunk=0; chunk < chunkCount; ++chunk) {
+			for (const NameUse& use : chunkUses[chunk*kShardCount + shard]) {
+				if ( _byNameTable.count(use.name) != 0 )
+					continue;
+				if ( seen.insert(use.name).second )
+					shardNewNames[shard].push_back(use);
+			}
+		}
+	});
+
+	// create slots in first use order
+	std::vector<NameUse> ordered;
+	for (const std::vector<NameUse>& shard : newNames)
+		ordered.insert(ordered.end(), shard.begin(), shard.end());
+	std::sort(ordered.begin(), ordered.end(), [](const NameUse& lhs, const NameUse& rhs) {
+		return lhs.order < rhs.order;
+	});
+	_byNameTable.reserve(_byNameTable.size() + ordered.size());
+	for (const NameUse& use : ordered)
+		this->findSlotForName(use.name);
+
+	// bind by-name fixups, each chunk of atoms in parallel.  Lookups are read only.
+	dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+		const size_t end = std::min(atomCount, (chunk+1)*kAtomsPerChunk);
+		for (size_t i=chunk*kAtomsPerChunk; i < end; ++i) {
+			const ld::Atom* atom = atomList[i];
+			for (ld::Fixup::iterator fit=atom->fixupsBegin(), fend=atom->fixupsEnd(); fit != fend; ++fit) {
+				if ( (fit->binding == ld::Fixup::bindingByNameUnbound) && canBindByName(*fit) ) {
+					NameToSlot::const_iterator pos = _byNameTable.find(fit->u.name);
+					assert(pos != _byNameTable.end());
+					fit->binding = ld::Fixup::bindingsIndirectlyBound;
+					fit->u.bindingIndex = pos->second;
+				}
+			}
+		}
+	});
+}
+
 const ld::Atom* SymbolTable::atomForName(const std::string_view& name) const {
 	auto nameToSlotIt = _byNameTable.find(name);
 	if ( nameToSlotIt == _byNameTable.end() ) {
@@ -119,6 +119,8 @@ public:
 
 	bool				add(const ld::Atom& atom, Options::Treatment duplicates);
 	IndirectBindingSlot	findSlotForName(const std::string_view& name);
+	bool				findExistingSlotForName(const std::string_view& name, IndirectBindingSlot& slot) const;
+	void				bindNamesConcurrently(const std::vector<const ld::Atom*>& atoms, bool (^canBindByName)(const ld::Fixup& fixup));
 	IndirectBindingSlot	findSlotForContent(const ld::Atom* atom, const ld::Atom** existingAtom);
 	IndirectBindingSlot	findSlotForReferences(const ld::Atom* atom, const ld::Atom** existingAtom);
 	const ld::Atom*		atomForSlot(IndirectBindingSlot s)	{ return _indirectBindingTable[s]; }
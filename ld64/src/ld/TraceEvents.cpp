@@ -0,0 +1,160 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mach/mach_time.h>
+
+#include <string>
+#include <vector>
+
+#include "Options.h"
+#include "TraceEvents.h"
+
+namespace ld {
+namespace tool {
+
+struct TraceEvent
+{
+	std::string		name;
+	const char*		category;
+	uint64_t		startTime;
+	uint64_t		endTime;
+	uint64_t		threadID;
+	std::string		detail;
+};
+
+bool							TraceEvents::_s_enabled = false;
+static const char*				_s_tracePath = nullptr;
+static uint64_t					_s_traceStartTime = 0;
+static pthread_mutex_t			_s_traceLock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<TraceEvent>*	_s_traceEvents = nullptr;
+
+
+void TraceEvents::enable(const char* path, uint64_t startTime)
+{
+	_s_tracePath = path;
+	_s_traceStartTime = startTime;
+	_s_traceEvents = new std::vector<TraceEvent>();
+	_s_traceEvents->reserve(4096);
+	_s_enabled = true;
+}
+
+void TraceEvents::addSpan(const char* name, const char* category, uint64_t startTime, uint64_t endTime, const char* detail)
+{
+	if ( !_s_enabled )
+		return;
+	uint64_t threadID = 0;
+	pthread_threadid_np(NULL, &threadID);
+	TraceEvent event = { name, category, startTime, endTime, threadID, (detail != nullptr) ? detail : "" };
+	pthread_mutex_lock(&_s_traceLock);
+	_s_traceEvents->push_back(std::move(event));
+	pthread_mutex_unlock(&_s_traceLock);
+}
+
+static void writeJSONString(FILE* out, const std::string& str)
+{
+	fputc('"', out);
+	for (char c : str) {
+		switch ( c ) {
+			case '"':
+				fputs("\\\"", out);
+				break;
+			case '\\':
+				fputs("\\\\", out);
+				break;
+			default:
+				if ( (uint8_t)c < 0x20 )
+					fprintf(out, "\\u%04x", c);
+				else
+					fputc(c, out);
+				break;
+		}
+	}
+	fputc('"', out);
+}
+
+void TraceEvents::write()
+{
+	if ( !_s_enabled )
+		return;
+	FILE* out = fopen(_s_tracePath, "w");
+	if ( out == NULL ) {
+		warning("could not write trace file %s, errno=%d", _s_tracePath, errno);
+		return;
+	}
+
+	mach_timebase_info_data_t timebaseInfo;
+	mach_timebase_info(&timebaseInfo);
+	auto toMicroseconds = [&](uint64_t time) {
+		return (double)(time - _s_traceStartTime) * timebaseInfo.numer / timebaseInfo.denom / 1000.0;
+	};
+
+	pthread_mutex_lock(&_s_traceLock);
+	const int pid = getpid();
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	for (const TraceEvent& event : *_s_traceEvents) {
+		if ( !first )
+			fprintf(out, ",\n");
+		first = false;
+		fprintf(out, "{\"name\":");
+		writeJSONString(out, event.name);
+		fprintf(out, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%llu",
+				event.category, toMicroseconds(event.startTime), toMicroseconds(event.endTime) - toMicroseconds(event.startTime),
+				pid, event.threadID);
+		if ( !event.detail.empty() ) {
+			fprintf(out, ",\"args\":{\"detail\":");
+			writeJSONString(out, event.detail);
+			fprintf(out, "}");
+		}
+		fprintf(out, "}");
+	}
+	fprintf(out, "\n]}\n");
+	pthread_mutex_unlock(&_s_traceLock);
+	if ( fclose(out) != 0 )
+		warning("could not write trace file %s, errno=%d", _s_tracePath, errno);
+}
+
+
+TraceSpan::TraceSpan(const char* name, const char* category, const char* detail)
+	: _name(name), _category(category), _detail(detail), _startTime(0)
+{
+	if ( TraceEvents::enabled() )
+		_startTime = mach_absolute_time();
+}
+
+TraceSpan::~TraceSpan()
+{
+	if ( TraceEvents::enabled() )
+		TraceEvents::addSpan(_name, _category, _startTime, mach_absolute_time(), _detail);
+}
+
+} // namespace tool
+} // namespace ld
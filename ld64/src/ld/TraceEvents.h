@@ -0,0 +1,72 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#ifndef __TRACE_EVENTS_H__
+#define __TRACE_EVENTS_H__
+
+#include <stdint.h>
+
+namespace ld {
+namespace tool {
+
+//
+// TraceEvents implements -trace_file.  Spans are recorded from any thread
+// while the linker runs and written out at the end in the Chrome trace event
+// JSON format, which chrome://tracing and Perfetto can display.
+//
+class TraceEvents
+{
+public:
+	// starts recording, times are relative to startTime (a mach_absolute_time())
+	static void					enable(const char* path, uint64_t startTime);
+	static bool					enabled()		{ return _s_enabled; }
+	// records a span that ran on the current thread
+	static void					addSpan(const char* name, const char* category, uint64_t startTime, uint64_t endTime, const char* detail=nullptr);
+	// writes all spans recorded so far to the -trace_file path
+	static void					write();
+
+private:
+	static bool					_s_enabled;
+};
+
+//
+// Records a span for the lifetime of the object, if -trace_file was used
+//
+class TraceSpan
+{
+public:
+								TraceSpan(const char* name, const char* category, const char* detail=nullptr);
+								~TraceSpan();
+private:
+	const char*					_name;
+	const char*					_category;
+	const char*					_detail;
+	uint64_t					_startTime;
+};
+
+} // namespace tool
+} // namespace ld
+
+#endif // __TRACE_EVENTS_H__
@@ -69,6 +69,8 @@ extern "C" double log2 ( double );
 #include "Resolver.h"
 #include "OutputFile.h"
 #include "Snapshot.h"
+#include "LinkCache.h"
+#include "TraceEvents.h"
 
 #include "passes/stubs/make_stubs.h"
 #include "passes/dtrace_dof.h"
@@ -99,12 +101,14 @@ const ld::VersionSet ld::File::_platforms;
 
 struct PerformanceStatistics {
 	uint64_t						startTool;
+	uint64_t						startCacheLookup;
 	uint64_t						startInputFileProcessing;
 	uint64_t						startResolver;
 	uint64_t						startDylibs;
 	uint64_t						startPasses;
 	uint64_t						startOutput;
 	uint64_t						startDone;
+	bool							cacheHit;
 	vm_statistics_data_t			vmStart;
 	vm_statistics_data_t			vmEnd;
 };
@@ -1451,6 +1455,37 @@ uint64_t InternalState::assignFileOffsets()
 	return fileOffset;
 }
 
+static void runPass(const char* name, void (^pass)())
+{
+	ld::tool::TraceSpan span(name, "pass");
+	pass();
+}
+
+static void tracePhases(const PerformanceStatistics& statistics)
+{
+	using ld::tool::TraceEvents;
+	if ( statistics.cacheHit ) {
+		// the output came from -incremental_cache_path, so no input was parsed
+		TraceEvents::addSpan("option parsing",		"phase", statistics.startTool,					statistics.startCacheLookup);
+		TraceEvents::addSpan("reuse cached output",	"phase", statistics.startCacheLookup,			statistics.startDone);
+		return;
+	}
+	TraceEvents::addSpan("option parsing",			"phase", statistics.startTool,					statistics.startInputFileProcessing);
+	TraceEvents::addSpan("object file processing",	"phase", statistics.startInputFileProcessing,	statistics.startResolver);
+	TraceEvents::addSpan("resolve symbols",			"phase", statistics.startResolver,				statistics.startDylibs);
+	TraceEvents::addSpan("build atom list",			"phase", statistics.startDylibs,				statistics.startPasses);
+	TraceEvents::addSpan("passes",					"phase", statistics.startPasses,				statistics.startOutput);
+	TraceEvents::addSpan("write output",			"phase", statistics.startOutput,				statistics.startDone);
+}
+
+static void writeTrace(const PerformanceStatistics& statistics)
+{
+	if ( ld::tool::TraceEvents::enabled() ) {
+		tracePhases(statistics);
+		ld::tool::TraceEvents::write();
+	}
+}
+
 static char* commatize(uint64_t in, char* out)
 {
 	char* result = out;
@@ -1525,15 +1560,42 @@ int main(int argc, const char* argv[])
 		// allow libLTO to be overridden by command line -lto_library
 		if (const char *dylib = options.overridePathlibLTO())
 			lto::set_library(dylib);
+		if ( options.ltoCachePath() != NULL )
+			lto::set_symbol_cache_path(options.ltoCachePath());
 		
 		// gather vm stats
-		if ( options.printStatistics() )
+		if ( options.printStatistics() ) {
 			getVMInfo(statistics.vmStart);
+			ld::Arena::collectStatistics();
+		}
+
+		if ( options.traceFilePath() != NULL )
+			ld::tool::TraceEvents::enable(options.traceFilePath(), statistics.startTool);
 
 		// update strings for error messages
 		showArch = options.printArchPrefix();
 		archName = options.architectureName();
 		
+		// reuse output of an identical earlier link
+		ld::tool::LinkCache* linkCache = NULL;
+		if ( options.incrementalCachePath() != NULL ) {
+			statistics.startCacheLookup = mach_absolute_time();
+			linkCache = new ld::tool::LinkCache(options, argc, argv);
+			if ( linkCache->reuseCachedOutput() ) {
+				statistics.startDone = mach_absolute_time();
+				statistics.cacheHit = true;
+				writeTrace(statistics);
+				if ( options.printStatistics() ) {
+					char temp[40];
+					uint64_t totalTime = statistics.startDone - statistics.startTool;
+					printTime("ld total time", totalTime, totalTime);
+					fprintf(stderr, "incremental link cache hit, hashed %s bytes of input\n", commatize(linkCache->hashedBytes(), temp));
+				}
+				fflush(stdout);
+				exit(0);
+			}
+		}
+
 		// open and parse input files
 		statistics.startInputFileProcessing = mach_absolute_time();
 		ld::tool::InputFiles& inputFiles = *(new ld::tool::InputFiles(options));
@@ -1552,27 +1614,27 @@ int main(int argc, const char* argv[])
 
 		// run passes
 		statistics.startPasses = mach_absolute_time();
-		ld::passes::objc_stubs::doPass(options, state);
-		ld::passes::objc::doPass(options, state);
-		ld::passes::stubs::doPass(options, state);
-		ld::passes::inits::doPass(options, state);
-		ld::passes::huge::doPass(options, state);
-		ld::passes::got::doPass(options, state);
+		runPass("objc_stubs", ^{ ld::passes::objc_stubs::doPass(options, state); });
+		runPass("objc", ^{ ld::passes::objc::doPass(options, state); });
+		runPass("stubs", ^{ ld::passes::stubs::doPass(options, state); });
+		runPass("inits", ^{ ld::passes::inits::doPass(options, state); });
+		runPass("huge", ^{ ld::passes::huge::doPass(options, state); });
+		runPass("got", ^{ ld::passes::got::doPass(options, state); });
 		//ld::passes::objc_constants::doPass(options, state);
-		ld::passes::tlvp::doPass(options, state);
-		ld::passes::dylibs::doPass(options, state);	// must be after stubs and GOT passes
-		ld::passes::dedup::doPass(options, state);
-		ld::passes::order::doPass(options, state); // must run after code dedup, so that deduplicated aliases are sorted
+		runPass("tlvp", ^{ ld::passes::tlvp::doPass(options, state); });
+		runPass("dylibs", ^{ ld::passes::dylibs::doPass(options, state); });	// must be after stubs and GOT passes
+		runPass("dedup", ^{ ld::passes::dedup::doPass(options, state); });
+		runPass("order", ^{ ld::passes::order::doPass(options, state); }); // must run after code dedup, so that deduplicated aliases are sorted
 		state.markAtomsOrdered();
-		ld::passes::branch_shim::doPass(options, state);	// must be after stubs
-		ld::passes::branch_island::doPass(options, state);	// must be after stubs and order pass
-		ld::passes::dtrace::doPass(options, state);
-		ld::passes::compact_unwind::doPass(options, state);  // must be after order pass
-		ld::passes::bitcode_bundle::doPass(options, state);  // must be after dylib
+		runPass("branch_shim", ^{ ld::passes::branch_shim::doPass(options, state); });	// must be after stubs
+		runPass("branch_island", ^{ ld::passes::branch_island::doPass(options, state); });	// must be after stubs and order pass
+		runPass("dtrace", ^{ ld::passes::dtrace::doPass(options, state); });
+		runPass("compact_unwind", ^{ ld::passes::compact_unwind::doPass(options, state); });  // must be after order pass
+		runPass("bitcode_bundle", ^{ ld::passes::bitcode_bundle::doPass(options, state); });  // must be after dylib
 
 		// Sort again so that we get the segments in order.
 		state.sortSections();
-		ld::passes::thread_starts::doPass(options, state);  // must be after dylib
+		runPass("thread_starts", ^{ ld::passes::thread_starts::doPass(options, state); });  // must be after dylib
 		
 		// sort final sections
 		state.sortSections();
@@ -1583,8 +1645,12 @@ int main(int argc, const char* argv[])
 		statistics.startOutput = mach_absolute_time();
 		ld::tool::OutputFile& out = *(new ld::tool::OutputFile(options, state));
 		out.write(state);
+		if ( linkCache != NULL )
+			linkCache->recordLink(state, inputFiles);
 		statistics.startDone = mach_absolute_time();
 
+		writeTrace(statistics);
+
 		// print statistics
 		//mach_o::relocatable::printCounts();
 		if ( options.printStatistics() ) {
@@ -1606,7 +1672,16 @@ int main(int argc, const char* argv[])
 			fprintf(stderr, "processed %3u object files,  totaling %15s bytes\n", inputFiles._totalObjectLoaded, commatize(inputFiles._totalObjectSize, temp));
 			fprintf(stderr, "processed %3u archive files, totaling %15s bytes\n", inputFiles._totalArchivesLoaded, commatize(inputFiles._totalArchiveSize, temp));
 			fprintf(stderr, "processed %3u dylib files\n", inputFiles._totalDylibsLoaded);
-			fprintf(stderr, "wrote output file            totaling %15s bytes\n", commatize(out.fileSize(), temp));
+			char temp2[40];
+			const ld::Arena::Statistics& arenaStats = ld::Arena::statistics();
+			fprintf(stderr, "arena allocated %15s bytes in %lld allocations, %s bytes reserved in %d chunks\n",
+					commatize(arenaStats.bytesAllocated.load(), temp), (int64_t)arenaStats.allocations.load(), commatize(arenaStats.bytesReserved.load(), temp2), (int32_t)arenaStats.chunks.load());
+			if ( out.outputUnchanged() )
+				fprintf(stderr, "output file unchanged, kept  totaling %15s bytes\n", commatize(out.fileSize(), temp));
+			else
+				fprintf(stderr, "wrote output file            totaling %15s bytes\n", commatize(out.fileSize(), temp));
+			if ( linkCache != NULL )
+				fprintf(stderr, "incremental link cache miss (%s)\n", linkCache->missReason());
 		}
 		// <rdar://problem/6780050> Would like linker warning to be build error.
 		if ( options.errorBecauseOfWarnings() ) {
@@ -1625,6 +1700,8 @@ int main(int argc, const char* argv[])
 			fprintf(stderr, "ld: %s for architecture %s\n", msg, archName);
 		else
 			fprintf(stderr, "ld: %s\n", msg);
+		// keep the spans recorded up to the failure, the phases are incomplete so are left out
+		ld::tool::TraceEvents::write();
 		// <rdar://50510752> exit but don't run termination routines
 		exit(1);
 	}
@@ -36,10 +36,12 @@
 #include <vector>
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
 
 #include "configure.h"
 #include "PlatformSupport.h"
 #include "Containers.h"
+#include "Arena.h"
 
 //FIXME: Only needed until we move VersionSet into PlatformSupport
 class Options;
@@ -434,6 +436,8 @@ public:
 			const char*					path() const			{ return _path; }
 			time_t						modificationTime() const{ return _modTime; }
 	Ordinal								ordinal() const			{ return _ordinal; }
+	// only used when a file parsed ahead of time is claimed in command line order
+	void								setOrdinal(Ordinal ord)	{ _ordinal = ord; }
 	virtual bool						forEachAtom(AtomHandler&) const = 0;
 	virtual bool						justInTimeforEachAtom(const char* name, AtomHandler&) const = 0;
 	virtual uint8_t						swiftVersion() const	{ return 0; }		// ABI version, now fixed
@@ -450,7 +454,7 @@ public:
 private:
 	const char*							_path;
 	time_t								_modTime;
-	const Ordinal						_ordinal;
+	Ordinal								_ordinal;
 	const Type							_type;
 	// Note this is just a placeholder as platforms() needs something to return
 	static const VersionSet				_platforms;
@@ -588,6 +592,8 @@ namespace dylib {
 		virtual void						forEachExportedSymbol(void (^handler)(const char* symbolName, bool weakDef)) const = 0;
 		virtual bool						hasReExportedDependentsThatProvidedExportAtom() const { return false; }
 		virtual bool						isUnzipperedTwin() const { return false; }
+		// install paths processIndirectLibraries() may ask the DylibHandler for, so they can be loaded ahead of time
+		virtual void						forEachDependentDylib(void (^handler)(const char* installPath)) const { }
 
 	public:
 		const char*							_dylibInstallPath;
@@ -1214,6 +1220,11 @@ public:
 													 }
 	virtual									~Atom() {}
 
+	// atoms are never freed, so ones created with new come from the global arena
+	static void*							operator new(size_t size)				{ return Arena::allocateGlobal(size); }
+	static void*							operator new(size_t, void* place)		{ return place; }
+	static void								operator delete(void*)					{ }
+
 	const Section&							section() const				{ return *_section; }
 	bool									hasOutputSymbolIndex() const { return _outputSymbolIndex != UINT32_MAX; }
 	uint32_t								outputSymbolIndex() const   { return _outputSymbolIndex; }
@@ -1429,6 +1440,8 @@ public:
 	std::vector<const ld::relocatable::File*>	filesFromCompilerRT;
 	std::vector<const ld::relocatable::File*>	filesForLTO;
 	std::vector<const ld::Atom*>				deadAtoms;
+	// for -binary_map, the atom that first referenced each live atom when dead stripping
+	std::unordered_map<const ld::Atom*, const ld::Atom*>	liveReferrers;
 	std::unordered_set<const char*>				allUndefProxies;
 	std::unordered_set<uint64_t>				toolsVersions;
 	const ld::dylib::File*						bundleLoader;
@@ -1505,6 +1518,36 @@ struct utils {
 
 		return total;
 	};
+
+	// like write64() but at an explicit file offset, so several ranges of
+	// the output can be written without sharing a file position
+	static ssize_t pwrite64(int fildes, const void* buf, size_t nbyte, uint64_t offset) {
+		const uint8_t* uchars = (uint8_t*)buf;
+		ssize_t        total  = 0;
+
+		while (nbyte)
+		{
+			size_t limit   = 0x7FFFFFFF;
+			size_t towrite = nbyte < limit ? nbyte : limit;
+			ssize_t wrote  = pwrite(fildes, uchars, towrite, offset);
+			if ( wrote == -1) {
+				// failure
+				return -1;
+			}
+			else if ( wrote == 0 ) {
+				// done
+				break;
+			}
+			else {
+				nbyte  -= wrote;
+				uchars += wrote;
+				offset += wrote;
+				total  += wrote;
+			}
+		}
+
+		return total;
+	};
 };
 
 } // namespace ld 
@@ -161,6 +161,9 @@ struct _libcd {
     unsigned int hash_types_count;
     _cdhash_for_hash_type_t* cdhashes;
 
+    // page hashes supplied with libcd_hash_page_mem, one array per hash type
+    uint8_t **page_hashes;
+
     uint8_t platform_identifier;
 
     char const *team_id;
@@ -324,6 +327,18 @@ _libcd_read_page_mem (libcd *s, int page_no, size_t pos, size_t page_size, uint8
     return bytes_read;
 }
 
+static void
+_libcd_free_page_hashes (libcd *s)
+{
+    if (s->page_hashes != NULL) {
+        for (unsigned int i = 0; i < s->hash_types_count; i++) {
+            free(s->page_hashes[i]);
+        }
+        free(s->page_hashes);
+        s->page_hashes = NULL;
+    }
+}
+
 libcd *
 libcd_create (size_t image_size)
 {
@@ -416,6 +431,7 @@ libcd_free (libcd *s)
             SLIST_REMOVE_HEAD(&s->sslot_data, entries);
             free(blob);
         }
+        _libcd_free_page_hashes(s);
         free(s->hash_types);
         free(s->cdhashes);
 
@@ -490,6 +506,7 @@ _libcd_get_hash_info (int hash_type)
 enum libcd_set_hash_type_ret
 libcd_set_hash_types (libcd *s, int const hash_types[], unsigned int count)
 {
+    _libcd_free_page_hashes(s);
     free(s->hash_types);
     s->hash_types = NULL;
 
@@ -647,6 +664,69 @@ libcd_set_disable_parallelization (libcd* s, bool disable)
     s->parallelization_disabled = disable;
 }
 
+size_t
+libcd_page_size (void)
+{
+    return _cs_page_bytes;
+}
+
+bool
+libcd_prepare_page_hashes (libcd *s)
+{
+    _libcd_free_page_hashes(s);
+
+    size_t const page_count = (s->image_size + _cs_page_bytes-1) >> _cs_page_shift;
+    s->page_hashes = calloc(s->hash_types_count, sizeof(uint8_t*));
+    if (s->page_hashes == NULL) {
+        return false;
+    }
+    for (unsigned int i = 0; i < s->hash_types_count; i++) {
+        struct _hash_info const *hi = _libcd_get_hash_info(s->hash_types[i]);
+        s->page_hashes[i] = calloc(page_count, hi->hash_len);
+        if (s->page_hashes[i] == NULL) {
+            _libcd_free_page_hashes(s);
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+libcd_hash_page_mem (libcd *s, size_t page_no, uint8_t const *page)
+{
+    assert(s->page_hashes != NULL);
+    const size_t pos = page_no * _cs_page_bytes;
+    assert(pos < s->image_size);
+    const size_t len = pos + _cs_page_bytes > s->image_size ? s->image_size-pos : _cs_page_bytes;
+
+    for (unsigned int i = 0; i < s->hash_types_count; i++) {
+        struct _hash_info const *hi = _libcd_get_hash_info(s->hash_types[i]);
+        struct ccdigest_info const *di = hi->di();
+        ccdigest_di_decl(di, ctx);
+        uint8_t page_hash[_max_known_hash_len] = {0};
+
+        ccdigest_init(di, ctx);
+        ccdigest_update(di, ctx, len, page);
+        ccdigest_final(di, ctx, page_hash);
+
+        memcpy(s->page_hashes[i] + page_no*hi->hash_len, page_hash, hi->hash_len);
+    }
+}
+
+static uint8_t const *
+_libcd_page_hashes_for_type (libcd *s, uint32_t hash_type)
+{
+    if (s->page_hashes == NULL) {
+        return NULL;
+    }
+    for (unsigned int i = 0; i < s->hash_types_count; i++) {
+        if (s->hash_types[i] == (int)hash_type) {
+            return s->page_hashes[i];
+        }
+    }
+    return NULL;
+}
+
 #if __has_extension(blocks)
 
 static size_t
@@ -915,25 +995,31 @@ _libcd_serialize_cd (libcd *s, uint32_t hash_type)
 
         volatile enum libcd_serialize_ret _libcd_block ret = LIBCD_SERIALIZE_SUCCESS;
 
-#if LIBCD_PARALLEL
-        if(s->parallel_read && s->parallel_write && !s->parallelization_disabled) {
-            dispatch_apply(page_count, DISPATCH_APPLY_AUTO, ^(size_t page_no) {
-                uint8_t* destination = cursor + page_no * hi->hash_len;
-                enum libcd_serialize_ret local_ret = _libcd_hash_page(s, page_no, page_count, hi, destination);
-                ret = (ret == LIBCD_SERIALIZE_SUCCESS) ? local_ret : ret;
-            });
+        uint8_t const *precomputed = _libcd_page_hashes_for_type(s, hash_type);
+        if (precomputed != NULL) {
+            // pages were already hashed by libcd_hash_page_mem
+            memcpy(cursor, precomputed, page_count * hi->hash_len);
         } else {
+#if LIBCD_PARALLEL
+            if(s->parallel_read && s->parallel_write && !s->parallelization_disabled) {
+                dispatch_apply(page_count, DISPATCH_APPLY_AUTO, ^(size_t page_no) {
+                    uint8_t* destination = cursor + page_no * hi->hash_len;
+                    enum libcd_serialize_ret local_ret = _libcd_hash_page(s, page_no, page_count, hi, destination);
+                    ret = (ret == LIBCD_SERIALIZE_SUCCESS) ? local_ret : ret;
+                });
+            } else {
 #endif
-            for (size_t page_no = 0; page_no < page_count; page_no++) {
-                uint8_t* destination = cursor + page_no * hi->hash_len;
-                ret = _libcd_hash_page(s, page_no, page_count, hi, destination);
-                if (ret != LIBCD_SERIALIZE_SUCCESS) {
-                    break;
+                for (size_t page_no = 0; page_no < page_count; page_no++) {
+                    uint8_t* destination = cursor + page_no * hi->hash_len;
+                    ret = _libcd_hash_page(s, page_no, page_count, hi, destination);
+                    if (ret != LIBCD_SERIALIZE_SUCCESS) {
+                        break;
+                    }
                 }
-            }
 #if LIBCD_PARALLEL
-        }
+            }
 #endif
+        }
 
         if (ret != LIBCD_SERIALIZE_SUCCESS) {
             _libcd_err("serialize page hashes failed");
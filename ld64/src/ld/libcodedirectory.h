@@ -66,6 +66,12 @@ void* libcd_get_output_func_ctx (libcd *s);
 
 void libcd_set_disable_parallelization (libcd* s, bool disable);
 
+// Callers that already have the image in memory can hash its pages themselves,
+// in any order and from any thread, instead of having libcd_serialize read them.
+size_t libcd_page_size (void);
+bool libcd_prepare_page_hashes (libcd *s);
+void libcd_hash_page_mem (libcd *s, size_t page_no, uint8_t const *page);
+
 #if __has_extension(blocks)
 typedef size_t (^libcd_read_page_block)(libcd *s, int page_no, size_t pos, size_t page_size,
                                         uint8_t * const page_buf);
@@ -28,6 +28,7 @@
 #include <sys/param.h>
 #include <mach-o/ranlib.h>
 #include <ar.h>
+#include <dispatch/dispatch.h>
 
 #include <algorithm>
 
@@ -37,7 +38,9 @@
 #include "macho_relocatable_file.h"
 #include "lto_file.h"
 #include "archive_file.h"
+#include "archive_index.h"
 #include "Containers.h"
+#include "TraceEvents.h"
 
 namespace archive {
 
@@ -73,7 +76,7 @@ public:
 													File(const uint8_t* fileContent, uint64_t fileLength,
 															const char* pth, time_t modTime, 
 															ld::File::Ordinal ord, const ParserOptions& opts);
-	virtual											~File() {}
+	virtual											~File() { delete _tocIndex; }
 
 	// overrides of ld::File
 	virtual bool										forEachAtom(ld::File::AtomHandler&) const;
@@ -117,8 +120,14 @@ private:
 	typedef std::map<const class Entry*, MemberState> MemberToStateMap;
 
 	MemberState&									makeObjectFileForMember(const Entry* member) const;
+	ld::relocatable::File*							parseMember(const Entry* member, uint32_t memberIndex) const;
+	void											parseAllMembers();
 	bool											memberHasObjCCategories(const Entry* member) const;
 	void											dumpTableOfContents();
+	const char*										tocEntryName(uint32_t index) const;
+	uint64_t										tocEntryOffset(uint32_t index) const;
+	const Entry*									memberForSymbol(const char* name) const;
+	void											openTOCIndex(const char* cacheDir, const void* toc, uint64_t tocSize);
 	void											buildHashTable();
 #ifdef SYMDEF_64
 	void											buildHashTable64();
@@ -133,6 +142,7 @@ private:
 	const char*										_tableOfContentStrings;
 	mutable MemberToStateMap						_instantiatedEntries;
 	NameToOffsetMap									_hashTable;
+	TOCIndex*										_tocIndex;
 	const LibraryOptions::ArchiveLoadMode			_loadMode;
 	const bool										_objc2ABI;
 	const bool										_verboseLoad;
@@ -287,7 +297,7 @@ File<A>::File(const uint8_t fileContent[], uint64_t fileLength, const char* pth,
 #ifdef SYMDEF_64
 	_tableOfContents64(NULL),
 #endif
-	_tableOfContentCount(0), _tableOfContentStrings(NULL),
+	_tableOfContentCount(0), _tableOfContentStrings(NULL), _tocIndex(NULL),
 	_loadMode(opts.loadMode), _objc2ABI(opts.objcABI2), _verboseLoad(opts.verboseLoad), 
 	_logAllFiles(opts.logAllFiles), _alreadyLoadedAll(false), _objOpts(opts.objOpts)
 {
@@ -306,7 +316,9 @@ File<A>::File(const uint8_t fileContent[], uint64_t fileLength, const char* pth,
 			if ( ((uint8_t*)(&_tableOfContents[_tableOfContentCount]) > &fileContent[fileLength])
 				|| ((uint8_t*)_tableOfContentStrings > &fileContent[fileLength]) )
 				throw "malformed archive, perhaps wrong architecture";
-			this->buildHashTable();
+			this->openTOCIndex(opts.indexCachePath, _tableOfContents, ranlibArrayLen);
+			if ( _tocIndex == NULL )
+				this->buildHashTable();
 		}
 #ifdef SYMDEF_64
 		else if ( (strcmp(memberName, SYMDEF_64_SORTED) == 0) || (strcmp(memberName, SYMDEF_64) == 0) ) {
@@ -318,7 +330,9 @@ File<A>::File(const uint8_t fileContent[], uint64_t fileLength, const char* pth,
 			if ( ((uint8_t*)(&_tableOfContents[_tableOfContentCount]) > &fileContent[fileLength])
 				|| ((uint8_t*)_tableOfContentStrings > &fileContent[fileLength]) )
 				throw "malformed archive, perhaps wrong architecture";
-			this->buildHashTable64();
+			this->openTOCIndex(opts.indexCachePath, _tableOfContents64, ranlibArrayLen);
+			if ( _tocIndex == NULL )
+				this->buildHashTable64();
 		}
 #endif
 		else
@@ -327,23 +341,57 @@ File<A>::File(const uint8_t fileContent[], uint64_t fileLength, const char* pth,
 	if ( _loadMode != LibraryOptions::ArchiveLoadMode::lazy ) {
 		// parse all .o files in archive
 		// do this now while ld is multithreaded
-		const Entry* const start = (Entry*)&_archiveFileContent[8];
-		const Entry* const end = (Entry*)&_archiveFileContent[_archiveFilelength];
-		for (const Entry* p=start; p < end; p = p->next()) {
-			char memberName[256];
-			p->getName(memberName, sizeof(memberName));
-			if ( (p==start) && ((strcmp(memberName, SYMDEF_SORTED) == 0) || (strcmp(memberName, SYMDEF) == 0)) )
-				continue;
+		this->parseAllMembers();
+	}
+
+}
+
+template <typename A>
+void File<A>::parseAllMembers()
+{
+	// member indexes start at 1 and count the table of contents, see makeObjectFileForMember()
+	struct PendingMember { const Entry* entry; uint32_t index; bool parse; ld::relocatable::File* file; const char* error; };
+	__block std::vector<PendingMember> members;
+	const Entry* const start = (Entry*)&_archiveFileContent[8];
+	const Entry* const end = (Entry*)&_archiveFileContent[_archiveFilelength];
+	uint32_t index = 1;
+	for (const Entry* p=start; p < end; p = p->next(), ++index) {
+		char memberName[256];
+		p->getName(memberName, sizeof(memberName));
+		bool parse = true;
+		if ( (p==start) && ((strcmp(memberName, SYMDEF_SORTED) == 0) || (strcmp(memberName, SYMDEF) == 0)) )
+			parse = false;
 #ifdef SYMDEF_64
-			if ( (p==start) && ((strcmp(memberName, SYMDEF_64_SORTED) == 0) || (strcmp(memberName, SYMDEF_64) == 0)) )
-				continue;
+		if ( (p==start) && ((strcmp(memberName, SYMDEF_64_SORTED) == 0) || (strcmp(memberName, SYMDEF_64) == 0)) )
+			parse = false;
 #endif
-			// don't instantiate bitcode files with -ObjC because instantiation has side effect of merging into LTO
-			if ( _loadMode == LibraryOptions::ArchiveLoadMode::forceLoad || !validLTOFile(p->content(), p->contentSize(), _objOpts) )
-				this->makeObjectFileForMember(p);
-		}
+		// don't instantiate bitcode files with -ObjC because instantiation has side effect of merging into LTO
+		if ( parse && (_loadMode != LibraryOptions::ArchiveLoadMode::forceLoad) && validLTOFile(p->content(), p->contentSize(), _objOpts) )
+			parse = false;
+		members.push_back({ p, index, parse, nullptr, nullptr });
 	}
 
+	// members are independent, so parse them concurrently instead of one after another
+	dispatch_apply(members.size(), DISPATCH_APPLY_AUTO, ^(size_t i) {
+		PendingMember& member = members[i];
+		if ( !member.parse )
+			return;
+		try {
+			member.file = this->parseMember(member.entry, member.index);
+		}
+		catch (const char* msg) {
+			member.error = msg;
+		}
+	});
+
+	// record results in archive order, and report the first error in archive order so output is deterministic
+	for (const PendingMember& member : members) {
+		if ( member.error != nullptr )
+			throw member.error;
+		// skipped members (TOC, bitcode) get a placeholder so makeObjectFileForMember() knows their index
+		MemberState state = { member.parse ? member.file : NULL, member.entry, false, false, member.index };
+		_instantiatedEntries[member.entry] = state;
+	}
 }
 
 template <>
@@ -402,6 +450,15 @@ typename File<A>::MemberState& File<A>::makeObjectFileForMember(const Entry* mem
 		memberIndex = state.index;
 	}
 	assert(memberIndex != 0);
+	MemberState state = {this->parseMember(member, memberIndex), member, false, false, memberIndex};
+	_instantiatedEntries[member] = state;
+	return _instantiatedEntries[member];
+}
+
+
+template <typename A>
+ld::relocatable::File* File<A>::parseMember(const Entry* member, uint32_t memberIndex) const
+{
 	char memberName[256];
 	member->getName(memberName, sizeof(memberName));
 	char memberPath[strlen(this->path()) + strlen(memberName)+4];
@@ -409,6 +466,7 @@ typename File<A>::MemberState& File<A>::makeObjectFileForMember(const Entry* mem
 	strcat(memberPath, "(");
 	strcat(memberPath, memberName);
 	strcat(memberPath, ")");
+	ld::tool::TraceSpan span(memberName, "parse", memberPath);
 	//fprintf(stderr, "using %s from %s\n", memberName, this->path());
 	try {
 		// range check
@@ -422,20 +480,14 @@ typename File<A>::MemberState& File<A>::makeObjectFileForMember(const Entry* mem
 		ld::relocatable::File* result = mach_o::relocatable::parse(member->content(), member->contentSize(), 
 																	mPath, member->modificationTime(), 
 																	ordinal, _objOpts);
-		if ( result != NULL ) {
-			MemberState state = {result, member, false, false, memberIndex};
-			_instantiatedEntries[member] = state;
-			return _instantiatedEntries[member];
-		}
+		if ( result != NULL )
+			return result;
 		// see if member is llvm bitcode file
 		result = lto::parse(member->content(), member->contentSize(), 
 								mPath, member->modificationTime(), ordinal, 
 								_objOpts.architecture, _objOpts.subType, _logAllFiles, _objOpts.verboseOptimizationHints);
-		if ( result != NULL ) {
-			MemberState state = {result, member, false, false, memberIndex};
-			_instantiatedEntries[member] = state;
-			return _instantiatedEntries[member];
-		}
+		if ( result != NULL )
+			return result;
 			
 		throwf("archive member '%s' with length %d is not mach-o or llvm bitcode", memberName, member->contentSize());
 	}
@@ -584,12 +636,10 @@ bool File<A>::justInTimeforEachAtom(const char* name, ld::File::AtomHandler& han
 		return false;
 	
 	// do a hash search of table of contents looking for requested symbol
-	const auto& pos = _hashTable.find(name);
-	if ( pos == _hashTable.end() )
+	const Entry* member = this->memberForSymbol(name);
+	if ( member == NULL )
 		return false;
 
-	// do a hash search of table of contents looking for requested symbol
-	const Entry* member = (Entry*)&_archiveFileContent[pos->second];
 	MemberState& state = this->makeObjectFileForMember(member);
 	char memberName[256];
 	member->getName(memberName, sizeof(memberName));
@@ -625,11 +675,10 @@ bool File<A>::justInTimeDataOnlyforEachAtom(const char* name, ld::File::AtomHand
 		return false;
 	
 	// do a hash search of table of contents looking for requested symbol
-	const auto& pos = _hashTable.find(name);
-	if ( pos == _hashTable.end() )
+	const Entry* member = this->memberForSymbol(name);
+	if ( member == NULL )
 		return false;
 
-	const Entry* member = (Entry*)&_archiveFileContent[pos->second];
 	MemberState& state = this->makeObjectFileForMember(member);
 	// only call handler for each member once
 	if ( ! state.loaded ) {
@@ -646,6 +695,60 @@ bool File<A>::justInTimeDataOnlyforEachAtom(const char* name, ld::File::AtomHand
 	return false;
 }
 
+template <typename A>
+const char* File<A>::tocEntryName(uint32_t index) const
+{
+#ifdef SYMDEF_64
+	if ( _tableOfContents64 != NULL )
+		return &_tableOfContentStrings[E::get64(_tableOfContents64[index].ran_un.ran_strx)];
+#endif
+	return &_tableOfContentStrings[E::get32(_tableOfContents[index].ran_un.ran_strx)];
+}
+
+template <typename A>
+uint64_t File<A>::tocEntryOffset(uint32_t index) const
+{
+#ifdef SYMDEF_64
+	if ( _tableOfContents64 != NULL )
+		return E::get64(_tableOfContents64[index].ran_off);
+#endif
+	return E::get32(_tableOfContents[index].ran_off);
+}
+
+template <typename A>
+const typename File<A>::Entry* File<A>::memberForSymbol(const char* name) const
+{
+	if ( _tocIndex != NULL ) {
+		// the index only narrows the search to one TOC entry, check it is this name
+		uint32_t index = _tocIndex->find(name);
+		if ( (index == TOCIndex::kNotFound) || (strcmp(this->tocEntryName(index), name) != 0) )
+			return NULL;
+		uint64_t offset = this->tocEntryOffset(index);
+		if ( offset > _archiveFilelength ) {
+			throwf("malformed archive TOC entry for %s, offset %lld is beyond end of file %lld\n",
+				name, offset, _archiveFilelength);
+		}
+		return (Entry*)&_archiveFileContent[offset];
+	}
+
+	const auto& pos = _hashTable.find(name);
+	if ( pos == _hashTable.end() )
+		return NULL;
+	return (Entry*)&_archiveFileContent[pos->second];
+}
+
+template <typename A>
+void File<A>::openTOCIndex(const char* cacheDir, const void* toc, uint64_t tocSize)
+{
+	// -ObjC walks every TOC name, so it still needs the map
+	if ( (cacheDir == NULL) || (_loadMode == LibraryOptions::ArchiveLoadMode::objc) )
+		return;
+	_tocIndex = TOCIndex::open(cacheDir, this->path(), architecture(), this->modificationTime(), _archiveFilelength,
+								toc, tocSize, _tableOfContentCount, ^(uint32_t index) {
+		return this->tocEntryName(index);
+	});
+}
+
 template <typename A>
 void File<A>::buildHashTable()
 {
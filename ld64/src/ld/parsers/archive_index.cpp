@@ -0,0 +1,267 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/param.h>
+#include <CommonCrypto/CommonDigest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ld.hpp"
+#include "archive_index.h"
+
+namespace archive {
+
+// on disk layout: Header, uint32_t displacements[bucketCount], uint32_t slots[slotCount]
+struct TOCIndex::Header
+{
+	char		magic[16];
+	uint64_t	archiveLength;
+	int64_t		modTime;
+	uint64_t	tocDigest;
+	uint32_t	arch;
+	uint32_t	entryCount;
+	// fields above must match the archive for the index to be used
+	uint32_t	bucketCount;
+	uint32_t	slotCount;
+};
+
+static const char		kMagic[16]			= "ld64-tocindex-1";
+static const uint32_t	kMaxDisplacement	= 1 << 20;
+
+
+// FNV-1a
+static uint64_t hashName(std::string_view name)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (char c : name) {
+		hash ^= (uint8_t)c;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static uint32_t slotFor(uint64_t hash, uint32_t displacement, uint32_t slotCount)
+{
+	uint64_t h = hash ^ ((uint64_t)displacement * 0x9E3779B97F4A7C15ULL);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	return (uint32_t)(h % slotCount);
+}
+
+// cheap digest of the ranlib array, to notice an archive rewritten with the same size and mtime
+static uint64_t digestTOC(const void* toc, uint64_t tocSize)
+{
+	const uint8_t* p   = (const uint8_t*)toc;
+	uint64_t       h   = tocSize;
+	uint64_t       i   = 0;
+	for (; i + 8 <= tocSize; i += 8) {
+		uint64_t word;
+		memcpy(&word, &p[i], 8);
+		h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+	}
+	for (; i < tocSize; ++i)
+		h = (h ^ p[i]) * 0x100000001b3ULL;
+	return h;
+}
+
+
+TOCIndex::TOCIndex(const void* mapping, uint64_t mappingSize)
+	: _mapping(mapping), _mappingSize(mappingSize)
+{
+	const Header* header = (const Header*)mapping;
+	_bucketCount   = header->bucketCount;
+	_slotCount     = header->slotCount;
+	_entryCount    = header->entryCount;
+	_displacements = (const uint32_t*)&header[1];
+	_slots         = &_displacements[_bucketCount];
+}
+
+TOCIndex::~TOCIndex()
+{
+	::munmap((void*)_mapping, _mappingSize);
+}
+
+uint32_t TOCIndex::find(std::string_view name) const
+{
+	const uint64_t hash = hashName(name);
+	const uint32_t entry = _slots[slotFor(hash, _displacements[hash % _bucketCount], _slotCount)];
+	return (entry < _entryCount) ? entry : kNotFound;
+}
+
+
+TOCIndex* TOCIndex::open(const char* cacheDir, const char* archivePath, cpu_type_t arch,
+						 time_t modTime, uint64_t archiveLength, const void* toc, uint64_t tocSize,
+						 uint32_t entryCount, EntryName entryName)
+{
+	if ( entryCount == 0 )
+		return NULL;
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(header.magic));
+	header.archiveLength = archiveLength;
+	header.modTime       = modTime;
+	header.tocDigest     = digestTOC(toc, tocSize);
+	header.arch          = arch;
+	header.entryCount    = entryCount;
+
+	// the index file name comes from the archive's real path and architecture
+	char realPath[PATH_MAX];
+	if ( ::realpath(archivePath, realPath) == NULL )
+		strlcpy(realPath, archivePath, PATH_MAX);
+	uint8_t key[CC_SHA256_DIGEST_LENGTH];
+	CC_SHA256_CTX ctx;
+	CC_SHA256_Init(&ctx);
+	CC_SHA256_Update(&ctx, realPath, (CC_LONG)strlen(realPath)+1);
+	CC_SHA256_Update(&ctx, &arch, sizeof(arch));
+	CC_SHA256_Final(key, &ctx);
+	static const char hexDigits[] = "0123456789abcdef";
+	std::string path = cacheDir;
+	path += "/";
+	for (unsigned i=0; i < 16; ++i) {
+		path.push_back(hexDigits[key[i] >> 4]);
+		path.push_back(hexDigits[key[i] & 0xF]);
+	}
+	path += ".tocindex";
+
+	for (int attempt=0; attempt < 2; ++attempt) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if ( fd != -1 ) {
+			struct stat statBuf;
+			void* p = MAP_FAILED;
+			if ( (::fstat(fd, &statBuf) == 0) && ((uint64_t)statBuf.st_size >= sizeof(Header)) )
+				p = ::mmap(NULL, statBuf.st_size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if ( p != MAP_FAILED ) {
+				const Header* existing = (const Header*)p;
+				const uint64_t expectedSize = sizeof(Header) + 4*((uint64_t)existing->bucketCount + existing->slotCount);
+				if ( (memcmp(existing, &header, offsetof(Header, bucketCount)) == 0)
+					&& (existing->bucketCount != 0) && (existing->slotCount != 0)
+					&& ((uint64_t)statBuf.st_size == expectedSize) )
+					return new TOCIndex(p, statBuf.st_size);
+				::munmap(p, statBuf.st_size);
+			}
+		}
+		// missing or stale, build a new one and map that
+		if ( attempt == 0 ) {
+			::mkdir(cacheDir, S_IRWXU|S_IRWXG|S_IRWXO);
+			if ( !build(path.c_str(), header, entryCount, entryName) )
+				return NULL;
+		}
+	}
+	return NULL;
+}
+
+
+//
+// Builds the index with "hash, displace": names are split into buckets, and
+// each bucket (largest first) is given the first displacement that moves all
+// its names to free slots.  A lookup is then one bucket read and one slot read.
+//
+bool TOCIndex::build(const char* path, const Header& archiveHeader, uint32_t entryCount, EntryName entryName)
+{
+	// when a name is in the TOC more than once, the earliest entry is found
+	std::unordered_map<std::string_view, uint32_t> firstEntry;
+	firstEntry.reserve(entryCount);
+	std::vector<std::pair<uint64_t, uint32_t>> keys;	// name hash, TOC index
+	keys.reserve(entryCount);
+	for (uint32_t i=0; i < entryCount; ++i) {
+		std::string_view name = entryName(i);
+		if ( firstEntry.emplace(name, i).second )
+			keys.emplace_back(hashName(name), i);
+	}
+
+	Header header = archiveHeader;
+	header.bucketCount = (uint32_t)(keys.size() / 4) + 1;
+	header.slotCount   = (uint32_t)(keys.size() + keys.size() / 4) + 1;
+	std::vector<std::vector<uint32_t>> buckets(header.bucketCount);
+	for (uint32_t k=0; k < keys.size(); ++k)
+		buckets[keys[k].first % header.bucketCount].push_back(k);
+	std::vector<uint32_t> order(header.bucketCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return buckets[a].size() > buckets[b].size();
+	});
+
+	std::vector<uint32_t> displacements(header.bucketCount, 0);
+	std::vector<uint32_t> slots(header.slotCount, kNotFound);
+	std::vector<uint32_t> trial;
+	for (uint32_t b : order) {
+		const std::vector<uint32_t>& bucket = buckets[b];
+		if ( bucket.empty() )
+			break;
+		bool placed = false;
+		for (uint32_t d=0; (d < kMaxDisplacement) && !placed; ++d) {
+			trial.clear();
+			for (uint32_t k : bucket) {
+				uint32_t slot = slotFor(keys[k].first, d, header.slotCount);
+				if ( (slots[slot] != kNotFound) || (std::find(trial.begin(), trial.end(), slot) != trial.end()) )
+					break;
+				trial.push_back(slot);
+			}
+			if ( trial.size() == bucket.size() ) {
+				for (size_t i=0; i < bucket.size(); ++i)
+					slots[trial[i]] = keys[bucket[i]].second;
+				displacements[b] = d;
+				placed = true;
+			}
+		}
+		// only possible if two names have the same 64-bit hash
+		if ( !placed )
+			return false;
+	}
+
+	// write to a temp file then rename, so that a partial index is never mapped
+	std::string tempPath = std::string(path) + ".XXXXXX";
+	int fd = ::mkstemp(&tempPath[0]);
+	if ( fd == -1 )
+		return false;
+	bool ok = (ld::utils::write64(fd, &header, sizeof(header)) == sizeof(header))
+		&& (ld::utils::write64(fd, displacements.data(), 4*displacements.size()) == (ssize_t)(4*displacements.size()))
+		&& (ld::utils::write64(fd, slots.data(), 4*slots.size()) == (ssize_t)(4*slots.size()));
+	::close(fd);
+	if ( ok )
+		ok = (::rename(tempPath.c_str(), path) == 0);
+	if ( !ok )
+		::unlink(tempPath.c_str());
+	return ok;
+}
+
+} // namespace archive
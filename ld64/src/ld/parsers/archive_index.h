@@ -0,0 +1,82 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-*
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+
+#ifndef __ARCHIVE_INDEX_H__
+#define __ARCHIVE_INDEX_H__
+
+#include <stdint.h>
+#include <time.h>
+#include <mach/machine.h>
+
+#include <string_view>
+
+namespace archive {
+
+//
+// TOCIndex implements -archive_index_cache_path.  It is a minimal perfect hash
+// over the unique symbol names in an archive's table of contents, stored in a
+// cache directory and mmap()ed by later links, so that looking up a symbol does
+// not require hashing every TOC entry into a map first.
+//
+// A lookup returns the index of the first TOC entry that could hold the name.
+// The caller must compare the name with that entry, since names that are not
+// in the archive also map to some entry.  A slot outside the TOC (an index file
+// that was damaged after it was written) is reported as kNotFound.
+//
+class TOCIndex
+{
+public:
+	static const uint32_t			kNotFound = 0xFFFFFFFF;
+
+	// returns the name of TOC entry 'index'
+	typedef const char*				(^EntryName)(uint32_t index);
+
+	// maps the cached index for the archive, building and saving it first if
+	// it is missing or stale.  Returns NULL if no index could be made.
+	static TOCIndex*				open(const char* cacheDir, const char* archivePath, cpu_type_t arch,
+										time_t modTime, uint64_t archiveLength, const void* toc, uint64_t tocSize,
+										uint32_t entryCount, EntryName entryName);
+									~TOCIndex();
+
+	uint32_t						find(std::string_view name) const;
+
+private:
+	struct Header;
+
+									TOCIndex(const void* mapping, uint64_t mappingSize);
+	static bool						build(const char* path, const Header& header, uint32_t entryCount, EntryName entryName);
+
+	const void*						_mapping;
+	uint64_t						_mappingSize;
+	uint32_t						_bucketCount;
+	uint32_t						_slotCount;
+	uint32_t						_entryCount;
+	const uint32_t*					_displacements;
+	const uint32_t*					_slots;
+};
+
+} // namespace archive
+
+#endif // __ARCHIVE_INDEX_H__
@@ -88,6 +88,7 @@ File::File(const char* path, time_t mTime, ld::File::Ordinal ord, const ld::Vers
       _hasPublicInstallName(false),
       _appExtensionSafe(false),
       _isUnzipperedTwin(false),
+      _exportsPending(false),
       _allowWeakImports(allowWeakImports),
       _allowSimToMacOSXLinking(allowSimToMacOSX),
       _addVersionLoadCommand(addVers)
@@ -121,8 +122,17 @@ File::File(const char* path, time_t mTime, ld::File::Ordinal ord, const ld::Vers
     }
 }
 
+void File::loadPendingExports() const
+{
+    if ( _exportsPending ) {
+        _exportsPending = false;
+        const_cast<File*>(this)->loadExports();
+    }
+}
+
 std::pair<bool, bool> File::hasWeakDefinitionImpl(const char* name) const
 {
+    loadPendingExports();
     const auto pos = _atoms.find(name);
     if ( pos != this->_atoms.end() )
         return std::make_pair(true, pos->second.weakDef);
@@ -140,6 +150,7 @@ std::pair<bool, bool> File::hasWeakDefinitionImpl(const char* name) const
 
 bool File::hasDefinitionImpl(const char* name) const
 {
+    loadPendingExports();
     const auto pos = _atoms.find(name);
     if ( pos != this->_atoms.end() )
         return true;
@@ -178,6 +189,7 @@ bool File::containsOrReExports(const char* name, AtomAndWeak& atom) const
         return false;
 
     // check myself
+    loadPendingExports();
     const auto pos = _atoms.find(name);
     if ( pos != _atoms.end() ) {
         atom = pos->second;
@@ -232,6 +244,7 @@ bool File::justInTimeforEachAtom(const char* name, ld::File::AtomHandler& handle
 
 void File::forEachExportedSymbol(void (^handler)(const char* symbolName, bool weakDef)) const
 {
+    loadPendingExports();
     for (const auto& entry : _atoms) {
         handler(entry.first, entry.second.weakDef);
     }
@@ -443,6 +456,19 @@ void File::processIndirectLibraries(ld::dylib::File::DylibHandler* handler, bool
     _indirectDylibsProcessed = true;
 }
 
+void File::forEachDependentDylib(void (^handler)(const char* installPath)) const
+{
+    // mirrors which dependents processIndirectLibraries() looks up
+    if ( _indirectDylibsProcessed )
+        return;
+    if ( !_linkingFlat && _noRexports )
+        return;
+    for (const Dependent& dep : _dependentDylibs) {
+        if ( _linkingFlat || dep.reExport || !_explictReExportFound )
+            handler(dep.path);
+    }
+}
+
 bool File::isPublicLocation(const char* path) const
 {
     // -no_implicit_dylibs disables this optimization
@@ -114,6 +114,7 @@ public:
 
 	// overrides of ld::dylib::File
 	virtual void							processIndirectLibraries(ld::dylib::File::DylibHandler*, bool addImplicitDylibs) override;
+	virtual void							forEachDependentDylib(void (^handler)(const char* installPath)) const override;
 	virtual bool							indirectLibrariesProcessed() const final { return _indirectDylibsProcessed; }
 	virtual bool							providedExportAtom() const	override final { return _providedAtom; }
     virtual bool                            hasReExportedDependentsThatProvidedExportAtom() const override;
@@ -159,9 +160,12 @@ private:
     bool                        hasDefinitionImpl(const char* name) const;
 	bool						containsOrReExports(const char* name, AtomAndWeak& atom) const;
 	void						assertNoReExportCycles(ReExportChain*) const;
+	void						loadPendingExports() const;
 
 protected:
 	bool						isPublicLocation(const char* path) const;
+	// subclasses that set _exportsPending add their exports here, on the first symbol lookup
+	virtual void				loadExports() { }
 
 private:
 	ld::Section							_importProxySection;
@@ -190,6 +194,7 @@ protected:
 	bool								_hasPublicInstallName;
 	bool								_appExtensionSafe;
     bool                                _isUnzipperedTwin;
+	mutable bool						_exportsPending;
     const bool                          _allowWeakImports;
 	const bool							_allowSimToMacOSXLinking;
 	const bool							_addVersionLoadCommand;
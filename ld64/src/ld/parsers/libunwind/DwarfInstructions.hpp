@@ -32,11 +32,14 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 #include <vector>
 #include <unordered_set>
 
+#include <dispatch/dispatch.h>
+
 #include <libunwind.h>
 #include <mach-o/compact_unwind_encoding.h>
 
@@ -111,6 +114,17 @@ public:
 										
 private:
 
+	// an FDE whose dwarf still needs to be converted to a compact unwind encoding
+	struct PendingFDE {
+		CFI_Atom_Info<A>*					entry;		// NULL if this only holds a warning
+		typename CFI_Parser<A>::FDE_Info	fdeInfo;
+		typename CFI_Parser<A>::CIE_Info	cieInfo;
+		pint_t								warningAddr;
+		const char*							warning;
+		bool								warningAllocated;
+	};
+	static void convertPendingFDEs(A& addressSpace, std::vector<PendingFDE>& pending, void* ref, WarnFunc warn);
+
 	enum {
 		DW_X86_64_RET_ADDR = 16
 	};
@@ -193,6 +207,8 @@ const char* DwarfInstructions<A,R>::parseCFIs(A& addressSpace, pint_t ehSectionS
 	CFI_Atom_Info<A>* entry = infos;
 	CFI_Atom_Info<A>* end = &infos[infosCount];
 	const pint_t ehSectionEnd = ehSectionStart + sectionLength;
+	// converting dwarf to compact unwind is the expensive part, so it is done for all FDEs at once after the scan
+	std::vector<PendingFDE> pending;
 	for (pint_t p=ehSectionStart; p < ehSectionEnd; ) {
 		pint_t currentCFI = p;
 		uint64_t cfiLength = addressSpace.get32(p);
@@ -202,8 +218,10 @@ const char* DwarfInstructions<A,R>::parseCFIs(A& addressSpace, pint_t ehSectionS
 			cfiLength = addressSpace.get64(p);
 			p += 8;
 		}
-		if ( cfiLength == 0 ) 
+		if ( cfiLength == 0 ) {
+			convertPendingFDEs(addressSpace, pending, ref, warn);
 			return NULL;	// end marker
+		}
 		if ( entry >= end )
 			return "too little space allocated for parseCFIs";
 		pint_t nextCFI = p + cfiLength;
@@ -275,7 +293,7 @@ const char* DwarfInstructions<A,R>::parseCFIs(A& addressSpace, pint_t ehSectionS
 			// See if already is a compact unwind for this address.  
 			bool alreadyHaveCU = cuStarts.find(entry->u.fdeInfo.function.targetAddress) != cuStarts.end();
             if ( pcRange == 0 ) {
-                warn(ref, pcStart, "FDE found for zero size function");
+                pending.push_back({ NULL, {}, {}, pcStart, "FDE found for zero size function", false });
                 break;
             }
 			//fprintf(stderr, "FDE for func at 0x%08X, alreadyHaveCU=%d\n", (uint32_t)entry->u.fdeInfo.function.targetAddress, alreadyHaveCU);
@@ -289,28 +307,15 @@ const char* DwarfInstructions<A,R>::parseCFIs(A& addressSpace, pint_t ehSectionS
 					entry->u.fdeInfo.compactUnwindInfo = encodeToUseDwarf(dummy);
 				}
 				else {
-					// compute compact unwind encoding by parsing dwarf
-					typename CFI_Parser<A>::FDE_Info fdeInfo;
-					fdeInfo.fdeStart = currentCFI;
-					fdeInfo.fdeLength = nextCFI - currentCFI;
-					fdeInfo.fdeInstructions = p;
-					fdeInfo.pcStart = pcStart;
-					fdeInfo.pcEnd = pcStart +  pcRange;
-					fdeInfo.lsda = entry->u.fdeInfo.lsda.targetAddress;
-					typename CFI_Parser<A>::PrologInfo prolog;
-					R dummy; // for proper selection of architecture specific functions
-					if ( CFI_Parser<A>::parseFDEInstructions(addressSpace, fdeInfo, cieInfo, CFI_INVALID_ADDRESS, &prolog) ) {
-						char warningBuffer[1024];
-						entry->u.fdeInfo.compactUnwindInfo = createCompactEncodingFromProlog(addressSpace, fdeInfo.pcStart, dummy, prolog, warningBuffer);
-						if ( fdeInfo.lsda != CFI_INVALID_ADDRESS ) 
-							entry->u.fdeInfo.compactUnwindInfo |= UNWIND_HAS_LSDA;
-						if ( warningBuffer[0] != '\0' )
-							warn(ref, fdeInfo.pcStart, warningBuffer);
-					}
-					else {
-						warn(ref, CFI_INVALID_ADDRESS, "dwarf unwind instructions could not be parsed");
-						entry->u.fdeInfo.compactUnwindInfo = encodeToUseDwarf(dummy);
-					}
+					// record what is needed to compute compact unwind encoding by parsing dwarf
+					PendingFDE fde = { entry, {}, cieInfo, CFI_INVALID_ADDRESS, NULL, false };
+					fde.fdeInfo.fdeStart = currentCFI;
+					fde.fdeInfo.fdeLength = nextCFI - currentCFI;
+					fde.fdeInfo.fdeInstructions = p;
+					fde.fdeInfo.pcStart = pcStart;
+					fde.fdeInfo.pcEnd = pcStart +  pcRange;
+					fde.fdeInfo.lsda = entry->u.fdeInfo.lsda.targetAddress;
+					pending.push_back(fde);
 				}
 				++entry;
 			}
@@ -321,11 +326,59 @@ const char* DwarfInstructions<A,R>::parseCFIs(A& addressSpace, pint_t ehSectionS
 		//fprintf(stderr, "DwarfInstructions<A,R>::parseCFIs() infosCount was %d on input, now %ld\n", infosCount, entry - infos); 
 		infosCount = (entry - infos);
 	}
+	convertPendingFDEs(addressSpace, pending, ref, warn);
 	
 	return NULL; // success
 }
 
 
+template <typename A, typename R>
+void DwarfInstructions<A,R>::convertPendingFDEs(A& addressSpace, std::vector<PendingFDE>& pending, void* ref, WarnFunc warn)
+{
+	// each FDE converts independently, large object files have enough of them to be worth spreading across cores
+	PendingFDE* pendingData = pending.data();
+	A*          space       = &addressSpace;
+	void (^convert)(size_t) = ^(size_t index) {
+		PendingFDE& fde = pendingData[index];
+		if ( fde.entry == NULL )
+			return;
+		typename CFI_Parser<A>::PrologInfo prolog;
+		R dummy; // for proper selection of architecture specific functions
+		if ( CFI_Parser<A>::parseFDEInstructions(*space, fde.fdeInfo, fde.cieInfo, CFI_INVALID_ADDRESS, &prolog) ) {
+			char warningBuffer[1024];
+			warningBuffer[0] = '\0';
+			fde.entry->u.fdeInfo.compactUnwindInfo = createCompactEncodingFromProlog(*space, fde.fdeInfo.pcStart, dummy, prolog, warningBuffer);
+			if ( fde.fdeInfo.lsda != CFI_INVALID_ADDRESS ) 
+				fde.entry->u.fdeInfo.compactUnwindInfo |= UNWIND_HAS_LSDA;
+			if ( warningBuffer[0] != '\0' ) {
+				fde.warningAddr      = fde.fdeInfo.pcStart;
+				fde.warning          = strdup(warningBuffer);
+				fde.warningAllocated = true;
+			}
+		}
+		else {
+			fde.warning = "dwarf unwind instructions could not be parsed";
+			fde.entry->u.fdeInfo.compactUnwindInfo = encodeToUseDwarf(dummy);
+		}
+	};
+	if ( pending.size() > 256 )
+		dispatch_apply(pending.size(), DISPATCH_APPLY_AUTO, convert);
+	else {
+		for (size_t i=0; i < pending.size(); ++i)
+			convert(i);
+	}
+
+	// report problems in __eh_frame order
+	for (PendingFDE& fde : pending) {
+		if ( fde.warning == NULL )
+			continue;
+		warn(ref, fde.warningAddr, fde.warning);
+		if ( fde.warningAllocated )
+			free((void*)fde.warning);
+	}
+}
+
+
 
 
 template <typename A, typename R>
@@ -31,6 +31,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <unistd.h>
 #include <pthread.h>
 #include <mach-o/dyld.h>
 #include <dlfcn.h>
@@ -42,6 +43,8 @@
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <CommonCrypto/CommonDigest.h>
 
 #include "MachOFileAbstraction.hpp"
 #include "Architectures.hpp"
@@ -50,6 +53,7 @@
 #include "lto_file.h"
 #include "SymbolTable.h"
 #include "Containers.h"
+#include "TraceEvents.h"
 
 #include "llvm-c/lto.h"
 
@@ -87,6 +91,52 @@ private:
 };
 
 
+//
+// SymbolTableCache remembers the symbol table of each bitcode module in a directory
+// inside the -cache_path_lto directory.  Tables are keyed by a SHA-256 of the bitcode
+// and the libLTO version, so when the same bitcode is linked again (e.g. many test
+// executables against the same libraries) libLTO does not have to parse each module
+// just to list its symbols.
+//
+class SymbolTableCache
+{
+public:
+	struct Key						{ uint8_t bytes[CC_SHA256_DIGEST_LENGTH]; };
+
+	// a cached table, mapped read-only
+	class Table
+	{
+	public:
+									~Table();
+		bool						isThinLTO() const;
+		uint32_t					count() const;
+		const char*					name(uint32_t index) const;
+		lto_symbol_attributes		attributes(uint32_t index) const;
+	private:
+		friend class SymbolTableCache;
+		struct Header;
+		struct Entry;
+									Table(const void* mapping, size_t mappingSize);
+
+		const void*					_mapping;
+		size_t						_mappingSize;
+	};
+
+	static void						setDirectory(const char* ltoCachePath);
+	static bool						enabled()		{ return !sDirectory.empty(); }
+	static Key						keyFor(const uint8_t* content, uint32_t contentLength);
+	// maps the table cached for the key, returns NULL if there is none
+	static const Table*				find(const Key& key);
+	// caches the symbol table of a parsed module
+	static void						save(const Key& key, lto_module_t module, bool isThinLTO);
+
+private:
+	static std::string				pathFor(const Key& key);
+
+	static std::string				sDirectory;
+};
+
+
 //
 // LLVM bitcode file 
 //
@@ -145,6 +195,7 @@ private:
 	class Atom*								_atomArray;
 	uint32_t								_atomArrayCount;
 	lto_module_t							_module;
+	const SymbolTableCache::Table*			_symbolTable;
 	const char*                             _path;
 	const uint8_t*                          _content;
 	uint32_t                                _contentLength;
@@ -388,6 +439,8 @@ ld::relocatable::File* Parser::parseMachOFile(const uint8_t* p, size_t len, cons
 	const char *object_path = path.c_str();
 	if (path.empty())
 		object_path = "/tmp/lto.o";
+	const char* leafName = strrchr(object_path, '/');
+	ld::tool::TraceSpan span((leafName != NULL) ? leafName+1 : object_path, "parse", object_path);
 
 	time_t modTime = 0;
 	struct stat statBuffer;
@@ -404,45 +457,74 @@ ld::relocatable::File* Parser::parseMachOFile(const uint8_t* p, size_t len, cons
 
 File::File(const char* pth, time_t mTime, ld::File::Ordinal ordinal, const uint8_t* content, uint32_t contentLength, cpu_type_t arch) 
 	: ld::relocatable::File(pth,mTime,ordinal), _isThinLTO(false), _architecture(arch), _internalAtom(*this),
-	_atomArray(NULL), _atomArrayCount(0), _module(NULL), _path(pth),
+	_atomArray(NULL), _atomArrayCount(0), _module(NULL), _symbolTable(NULL), _path(pth),
 	_content(content), _contentLength(contentLength), _debugInfoPath(pth),
 	_section("__TEXT_", "__tmp_lto", ld::Section::typeTempLTO),
 	_fixupToInternal(0, ld::Fixup::k1of1, ld::Fixup::kindNone, &_internalAtom),
 	_debugInfo(ld::relocatable::File::kDebugInfoNone), _cpuSubType(0)
 {
 	const bool log = false;
-	
+
+	// A module with a cached symbol table is not parsed here.  That needs libLTO to support
+	// local contexts, because then the module is re-created from the content when it is used.
+	SymbolTableCache::Key cacheKey;
+	const bool useSymbolTableCache = SymbolTableCache::enabled();
+	if ( useSymbolTableCache ) {
+		cacheKey = SymbolTableCache::keyFor(content, contentLength);
+		if ( sHasTriedLocalContext && sSupportsLocalContext )
+			_symbolTable = SymbolTableCache::find(cacheKey);
+	}
+
 	// create llvm module
+	if ( _symbolTable == NULL ) {
 #if LTO_API_VERSION >= 11
-	if ( sSupportsLocalContext || !sHasTriedLocalContext ) {
-		_module = ::lto_module_create_in_local_context(content, contentLength, pth);
-	}
-	if ( !sHasTriedLocalContext ) {
-		sHasTriedLocalContext = true;
-		sSupportsLocalContext = (_module != NULL);
-	}
-	if ( (_module == NULL) && !sSupportsLocalContext )
+		if ( sSupportsLocalContext || !sHasTriedLocalContext ) {
+			_module = ::lto_module_create_in_local_context(content, contentLength, pth);
+		}
+		if ( !sHasTriedLocalContext ) {
+			sHasTriedLocalContext = true;
+			sSupportsLocalContext = (_module != NULL);
+		}
+		if ( (_module == NULL) && !sSupportsLocalContext )
 #endif
 #if LTO_API_VERSION >= 9
-	_module = ::lto_module_create_from_memory_with_path(content, contentLength, pth);
-	if ( _module == NULL && !sSupportsLocalContext )
+		_module = ::lto_module_create_from_memory_with_path(content, contentLength, pth);
+		if ( _module == NULL && !sSupportsLocalContext )
 #endif
-	_module = ::lto_module_create_from_memory(content, contentLength);
-    if ( _module == NULL )
-		throwf("could not parse object file %s: '%s', using libLTO version '%s'", pth, ::lto_get_error_message(), ::lto_get_version());
+		_module = ::lto_module_create_from_memory(content, contentLength);
+		if ( _module == NULL )
+			throwf("could not parse object file %s: '%s', using libLTO version '%s'", pth, ::lto_get_error_message(), ::lto_get_version());
 
-	if ( log ) fprintf(stderr, "bitcode file: %s\n", pth);
+		if ( log ) fprintf(stderr, "bitcode file: %s\n", pth);
 
 #if LTO_API_VERSION >= 18
-	_isThinLTO = ::lto_module_is_thinlto(_module);
+		_isThinLTO = ::lto_module_is_thinlto(_module);
 #endif
 
+		if ( useSymbolTableCache && sSupportsLocalContext ) {
+			SymbolTableCache::save(cacheKey, _module, _isThinLTO);
+			_symbolTable = SymbolTableCache::find(cacheKey);
+		}
+	}
+	else {
+		_isThinLTO = _symbolTable->isThinLTO();
+		if ( log ) fprintf(stderr, "bitcode file: %s (cached symbol table)\n", pth);
+	}
+
 	// create atom for each global symbol in module
-	uint32_t count = ::lto_module_get_num_symbols(_module);
+	uint32_t count = (_symbolTable != NULL) ? _symbolTable->count() : ::lto_module_get_num_symbols(_module);
 	_atomArray = (Atom*)malloc(sizeof(Atom)*count);
 	for (uint32_t i=0; i < count; ++i) {
-		const char* name = ::lto_module_get_symbol_name(_module, i);
-		lto_symbol_attributes attr = lto_module_get_symbol_attribute(_module, i);
+		const char* name;
+		lto_symbol_attributes attr;
+		if ( _symbolTable != NULL ) {
+			name = _symbolTable->name(i);
+			attr = _symbolTable->attributes(i);
+		}
+		else {
+			name = ::lto_module_get_symbol_name(_module, i);
+			attr = lto_module_get_symbol_attribute(_module, i);
+		}
 
 		// <rdar://problem/6378110> LTO doesn't like dtrace symbols
 		// ignore dtrace static probes for now
@@ -520,11 +602,26 @@ File::File(const char* pth, time_t mTime, ld::File::Ordinal ordinal, const uint8
 File::~File()
 {
 	this->release();
+	delete _symbolTable;
 }
 
 // this is only called when generating a text map file, to better detail where code came from
 void File::forEachLtoSymbol(void (^handler)(const char*)) const
 {
+	if ( _symbolTable != NULL ) {
+		for (uint32_t i=0; i < _symbolTable->count(); ++i) {
+			switch ( _symbolTable->attributes(i) & LTO_SYMBOL_DEFINITION_MASK ) {
+				case LTO_SYMBOL_DEFINITION_REGULAR:
+				case LTO_SYMBOL_DEFINITION_TENTATIVE:
+				case LTO_SYMBOL_DEFINITION_WEAK:
+					handler(_symbolTable->name(i));
+					break;
+				default:
+					break;
+			}
+		}
+		return;
+	}
 #if LTO_API_VERSION >= 11
 	if ( lto_module_t module = ::lto_module_create_in_local_context(_content, _contentLength, _path) ) {
 		uint32_t count = ::lto_module_get_num_symbols(module);
@@ -992,6 +1089,7 @@ bool Parser::optimizeLTO(const std::vector<File*>				files,
 						 ld::File::AtomHandler&					handler,
 						 std::vector<const ld::Atom*>&			newAtoms,
 						 std::vector<const char*>&				additionalUndefines) {
+	ld::tool::TraceSpan span("LTO codegen", "lto");
 	const bool logExtraOptions = false;
 	const bool logBitcodeFiles = false;
 
@@ -1243,12 +1341,6 @@ thinlto_code_gen_t Parser::init_thinlto_codegen(const std::vector<File*>&
 			if ( logMustPreserve ) fprintf(stderr, "NOT preserving(%s)\n", name);
 		}
 
-		// <rdar://problem/16165191> tell code generator to preserve initial undefines
-		for (const char* undefName : *options.initialUndefines) {
-			if ( logMustPreserve ) fprintf(stderr, "thinlto_codegen_add_cross_referenced_symbol(%s) because it is an initial undefine\n", undefName);
-			::thinlto_codegen_add_cross_referenced_symbol(thingenerator, undefName, strlen(undefName));
-		}
-
 // FIXME: to be implemented
 //		else if ( options.relocatable && hasNonllvmAtoms ) {
 //			// <rdar://problem/14334895> ld -r mode but merging in some mach-o files, so need to keep libLTO from optimizing away anything
@@ -1257,6 +1349,15 @@ thinlto_code_gen_t Parser::init_thinlto_codegen(const std::vector<File*>&
 //		}
 	}
 
+	// <rdar://problem/16165191> tell code generator to preserve initial undefines
+	// (once, rather than again for every llvm atom)
+	if ( !llvmAtoms.empty() ) {
+		for (const char* undefName : *options.initialUndefines) {
+			if ( logMustPreserve ) fprintf(stderr, "thinlto_codegen_add_cross_referenced_symbol(%s) because it is an initial undefine\n", undefName);
+			::thinlto_codegen_add_cross_referenced_symbol(thingenerator, undefName, strlen(undefName));
+		}
+	}
+
 	return thingenerator;
 }
 #endif
@@ -1269,6 +1370,7 @@ bool Parser::optimizeThinLTO(const std::vector<File*>&              files,
 							 ld::File::AtomHandler&					handler,
 							 std::vector<const ld::Atom*>&			newAtoms,
 							 std::vector<const char*>&				additionalUndefines) {
+	ld::tool::TraceSpan span("ThinLTO codegen", "lto");
 	const bool logBitcodeFiles = false;
 
 	if (files.empty())
@@ -1688,6 +1790,167 @@ pthread_mutex_t Mutex::lto_lock = PTHREAD_MUTEX_INITIALIZER;
 bool File::sSupportsLocalContext = false;
 bool File::sHasTriedLocalContext = false;
 
+
+// on disk layout: Header, Entry entries[symbolCount], char strings[stringsSize]
+struct SymbolTableCache::Table::Header
+{
+	char		magic[16];
+	uint8_t		key[CC_SHA256_DIGEST_LENGTH];
+	uint32_t	isThinLTO;
+	uint32_t	symbolCount;
+	uint32_t	stringsSize;
+	uint32_t	reserved;
+};
+
+struct SymbolTableCache::Table::Entry
+{
+	uint32_t	nameOffset;
+	uint32_t	attributes;
+};
+
+static const char kSymbolTableMagic[16] = "ld64-ltosyms-1";
+static const char kSymbolTableSubdirectory[] = "/ld64-symbol-tables";
+
+std::string SymbolTableCache::sDirectory;
+
+
+SymbolTableCache::Table::Table(const void* mapping, size_t mappingSize)
+	: _mapping(mapping), _mappingSize(mappingSize)
+{
+}
+
+SymbolTableCache::Table::~Table()
+{
+	::munmap((void*)_mapping, _mappingSize);
+}
+
+bool SymbolTableCache::Table::isThinLTO() const
+{
+	return (((const Header*)_mapping)->isThinLTO != 0);
+}
+
+uint32_t SymbolTableCache::Table::count() const
+{
+	return ((const Header*)_mapping)->symbolCount;
+}
+
+const char* SymbolTableCache::Table::name(uint32_t index) const
+{
+	const Header* header  = (const Header*)_mapping;
+	const Entry*  entries = (const Entry*)&header[1];
+	const char*   strings = (const char*)&entries[header->symbolCount];
+	return &strings[entries[index].nameOffset];
+}
+
+lto_symbol_attributes SymbolTableCache::Table::attributes(uint32_t index) const
+{
+	const Entry* entries = (const Entry*)&((const Header*)_mapping)[1];
+	return (lto_symbol_attributes)entries[index].attributes;
+}
+
+
+void SymbolTableCache::setDirectory(const char* ltoCachePath)
+{
+	sDirectory = ltoCachePath;
+}
+
+SymbolTableCache::Key SymbolTableCache::keyFor(const uint8_t* content, uint32_t contentLength)
+{
+	// symbol attributes come from libLTO, so a different libLTO gets different tables
+	const char* ltoVersion = ::lto_get_version();
+	Key key;
+	CC_SHA256_CTX ctx;
+	CC_SHA256_Init(&ctx);
+	CC_SHA256_Update(&ctx, ltoVersion, (CC_LONG)strlen(ltoVersion)+1);
+	CC_SHA256_Update(&ctx, content, (CC_LONG)contentLength);
+	CC_SHA256_Final(key.bytes, &ctx);
+	return key;
+}
+
+std::string SymbolTableCache::pathFor(const Key& key)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+	std::string path = sDirectory + kSymbolTableSubdirectory + "/";
+	for (uint8_t byte : key.bytes) {
+		path.push_back(hexDigits[byte >> 4]);
+		path.push_back(hexDigits[byte & 0xF]);
+	}
+	path += ".ltosyms";
+	return path;
+}
+
+const SymbolTableCache::Table* SymbolTableCache::find(const Key& key)
+{
+	const std::string path = pathFor(key);
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if ( fd == -1 )
+		return NULL;
+	struct stat statBuf;
+	void* p = MAP_FAILED;
+	if ( (::fstat(fd, &statBuf) == 0) && ((uint64_t)statBuf.st_size > sizeof(Table::Header)) )
+		p = ::mmap(NULL, statBuf.st_size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if ( p == MAP_FAILED )
+		return NULL;
+
+	// only use a table that is complete and was made for this bitcode
+	const Table::Header* header = (const Table::Header*)p;
+	const uint64_t expectedSize = sizeof(Table::Header) + (uint64_t)header->symbolCount*sizeof(Table::Entry) + header->stringsSize;
+	const char* lastString = (const char*)p + statBuf.st_size - 1;
+	if ( (memcmp(header->magic, kSymbolTableMagic, sizeof(header->magic)) == 0)
+		&& (memcmp(header->key, key.bytes, sizeof(key.bytes)) == 0)
+		&& ((uint64_t)statBuf.st_size == expectedSize)
+		&& (header->stringsSize != 0) && (*lastString == '\0') ) {
+		const Table::Entry* entries = (const Table::Entry*)&header[1];
+		bool valid = true;
+		for (uint32_t i=0; valid && (i < header->symbolCount); ++i)
+			valid = (entries[i].nameOffset < header->stringsSize);
+		if ( valid )
+			return new Table(p, statBuf.st_size);
+	}
+	::munmap(p, statBuf.st_size);
+	return NULL;
+}
+
+void SymbolTableCache::save(const Key& key, lto_module_t module, bool isThinLTO)
+{
+	Table::Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kSymbolTableMagic, sizeof(header.magic));
+	memcpy(header.key, key.bytes, sizeof(key.bytes));
+	header.isThinLTO   = isThinLTO;
+	header.symbolCount = ::lto_module_get_num_symbols(module);
+	std::vector<Table::Entry> entries(header.symbolCount);
+	std::string strings;
+	for (uint32_t i=0; i < header.symbolCount; ++i) {
+		entries[i].nameOffset = (uint32_t)strings.size();
+		entries[i].attributes = ::lto_module_get_symbol_attribute(module, i);
+		strings += ::lto_module_get_symbol_name(module, i);
+		strings.push_back('\0');
+	}
+	// keeps the strings area non-empty, so a module without symbols is still a valid table
+	strings.push_back('\0');
+	header.stringsSize = (uint32_t)strings.size();
+
+	// write to a temp file then rename, so that a partial table is never mapped
+	::mkdir(sDirectory.c_str(), 0700);
+	::mkdir((sDirectory + kSymbolTableSubdirectory).c_str(), 0700);
+	const std::string path = pathFor(key);
+	std::string tempPath = path + ".XXXXXX";
+	int fd = ::mkstemp(&tempPath[0]);
+	if ( fd == -1 )
+		return;
+	const size_t entriesSize = entries.size()*sizeof(Table::Entry);
+	bool ok = (ld::utils::write64(fd, &header, sizeof(header)) == sizeof(header))
+		&& (ld::utils::write64(fd, entries.data(), entriesSize) == (ssize_t)entriesSize)
+		&& (ld::utils::write64(fd, strings.data(), strings.size()) == (ssize_t)strings.size());
+	::close(fd);
+	if ( ok )
+		ok = (::rename(tempPath.c_str(), path.c_str()) == 0);
+	if ( !ok )
+		::unlink(tempPath.c_str());
+}
+
 //
 // Used by archive reader to see if member is an llvm bitcode file
 //
@@ -1828,6 +2091,10 @@ void set_library(const char *dylib) {
   assert(!sLTOIsLoaded);
   sLTODylib = dylib;
 }
+
+void set_symbol_cache_path(const char *ltoCachePath) {
+  SymbolTableCache::setDirectory(ltoCachePath);
+}
 } // end namespace lto
 
 namespace {
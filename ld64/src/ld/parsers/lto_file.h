@@ -37,6 +37,9 @@ extern unsigned int static_api_version();
 
 void set_library(const char *dylib);
 
+// caches bitcode symbol tables in the -cache_path_lto directory
+void set_symbol_cache_path(const char *ltoCachePath);
+
 extern bool libLTOisLoaded();
 
 extern const char* archName(const uint8_t* fileContent, uint64_t fileLength);
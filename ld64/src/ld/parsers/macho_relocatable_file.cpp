@@ -31,6 +31,7 @@
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <dispatch/dispatch.h>
 
 #include "MachOFileAbstraction.hpp"
 
@@ -76,6 +77,7 @@ public:
 												ld::relocatable::File(p,mTime,ord), _fileContent(content),
 												_sectionsArray(NULL), _atomsArray(NULL),
 												_sectionsArrayCount(0), _atomsArrayCount(0), _aliasAtomsArrayCount(0),
+												_fixups(NULL), _fixupsArrayCount(0),
 												_debugInfoKind(ld::relocatable::File::kDebugInfoNone),
 												_dwarfTranslationUnitPath(NULL), 
 												_dwarfDebugInfoSect(NULL), _dwarfDebugAbbrevSect(NULL), 
@@ -136,7 +138,9 @@ private:
 	uint32_t								_sectionsArrayCount;
 	uint32_t								_atomsArrayCount;
 	uint32_t								_aliasAtomsArrayCount;
-	std::vector<ld::Fixup>					_fixups;
+	ld::Fixup*								_fixups;
+	uint32_t								_fixupsArrayCount;
+	ld::Arena								_arena;				// owns sections, atoms and fixups of this file
 	std::vector<ld::Atom::UnwindInfo>		_unwindInfos;
 	std::vector<ld::Atom::LineInfo>			_lineInfos;
 	std::vector<ld::relocatable::File::Stab>_stabs;
@@ -880,7 +884,7 @@ void Atom<A>::setFixupsRange(uint32_t startIndex, uint32_t count)
 		throwf("too many fixups in function %s", this->name());
 	if ( startIndex >= (1 << kFixupStartIndexBits) ) 
 		throwf("too many fixups in file");
-	assert(((startIndex+count) <= sect().file()._fixups.size()) && "fixup index out of range");
+	assert(((startIndex+count) <= sect().file()._fixupsArrayCount) && "fixup index out of range");
 	_fixupsStartIndex = startIndex; 
 	_fixupsCount = count; 
 }
@@ -1051,27 +1055,27 @@ public:
 
 	struct FixupInAtom {
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, Atom<A>* target) :
-			fixup(src.offsetInAtom, c, k, target), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, target), atom(src.atom) { }
 			
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, Atom<A>* target) :
-			fixup(src.offsetInAtom, c, k, b, target), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, b, target), atom(src.atom) { }
 			
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, bool wi, const char* name) :
-			fixup(src.offsetInAtom, c, k, wi, name), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, wi, name), atom(src.atom) { }
 					
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::TargetBinding b, const char* name) :
-			fixup(src.offsetInAtom, c, k, b, name), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, b, name), atom(src.atom) { }
 					
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, uint64_t addend) :
-			fixup(src.offsetInAtom, c, k, addend), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, addend), atom(src.atom) { }
 
 #if SUPPORT_ARCH_arm64e
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k, ld::Fixup::AuthData authData) :
-			fixup(src.offsetInAtom, c, k, authData), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, authData), atom(src.atom) { }
 #endif
 
 		FixupInAtom(const SourceLocation& src, ld::Fixup::Cluster c, ld::Fixup::Kind k) :
-			fixup(src.offsetInAtom, c, k, (uint64_t)0), atom(src.atom) { src.atom->incrementFixupCount(); }
+			fixup(src.offsetInAtom, c, k, (uint64_t)0), atom(src.atom) { }
 
 		ld::Fixup		fixup;
 		Atom<A>*		atom;
@@ -1244,6 +1248,7 @@ private:
 															bool verboseOptimizationHints);
 	ld::relocatable::File*							parse(const ParserOptions& opts);
 	static uint8_t									loadCommandSizeMask();
+	static const uint32_t							kConcurrentSectionsMinRelocations = 32*1024;
 	bool											parseLoadCommands(const ld::VersionSet& platforms, bool internalSDK);
 	void											makeSections();
 	void											prescanSymbolTable();
@@ -2057,38 +2062,109 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 	Section<A>** sections = _file->_sectionsArray;
 	uint32_t	sectionsCount = _file->_sectionsArrayCount;
 
+	// Object files with many relocations (e.g. unity builds) are worth splitting up.  Sections are
+	// atomized and have their relocations turned into fixups as independent tasks.  Each section's
+	// results land in slots that only it owns and are merged in section order, so the atoms and
+	// fixups are the same as when the sections are processed one after another.  Warnings are
+	// held per section and reported in section order too.
+	uint64_t relocationCount = 0;
+	for (uint32_t i=0; i < sectionsCount; ++i) {
+		if ( const macho_section<P>* sect = sections[i]->machoSection() )
+			relocationCount += sect->nreloc();
+	}
+	const bool parseSectionsConcurrently = (relocationCount >= kConcurrentSectionsMinRelocations) && (sectionsCount > 1);
+	Parser<A>* parser = this;
+	const uint32_t* sortedSymbols = sortedSymbolIndexes;
+	const pint_t*   cfiStarts     = cfiStartsArray;
+	const CFI_CU_InfoArrays* cfisPtr = &cfis;
+	std::vector<const char*> sectionExceptions(sectionsCount, nullptr);
+	const char** sectionExceptionsData = sectionExceptions.data();
+	std::vector<std::vector<std::string>> sectionWarnings(sectionsCount);
+	std::vector<std::string>* sectionWarningsData = sectionWarnings.data();
+	void (^forEachSection)(void (^)(uint32_t)) = ^(void (^handler)(uint32_t)) {
+		if ( parseSectionsConcurrently ) {
+			dispatch_apply(sectionsCount, DISPATCH_APPLY_AUTO, ^(size_t i) {
+				deferWarnings(&sectionWarningsData[i]);
+				try {
+					handler((uint32_t)i);
+				}
+				catch (const char* msg) {
+					sectionExceptionsData[i] = msg;
+				}
+				deferWarnings(NULL);
+			});
+			// report warnings and the first failure in section order, as the serial walk would have
+			for (uint32_t i=0; i < sectionsCount; ++i) {
+				for (const std::string& text : sectionWarningsData[i])
+					warning("%s", text.c_str());
+				sectionWarningsData[i].clear();
+				if ( sectionExceptionsData[i] != nullptr )
+					throw sectionExceptionsData[i];
+			}
+		}
+		else {
+			for (uint32_t i=0; i < sectionsCount; ++i)
+				handler(i);
+		}
+	};
+
 	// figure out how many atoms will be allocated and allocate
-	LabelAndCFIBreakIterator breakIterator(sortedSymbolIndexes, _symbolsInSections, cfiStartsArray, 
-											cfiStartsArrayCount, _overlappingSymbols);
-	uint32_t computedAtomCount = 0;
-	for (uint32_t i=0; i < sectionsCount; ++i ) {
+	// (the break iterator starts over for each section, so each section can use its own)
+	std::vector<uint32_t> sectionAtomCounts(sectionsCount, 0);
+	uint32_t* sectionAtomCountsData = sectionAtomCounts.data();
+	forEachSection(^(uint32_t i) {
+		LabelAndCFIBreakIterator breakIterator(sortedSymbols, parser->_symbolsInSections, cfiStarts,
+												cfiStartsArrayCount, parser->_overlappingSymbols);
 		breakIterator.beginSection();
-		uint32_t count = sections[i]->computeAtomCount(*this, breakIterator, cfis);
+		sectionAtomCountsData[i] = sections[i]->computeAtomCount(*parser, breakIterator, *cfisPtr);
 		//const macho_section<P>* sect = sections[i]->machoSection();
-		//fprintf(stderr, "computed count=%u for section %s size=%llu\n", count, sect->sectname(), (sect != NULL) ? sect->size() : 0);
-		computedAtomCount += count;
+		//fprintf(stderr, "computed count=%u for section %s size=%llu\n", sectionAtomCountsData[i], sect->sectname(), (sect != NULL) ? sect->size() : 0);
+	});
+	std::vector<uint32_t> sectionAtomStarts(sectionsCount, 0);
+	uint32_t computedAtomCount = 0;
+	for (uint32_t i=0; i < sectionsCount; ++i ) {
+		sectionAtomStarts[i] = computedAtomCount;
+		computedAtomCount += sectionAtomCounts[i];
 	}
 	//fprintf(stderr, "allocating %d atoms * sizeof(Atom<A>)=%ld, sizeof(ld::Atom)=%ld\n", computedAtomCount, sizeof(Atom<A>), sizeof(ld::Atom));
-	_file->_atomsArray = new uint8_t[computedAtomCount*sizeof(Atom<A>)];
+	_file->_atomsArray = (uint8_t*)_file->_arena.allocate(computedAtomCount*sizeof(Atom<A>), alignof(Atom<A>));
 	_file->_atomsArrayCount = 0;
 	
-	// have each section append atoms to _atomsArray
-	LabelAndCFIBreakIterator breakIterator2(sortedSymbolIndexes, _symbolsInSections, cfiStartsArray, 
-												cfiStartsArrayCount, _overlappingSymbols);
-	for (uint32_t i=0; i < sectionsCount; ++i ) {
-		uint8_t* atoms = _file->_atomsArray + _file->_atomsArrayCount*sizeof(Atom<A>);
+	// have each section append atoms to its slice of _atomsArray
+	const uint32_t* sectionAtomStartsData = sectionAtomStarts.data();
+	uint8_t* atomsArray = _file->_atomsArray;
+	forEachSection(^(uint32_t i) {
+		uint8_t* atoms = atomsArray + sectionAtomStartsData[i]*sizeof(Atom<A>);
+		LabelAndCFIBreakIterator breakIterator2(sortedSymbols, parser->_symbolsInSections, cfiStarts,
+												cfiStartsArrayCount, parser->_overlappingSymbols);
 		breakIterator2.beginSection();
-		uint32_t count = sections[i]->appendAtoms(*this, atoms, breakIterator2, cfis);
+		uint32_t count = sections[i]->appendAtoms(*parser, atoms, breakIterator2, *cfisPtr);
 		//fprintf(stderr, "append count=%u for section %s/%s\n", count, sections[i]->machoSection()->segname(), sections[i]->machoSection()->sectname());
-		_file->_atomsArrayCount += count;
-	}
-	assert( _file->_atomsArrayCount == computedAtomCount && "more atoms allocated than expected");
+		assert( count == sectionAtomCountsData[i] && "more atoms allocated than expected");
+	});
+	_file->_atomsArrayCount = computedAtomCount;
 
 	
 	// have each section add all fix-ups for its atoms
 	_allFixups.reserve(computedAtomCount*5);
-	for (uint32_t i=0; i < sectionsCount; ++i )
-		sections[i]->makeFixups(*this, cfis);
+	if ( parseSectionsConcurrently ) {
+		// each task adds fixups through its own copy of the parser, which differs only in its fixup list
+		std::vector<Parser<A>> sectionParsers(sectionsCount, *this);
+		Parser<A>* sectionParsersData = sectionParsers.data();
+		forEachSection(^(uint32_t i) {
+			sections[i]->makeFixups(sectionParsersData[i], *cfisPtr);
+		});
+		for (const Parser<A>& sectionParser : sectionParsers)
+			_allFixups.insert(_allFixups.end(), sectionParser._allFixups.begin(), sectionParser._allFixups.end());
+	}
+	else {
+		for (uint32_t i=0; i < sectionsCount; ++i )
+			sections[i]->makeFixups(*this, cfis);
+	}
+
+	// count fixups in each atom
+	for (FixupInAtom& fixup : _allFixups)
+		fixup.atom->incrementFixupCount();
 	
 	// assign fixups start offset for each atom
 	uint8_t* p = _file->_atomsArray;
@@ -2101,12 +2177,13 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 		p += sizeof(Atom<A>);
 	}
 	assert(fixupOffset == _allFixups.size());
-	_file->_fixups.resize(fixupOffset);
+	_file->_fixups = _file->_arena.template allocateArray<ld::Fixup>(fixupOffset);
+	_file->_fixupsArrayCount = fixupOffset;
 	
 	// copy each fixup for each atom 
 	for(typename std::vector<FixupInAtom>::iterator it=_allFixups.begin(); it != _allFixups.end(); ++it) {
 		uint32_t slot = it->atom->_fixupsStartIndex + it->atom->_fixupsCount;
-		_file->_fixups[slot] = it->fixup;
+		new (&_file->_fixups[slot]) ld::Fixup(it->fixup);
 		it->atom->_fixupsCount++;
 	}
 	
@@ -2164,7 +2241,7 @@ ld::relocatable::File* Parser<A>::parse(const ParserOptions& opts)
 	_file->_aliasAtomsArrayCount = 0;
 	if ( _indirectSymbolCount != 0 ) {
 		_file->_aliasAtomsArrayCount = _indirectSymbolCount;
-		_file->_aliasAtomsArray = new uint8_t[_file->_aliasAtomsArrayCount*sizeof(AliasAtom)];
+		_file->_aliasAtomsArray = (uint8_t*)_file->_arena.allocate(_file->_aliasAtomsArrayCount*sizeof(AliasAtom), alignof(AliasAtom));
 		this->appendAliasAtoms(_file->_aliasAtomsArray);
 	}
 	
@@ -2953,7 +3030,7 @@ void Parser<A>::makeSections()
 	}
 
 	// allocate one block for all Section objects as well as pointers to each
-	uint8_t* space = new uint8_t[totalSectionsSize+count*sizeof(Section<A>*)];
+	uint8_t* space = (uint8_t*)_file->_arena.allocate(totalSectionsSize+count*sizeof(Section<A>*));
 	_file->_sectionsArray = (Section<A>**)space;
 	_file->_sectionsArrayCount = count;
 	Section<A>** objects = _file->_sectionsArray;
@@ -4595,8 +4672,7 @@ bool Parser<A>::read_comp_unit(const char ** name, const char ** comp_dir,
 template <typename A>
 File<A>::~File()
 {
-	free(_sectionsArray);
-	free(_atomsArray);
+	// sections, atoms and fixups are released with _arena
 }
 
 template <typename A>
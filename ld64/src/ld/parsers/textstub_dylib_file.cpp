@@ -40,9 +40,9 @@ namespace textstub {
 namespace dylib {
 
 //
-// The reader for a dylib extracts all exported symbols names from the memory-mapped
-// dylib, builds a hash table, then unmaps the file.  This is an important memory
-// savings for large dylibs.
+// The reader for a text-stub dylib keeps the parsed interface and only builds the hash
+// table of exported symbol names on the first symbol lookup.  Most dylibs of an SDK
+// umbrella are loaded but never searched, or searched for a handful of symbols.
 //
 template <typename A>
 class File final : public generic::dylib::File
@@ -71,11 +71,15 @@ public:
 	// overrides of generic::dylib::File
 	virtual void	processIndirectLibraries(ld::dylib::File::DylibHandler*, bool addImplicitDylibs) override final;
 
+protected:
+	virtual void	loadExports() override final;
+
 private:
 	void				init(tapi::LinkerInterfaceFile* file, const Options *opts, bool buildingForSimulator,
 									 bool indirectDylib, bool linkingFlatNamespace, bool linkingMainExecutable,
 									 const char *path, const ld::VersionSet& platforms, const char *targetInstallPath,
 									 bool usingBitcode, bool internalSDK, bool fromSDK, bool platformMismatchesAreWarning);
+	void				addLinkerDirectiveExports(const tapi::LinkerInterfaceFile* file);
 	void				buildExportHashTable(const tapi::LinkerInterfaceFile* file);
 	static bool useSimulatorVariant();
 	
@@ -236,8 +240,19 @@ void File<A>::init(tapi::LinkerInterfaceFile* file, const Options *opts, bool bu
 		this->_importAtom = new generic::dylib::ImportAtom(*this, importNames);
 	}
 	
-	// build hash table
-	buildExportHashTable(file);
+	// $ld$ symbols can change the install name and compatibility version, so they are
+	// added now, the hash table of all other exports is built on the first lookup
+	addLinkerDirectiveExports(file);
+	this->_exportsPending = true;
+}
+
+template <typename A>
+void File<A>::addLinkerDirectiveExports(const tapi::LinkerInterfaceFile* file) {
+	for (const auto &sym : file->exports()) {
+		const char* name = sym.getName().c_str();
+		if ( strncmp(name, "$ld$", 4) == 0 )
+			addExportedSymbol(name, sym.isWeakDefined(), sym.isThreadLocalValue(), 0);
+	}
 }
 
 template <typename A>
@@ -245,14 +260,23 @@ void File<A>::buildExportHashTable(const tapi::LinkerInterfaceFile* file) {
 	if (this->_s_logHashtable )
 		fprintf(stderr, "ld: building hashtable from text-stub info in %s\n", this->path());
 
+	this->reservedSymbolSpace(file->exports().size());
 	for (const auto &sym : file->exports()) {
 		const char* name = sym.getName().c_str();
+		// already added by addLinkerDirectiveExports()
+		if ( strncmp(name, "$ld$", 4) == 0 )
+			continue;
 		bool weakDef = sym.isWeakDefined();
 		bool tlv = sym.isThreadLocalValue();
 		addExportedSymbol(name, weakDef, tlv, 0);
 	}
 }
 
+template <typename A>
+void File<A>::loadExports() {
+	buildExportHashTable(_interface);
+}
+
 template <typename A>
 void File<A>::processIndirectLibraries(ld::dylib::File::DylibHandler* handler, bool addImplicitDylibs) {
 	if (_interface)
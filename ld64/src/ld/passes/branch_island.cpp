@@ -28,9 +28,12 @@
 #include <unistd.h>
 #include <dlfcn.h>
 #include <libkern/OSByteOrder.h>
+#include <dispatch/dispatch.h>
+#include <mach/mach_time.h>
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include "MachOFileAbstraction.hpp"
 #include "ld.hpp"
@@ -406,53 +409,192 @@ static uint64_t maxDistanceBetweenIslands(const Options& opts, bool seenThumbBra
 //
 
 
-static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::Internal::FinalSection* textSection, size_t stubsSize)
+struct IslandStatistics {
+	unsigned int	islandCount;
+	unsigned int	regionCount;
+	unsigned int	outOfRangeBranchCount;
+};
+
+// An out of range branch found by the sweep over a code section.  Sites
+// are collected concurrently, then replayed in atom order so islands are
+// created, shared and named exactly as a serial scan would.
+struct BranchSite {
+	const ld::Atom*		atom;
+	ld::Fixup*			fixup;
+	ld::Fixup*			fixupWithTarget;
+	const ld::Atom*		target;
+	uint64_t			addend;
+	int64_t				srcAddr;
+	int64_t				dstAddr;
+	bool				crossSectionBranch;
+};
+
+// Per atom facts gathered by the first sweep
+enum { kAtomCanPrecedeIsland = 0x1, kAtomHasThumbBranch = 0x2, kAtomHasCrossSectionBranch = 0x4 };
+
+static const size_t kAtomsPerSweepChunk = 4096;
+
+
+// -preload side tables are read concurrently, so never use operator[] (which inserts) on them
+static unsigned sectionIndexOf(const ld::Atom* atom)
+{
+	std::map<const Atom*, unsigned>::const_iterator pos = sAtomToSectionIndex.find(atom);
+	return (pos != sAtomToSectionIndex.end()) ? pos->second : 0;
+}
+
+static uint64_t addressOf(const ld::Atom* atom)
+{
+	std::map<const Atom*, uint64_t>::const_iterator pos = sAtomToAddress.find(atom);
+	return (pos != sAtomToAddress.end()) ? pos->second : 0;
+}
+
+// returns true if the fixup names the target of its cluster
+static bool fixupTarget(const ld::Internal& state, const ld::Fixup* fit, const ld::Atom*& target)
+{
+	switch ( fit->binding ) {
+		case ld::Fixup::bindingNone:
+		case ld::Fixup::bindingByNameUnbound:
+			break;
+		case ld::Fixup::bindingByContentBound:
+		case ld::Fixup::bindingDirectlyBound:
+			target = fit->u.target;
+			return true;
+		case ld::Fixup::bindingsIndirectlyBound:
+			target = state.indirectBindingTable[fit->u.bindingIndex];
+			return true;
+	}
+	return false;
+}
+
+static bool isStubSection(const ld::Section& sect)
+{
+	return (sect.type() == ld::Section::typeStub) || (sect.type() == ld::Section::typeStubObjC);
+}
+
+// check for thumb branches, cross section branches and follow-on constraints of one atom
+static uint8_t atomFlags(const ld::Internal& state, const ld::Atom* atom, bool preload)
+{
+	uint8_t flags = kAtomCanPrecedeIsland;
+	const ld::Atom* target = NULL;
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		if ( fit->firstInCluster() ) {
+			target = NULL;
+		}
+		fixupTarget(state, fit, target);
+		bool haveBranch = false;
+		switch (fit->kind) {
+			case ld::Fixup::kindNoneFollowOn:
+				flags &= ~kAtomCanPrecedeIsland;
+				break;
+			case ld::Fixup::kindStoreThumbBranch22:
+			case ld::Fixup::kindStoreTargetAddressThumbBranch22:
+				flags |= kAtomHasThumbBranch;
+				// fall into arm branch case
+				[[clang::fallthrough]];
+			case ld::Fixup::kindStoreARMBranch24:
+			case ld::Fixup::kindStoreTargetAddressARMBranch24:
+				haveBranch = true;
+				break;
+			default:
+				break;
+		}
+		if ( haveBranch && !isStubSection(target->section()) ) {
+			// <rdar://problem/14792124> haveCrossSectionBranches only applies to -preload builds
+			if ( preload && (sectionIndexOf(atom) != sectionIndexOf(target)) )
+				flags |= kAtomHasCrossSectionBranch;
+		}
+	}
+	return flags;
+}
+
+// append the branches of one atom that cannot reach their target directly
+static void findOutOfRangeBranches(const ld::Internal& state, const ld::Atom* atom, bool preload, uint64_t totalTextSize,
+								   int64_t branchLimit, std::vector<BranchSite>& sites)
+{
+	const ld::Atom* target = NULL;
+	uint64_t addend = 0;
+	ld::Fixup* fixupWithTarget = NULL;
+	for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
+		if ( fit->firstInCluster() ) {
+			target = NULL;
+			fixupWithTarget = NULL;
+			addend = 0;
+		}
+		if ( fixupTarget(state, fit, target) )
+			fixupWithTarget = fit;
+		bool haveBranch = false;
+		switch (fit->kind) {
+			case ld::Fixup::kindAddAddend:
+				addend = fit->u.addend;
+				break;
+			case ld::Fixup::kindStoreARMBranch24:
+			case ld::Fixup::kindStoreThumbBranch22:
+			case ld::Fixup::kindStoreTargetAddressARMBranch24:
+			case ld::Fixup::kindStoreTargetAddressThumbBranch22:
+#if SUPPORT_ARCH_arm64 || SUPPORT_ARCH_arm64_32
+			case ld::Fixup::kindStoreARM64Branch26:
+			case ld::Fixup::kindStoreTargetAddressARM64Branch26:
+#endif
+				haveBranch = true;
+				break;
+			default:
+				break;
+		}
+		if ( !haveBranch )
+			continue;
+		BranchSite site;
+		site.atom				= atom;
+		site.fixup				= fit;
+		site.fixupWithTarget	= fixupWithTarget;
+		site.target				= target;
+		site.addend				= addend;
+		site.crossSectionBranch = ( preload && (sectionIndexOf(atom) != sectionIndexOf(target)) );
+		site.srcAddr			= atom->sectionOffset() + fit->offsetInAtom;
+		site.dstAddr			= target->sectionOffset() + addend;
+		if ( preload ) {
+			site.srcAddr = addressOf(atom) + fit->offsetInAtom;
+			site.dstAddr = addressOf(target) + addend;
+		}
+		if ( isStubSection(target->section()) )
+			site.dstAddr = totalTextSize;
+		int64_t displacement = site.dstAddr - site.srcAddr;
+		if ( (displacement > branchLimit) || (displacement < (-branchLimit)) )
+			sites.push_back(site);
+	}
+}
+
+
+static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::Internal::FinalSection* textSection, size_t stubsSize,
+								  IslandStatistics& stats)
 {
-	// assign section offsets to each atom in __text section, watch for thumb branches, and find total size
+	const bool preload = (opts.outputKind() == Options::kPreload);
+	std::vector<const ld::Atom*>& atoms = textSection->atoms;
+	const ld::Atom* const* atomsArray = atoms.data();
+	const size_t atomCount = atoms.size();
+	const size_t chunkCount = (atomCount + kAtomsPerSweepChunk - 1) / kAtomsPerSweepChunk;
+	const ld::Internal* statePtr = &state;
+
+	// watch for thumb branches, cross section branches and follow-on atoms
+	std::vector<uint8_t> flags(atomCount);
+	uint8_t* flagsArray = flags.data();
+	dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunkIndex) {
+		const size_t start = chunkIndex * kAtomsPerSweepChunk;
+		const size_t end = std::min(start + kAtomsPerSweepChunk, atomCount);
+		for (size_t i=start; i < end; ++i)
+			flagsArray[i] = atomFlags(*statePtr, atomsArray[i], preload);
+	});
 	bool hasThumbBranches = false;
 	bool haveCrossSectionBranches = false;
-	const bool preload = (opts.outputKind() == Options::kPreload);
+	for (uint8_t atomFlag : flags) {
+		if ( atomFlag & kAtomHasThumbBranch )
+			hasThumbBranches = true;
+		if ( atomFlag & kAtomHasCrossSectionBranch )
+			haveCrossSectionBranches = true;
+	}
+
+	// assign section offsets to each atom in __text section and find total size
 	uint64_t offset = 0;
-	for (std::vector<const ld::Atom*>::iterator ait=textSection->atoms.begin();  ait != textSection->atoms.end(); ++ait) {
-		const ld::Atom* atom = *ait;
-		// check for thumb branches and cross section branches
-		const ld::Atom* target = NULL;
-		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-			if ( fit->firstInCluster() ) {
-				target = NULL;
-			}
-			switch ( fit->binding ) {
-				case ld::Fixup::bindingNone:
-				case ld::Fixup::bindingByNameUnbound:
-					break;
-				case ld::Fixup::bindingByContentBound:
-				case ld::Fixup::bindingDirectlyBound:
-					target = fit->u.target;
-					break;
-				case ld::Fixup::bindingsIndirectlyBound:
-					target = state.indirectBindingTable[fit->u.bindingIndex];
-					break;
-			}
-			bool haveBranch = false;
-			switch (fit->kind) {
-				case ld::Fixup::kindStoreThumbBranch22:
-				case ld::Fixup::kindStoreTargetAddressThumbBranch22:
-					hasThumbBranches = true;
-					// fall into arm branch case
-					[[clang::fallthrough]];
-				case ld::Fixup::kindStoreARMBranch24:
-				case ld::Fixup::kindStoreTargetAddressARMBranch24:
-					haveBranch = true;
-					break;
-                default:
-                    break;   
-			}
-			if ( haveBranch && (target->section().type() != ld::Section::typeStub) && (target->section().type() != ld::Section::typeStubObjC) ) {
-				// <rdar://problem/14792124> haveCrossSectionBranches only applies to -preload builds
-				if ( preload && (sAtomToSectionIndex[atom] != sAtomToSectionIndex[target]) )
-					haveCrossSectionBranches = true;
-			}
-		}
+	for (const ld::Atom* atom : atoms) {
 		// align atom
 		ld::Atom::Alignment atomAlign = atom->alignment();
 		uint64_t atomAlignP2 = (1 << atomAlign.powerOf2);
@@ -461,7 +603,7 @@ static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::
 			if ( atomAlign.modulus > currentModulus )
 				offset += atomAlign.modulus-currentModulus;
 			else
-				offset += atomAlign.modulus+atomAlignP2-currentModulus;		
+				offset += atomAlign.modulus+atomAlignP2-currentModulus;
 		}
 		(const_cast<ld::Atom*>(atom))->setSectionOffset(offset);
 		offset += atom->size();
@@ -470,7 +612,7 @@ static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::
 	if ( (totalTextSize < textSizeWhenMightNeedBranchIslands(opts, hasThumbBranches)) && !haveCrossSectionBranches )
 		return;
 	if (_s_log) fprintf(stderr, "ld: section %s size=%llu, might need branch islands\n", textSection->sectionName(), totalTextSize);
-	
+
 	// Figure out how many regions of branch islands will be needed, and their locations.
 	// Construct a vector containing the atoms after which branch islands will be inserted,
 	// taking into account follow on fixups. No atom run without an island can exceed kBetweenRegions.
@@ -479,8 +621,8 @@ static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::
 	uint64_t previousIslandEndAddr = 0;
 	const ld::Atom *insertionPoint = NULL;
 	branchIslandInsertionPoints.reserve(totalTextSize/kBetweenRegions*2);
-	for (std::vector<const ld::Atom*>::iterator it=textSection->atoms.begin(); it != textSection->atoms.end(); it++) {
-		const ld::Atom* atom = *it;
+	for (size_t i=0; i < atomCount; ++i) {
+		const ld::Atom* atom = atomsArray[i];
 		// if we move past the next atom, will the run length exceed kBetweenRegions?
 		if ( atom->sectionOffset() + atom->size() > previousIslandEndAddr + kBetweenRegions ) {
 			// yes. Add the last known good location (atom) for inserting a branch island.
@@ -491,159 +633,122 @@ static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::
 			insertionPoint = NULL;
 		}
 		// Can we insert an island after this atom? If so then keep track of it.
-		if ( !atom->hasFixupsOfKind(ld::Fixup::kindNoneFollowOn) )
+		if ( flagsArray[i] & kAtomCanPrecedeIsland )
 			insertionPoint = atom;
 	}
 	// add one more island after the last atom if close to limit
 	if ( (insertionPoint != NULL) && (insertionPoint->sectionOffset() + insertionPoint->size() > previousIslandEndAddr + (kBetweenRegions-0x100000)) )
 		branchIslandInsertionPoints.push_back(insertionPoint);
 	if ( haveCrossSectionBranches && branchIslandInsertionPoints.empty() ) {
-		branchIslandInsertionPoints.push_back(textSection->atoms.back());
+		branchIslandInsertionPoints.push_back(atoms.back());
 	}
 	const int kIslandRegionsCount = branchIslandInsertionPoints.size();
 
 	if (_s_log) fprintf(stderr, "ld: will use %u branch island regions\n", kIslandRegionsCount);
 	typedef std::map<TargetAndOffset,const ld::Atom*, TargetAndOffsetComparor> AtomToIsland;
-    AtomToIsland* regionsMap[kIslandRegionsCount];
-	uint64_t regionAddresses[kIslandRegionsCount];
-	std::vector<const ld::Atom*>* regionsIslands[kIslandRegionsCount];
+	std::vector<AtomToIsland> regionsMap(kIslandRegionsCount);
+	std::vector<uint64_t> regionAddresses(kIslandRegionsCount);
+	std::vector<std::vector<const ld::Atom*>> regionsIslands(kIslandRegionsCount);
 	for(int i=0; i < kIslandRegionsCount; ++i) {
-		regionsMap[i] = new AtomToIsland();
-		regionsIslands[i] = new std::vector<const ld::Atom*>();
 		regionAddresses[i] = branchIslandInsertionPoints[i]->sectionOffset() + branchIslandInsertionPoints[i]->size();
 		if (_s_log) fprintf(stderr, "ld: branch islands will be inserted at 0x%08llX after %s\n", regionAddresses[i], branchIslandInsertionPoints[i]->name());
 	}
 	unsigned int islandCount = 0;
-	
-	// create islands for branches in __text that are out of range
-	for (std::vector<const ld::Atom*>::iterator ait=textSection->atoms.begin(); ait != textSection->atoms.end(); ++ait) {
-		const ld::Atom* atom = *ait;
-		const ld::Atom* target = NULL;
-		uint64_t addend = 0;
-		ld::Fixup* fixupWithTarget = NULL;
-		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
-			if ( fit->firstInCluster() ) {
-				target = NULL;
-				fixupWithTarget = NULL;
-				addend = 0;
-			}
-			switch ( fit->binding ) {
-				case ld::Fixup::bindingNone:
-				case ld::Fixup::bindingByNameUnbound:
-					break;
-				case ld::Fixup::bindingByContentBound:
-				case ld::Fixup::bindingDirectlyBound:
-					target = fit->u.target;
-					fixupWithTarget = fit;
-					break;
-				case ld::Fixup::bindingsIndirectlyBound:
-					target = state.indirectBindingTable[fit->u.bindingIndex];
-					fixupWithTarget = fit;
-					break;
-			}
-			bool haveBranch = false;
-			switch (fit->kind) {
-				case ld::Fixup::kindAddAddend:
-					addend = fit->u.addend;
-					break;
-				case ld::Fixup::kindStoreARMBranch24:
-				case ld::Fixup::kindStoreThumbBranch22:
-				case ld::Fixup::kindStoreTargetAddressARMBranch24:
-				case ld::Fixup::kindStoreTargetAddressThumbBranch22:
-#if SUPPORT_ARCH_arm64 || SUPPORT_ARCH_arm64_32
-				case ld::Fixup::kindStoreARM64Branch26:
-				case ld::Fixup::kindStoreTargetAddressARM64Branch26:
-#endif
-					haveBranch = true;
-					break;
-                default:
-                    break;   
-			}
-			if ( haveBranch ) {
-				bool crossSectionBranch = ( preload && (sAtomToSectionIndex[atom] != sAtomToSectionIndex[target]) );
-				int64_t srcAddr = atom->sectionOffset() + fit->offsetInAtom;
-				int64_t dstAddr = target->sectionOffset() + addend;
-				if ( preload ) {
-					srcAddr = sAtomToAddress[atom] + fit->offsetInAtom;
-					dstAddr = sAtomToAddress[target] + addend;
+
+	// find branches in __text that are out of range, each chunk of atoms concurrently
+	const int64_t kBranchLimit = kBetweenRegions;
+	std::vector<std::vector<BranchSite>> chunkSites(chunkCount);
+	std::vector<BranchSite>* chunkSitesArray = chunkSites.data();
+	dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunkIndex) {
+		const size_t start = chunkIndex * kAtomsPerSweepChunk;
+		const size_t end = std::min(start + kAtomsPerSweepChunk, atomCount);
+		for (size_t i=start; i < end; ++i)
+			findOutOfRangeBranches(*statePtr, atomsArray[i], preload, totalTextSize, kBranchLimit, chunkSitesArray[chunkIndex]);
+	});
+
+	// create islands for out of range branches in atom order, sharing islands between branches to the same target
+	for (const std::vector<BranchSite>& sites : chunkSites) {
+		for (const BranchSite& site : sites) {
+			const ld::Atom* atom = site.atom;
+			const ld::Atom* target = site.target;
+			ld::Fixup* fit = site.fixup;
+			ld::Fixup* fixupWithTarget = site.fixupWithTarget;
+			int64_t srcAddr = site.srcAddr;
+			int64_t dstAddr = site.dstAddr;
+			int64_t displacement = dstAddr - srcAddr;
+			TargetAndOffset finalTargetAndOffset = { target, (uint32_t)site.addend };
+			++stats.outOfRangeBranchCount;
+			if ( site.crossSectionBranch ) {
+				const ld::Atom* island;
+				AtomToIsland& region = regionsMap[0];
+				AtomToIsland::iterator pos = region.find(finalTargetAndOffset);
+				if ( pos == region.end() ) {
+					island = makeBranchIsland(opts, fit->kind, 0, target, finalTargetAndOffset, atom->section(), true);
+					region[finalTargetAndOffset] = island;
+					if (_s_log) fprintf(stderr, "added absolute branching island %p %s, displacement=%lld\n",
+											island, island->name(), displacement);
+					++islandCount;
+					regionsIslands[0].push_back(island);
 				}
-				if ( (target->section().type() == ld::Section::typeStub) || (target->section().type() == ld::Section::typeStubObjC) )
-					dstAddr = totalTextSize;
-				int64_t displacement = dstAddr - srcAddr;
-				TargetAndOffset finalTargetAndOffset = { target, (uint32_t)addend };
-				const int64_t kBranchLimit = kBetweenRegions;
-				if ( crossSectionBranch && ((displacement > kBranchLimit) || (displacement < (-kBranchLimit))) ) {
-					const ld::Atom* island;
-					AtomToIsland* region = regionsMap[0];
-					AtomToIsland::iterator pos = region->find(finalTargetAndOffset);
-					if ( pos == region->end() ) {
-						island = makeBranchIsland(opts, fit->kind, 0, target, finalTargetAndOffset, atom->section(), true);
-						(*region)[finalTargetAndOffset] = island;
-						if (_s_log) fprintf(stderr, "added absolute branching island %p %s, displacement=%lld\n", 
-												island, island->name(), displacement);
-						++islandCount;
-						regionsIslands[0]->push_back(island);
-					}
-					else {
-						island = pos->second;
-					}
-					if (_s_log) fprintf(stderr, "using island %p %s for branch to %s from %s\n", island, island->name(), target->name(), atom->name());
-					fixupWithTarget->u.target = island;
-					fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
+				else {
+					island = pos->second;
 				}
-				else if ( displacement > kBranchLimit ) {
-					// create forward branch chain
-					const ld::Atom* nextTarget = target;
-					if (_s_log) fprintf(stderr, "need forward branching island srcAdr=0x%08llX, dstAdr=0x%08llX, target=%s\n",
-														srcAddr, dstAddr, target->name());
-					for (int i=kIslandRegionsCount-1; i >=0 ; --i) {
-						AtomToIsland* region = regionsMap[i];
-						int64_t islandRegionAddr = regionAddresses[i];
-						if ( (srcAddr < islandRegionAddr) && ((islandRegionAddr <= dstAddr)) ) { 
-							AtomToIsland::iterator pos = region->find(finalTargetAndOffset);
-							if ( pos == region->end() ) {
-								ld::Atom* island = makeBranchIsland(opts, fit->kind, i, nextTarget, finalTargetAndOffset, atom->section(), false);
-								(*region)[finalTargetAndOffset] = island;
-								if (_s_log) fprintf(stderr, "added forward branching island %p %s to region %d for %s\n", island, island->name(), i, atom->name());
-								regionsIslands[i]->push_back(island);
-								++islandCount;
-								nextTarget = island;
-							}
-							else {
-								nextTarget = pos->second;
-							}
+				if (_s_log) fprintf(stderr, "using island %p %s for branch to %s from %s\n", island, island->name(), target->name(), atom->name());
+				fixupWithTarget->u.target = island;
+				fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
+			}
+			else if ( displacement > kBranchLimit ) {
+				// create forward branch chain
+				const ld::Atom* nextTarget = target;
+				if (_s_log) fprintf(stderr, "need forward branching island srcAdr=0x%08llX, dstAdr=0x%08llX, target=%s\n",
+													srcAddr, dstAddr, target->name());
+				for (int i=kIslandRegionsCount-1; i >=0 ; --i) {
+					AtomToIsland& region = regionsMap[i];
+					int64_t islandRegionAddr = regionAddresses[i];
+					if ( (srcAddr < islandRegionAddr) && ((islandRegionAddr <= dstAddr)) ) {
+						AtomToIsland::iterator pos = region.find(finalTargetAndOffset);
+						if ( pos == region.end() ) {
+							ld::Atom* island = makeBranchIsland(opts, fit->kind, i, nextTarget, finalTargetAndOffset, atom->section(), false);
+							region[finalTargetAndOffset] = island;
+							if (_s_log) fprintf(stderr, "added forward branching island %p %s to region %d for %s\n", island, island->name(), i, atom->name());
+							regionsIslands[i].push_back(island);
+							++islandCount;
+							nextTarget = island;
+						}
+						else {
+							nextTarget = pos->second;
 						}
 					}
-					if (_s_log) fprintf(stderr, "using island %p %s for branch to %s from %s\n", nextTarget, nextTarget->name(), target->name(), atom->name());
-					fixupWithTarget->u.target = nextTarget;
-					fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
 				}
-				else if ( displacement < (-kBranchLimit) ) {
-					// create back branching chain
-					const ld::Atom* prevTarget = target;
-					for (int i=0; i < kIslandRegionsCount ; ++i) {
-						AtomToIsland* region = regionsMap[i];
-						int64_t islandRegionAddr = regionAddresses[i];
-						if ( (dstAddr < islandRegionAddr) && (islandRegionAddr <= srcAddr) ) {
-							if (_s_log) fprintf(stderr, "need backward branching island srcAdr=0x%08llX, dstAdr=0x%08llX, target=%s\n", srcAddr, dstAddr, target->name());
-							AtomToIsland::iterator pos = region->find(finalTargetAndOffset);
-							if ( pos == region->end() ) {
-								ld::Atom* island = makeBranchIsland(opts, fit->kind, i, prevTarget, finalTargetAndOffset, atom->section(), false);
-								(*region)[finalTargetAndOffset] = island;
-								if (_s_log) fprintf(stderr, "added back branching island %p %s to region %d for %s\n", island, island->name(), i, atom->name());
-								regionsIslands[i]->push_back(island);
-								++islandCount;
-								prevTarget = island;
-							}
-							else {
-								prevTarget = pos->second;
-							}
+				if (_s_log) fprintf(stderr, "using island %p %s for branch to %s from %s\n", nextTarget, nextTarget->name(), target->name(), atom->name());
+				fixupWithTarget->u.target = nextTarget;
+				fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
+			}
+			else {
+				// create back branching chain
+				const ld::Atom* prevTarget = target;
+				for (int i=0; i < kIslandRegionsCount ; ++i) {
+					AtomToIsland& region = regionsMap[i];
+					int64_t islandRegionAddr = regionAddresses[i];
+					if ( (dstAddr < islandRegionAddr) && (islandRegionAddr <= srcAddr) ) {
+						if (_s_log) fprintf(stderr, "need backward branching island srcAdr=0x%08llX, dstAdr=0x%08llX, target=%s\n", srcAddr, dstAddr, target->name());
+						AtomToIsland::iterator pos = region.find(finalTargetAndOffset);
+						if ( pos == region.end() ) {
+							ld::Atom* island = makeBranchIsland(opts, fit->kind, i, prevTarget, finalTargetAndOffset, atom->section(), false);
+							region[finalTargetAndOffset] = island;
+							if (_s_log) fprintf(stderr, "added back branching island %p %s to region %d for %s\n", island, island->name(), i, atom->name());
+							regionsIslands[i].push_back(island);
+							++islandCount;
+							prevTarget = island;
+						}
+						else {
+							prevTarget = pos->second;
 						}
 					}
-					if (_s_log) fprintf(stderr, "using back island %p %s for %s\n", prevTarget, prevTarget->name(), atom->name());
-					fixupWithTarget->u.target = prevTarget;
-					fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
 				}
+				if (_s_log) fprintf(stderr, "using back island %p %s for %s\n", prevTarget, prevTarget->name(), atom->name());
+				fixupWithTarget->u.target = prevTarget;
+				fixupWithTarget->binding = ld::Fixup::bindingDirectlyBound;
 			}
 		}
 	}
@@ -652,27 +757,26 @@ static void makeIslandsForSection(const Options& opts, ld::Internal& state, ld::
 	// insert islands into __text section and adjust section offsets
 	if ( islandCount > 0 ) {
 		if ( _s_log ) fprintf(stderr, "ld: %u branch islands required in %u regions\n", islandCount, kIslandRegionsCount);
+		stats.islandCount += islandCount;
+		stats.regionCount += kIslandRegionsCount;
 		std::vector<const ld::Atom*> newAtomList;
-		newAtomList.reserve(textSection->atoms.size()+islandCount);
-		
+		newAtomList.reserve(atoms.size()+islandCount);
+
 		int regionIndex = 0;
-		for (std::vector<const ld::Atom*>::iterator ait=textSection->atoms.begin(); ait != textSection->atoms.end(); ait++) {
-			const ld::Atom* atom = *ait;
+		for (const ld::Atom* atom : atoms) {
 			newAtomList.push_back(atom);
 			if ( (regionIndex < kIslandRegionsCount) && (atom == branchIslandInsertionPoints[regionIndex]) ) {
-				std::vector<const ld::Atom*>* islands = regionsIslands[regionIndex];
-				newAtomList.insert(newAtomList.end(), islands->begin(), islands->end());
+				const std::vector<const ld::Atom*>& islands = regionsIslands[regionIndex];
+				newAtomList.insert(newAtomList.end(), islands.begin(), islands.end());
 				++regionIndex;
 			}
 		}
 		// swap in new list of atoms for __text section
-		textSection->atoms.clear();
-		textSection->atoms = newAtomList;
+		atoms.swap(newAtomList);
 	}
 
 }
 
-
 static void buildAddressMap(const Options& opts, ld::Internal& state) {
 	// Assign addresses to sections
 	state.setSectionSizesAndAlignments();
@@ -754,9 +858,18 @@ void doPass(const Options& opts, ld::Internal& state)
 	}
 
 	// scan sections and add island to each code section
+	IslandStatistics stats = { 0, 0, 0 };
+	uint64_t startTime = mach_absolute_time();
 	for (ld::Internal::FinalSection* sect : state.sections) {
 		if ( sect->type() == ld::Section::typeCode )
-			makeIslandsForSection(opts, state, sect, stubsSize);
+			makeIslandsForSection(opts, state, sect, stubsSize, stats);
+	}
+	if ( opts.printStatistics() && (stats.outOfRangeBranchCount != 0) ) {
+		mach_timebase_info_data_t timebaseInfo;
+		mach_timebase_info(&timebaseInfo);
+		double milliseconds = (double)(mach_absolute_time() - startTime) * timebaseInfo.numer / timebaseInfo.denom / 1000000.0;
+		fprintf(stderr, "branch islands: %u islands in %u regions for %u out of range branches, placed in %.2fms\n",
+				stats.islandCount, stats.regionCount, stats.outOfRangeBranchCount, milliseconds);
 	}
 }
 
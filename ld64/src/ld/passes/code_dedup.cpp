@@ -24,6 +24,7 @@
 
 
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <unistd.h>
 #include <dlfcn.h>
@@ -74,29 +75,39 @@ private:
 
 
 namespace {
-    typedef std::unordered_map<const ld::Atom*, unsigned long> CachedHashes;
+    typedef std::unordered_map<const ld::Atom*, uint64_t> CachedHashes;
 
     ld::Internal*   sState = nullptr;
-    CachedHashes    sSavedHashes;
-    unsigned long   sHashCount = 0;
-    unsigned long   sFixupCompareCount = 0;
+    CachedHashes    sSavedHashes;       // filled in before functions are compared, read only after that
 };
 
 
-// A helper for std::unordered_map<> that hashes the instructions of a function
+// Hashes the instructions of a function and the names of what it references
 struct atom_hashing {
 
-    static unsigned long hash(const ld::Atom* atom) {
-        auto pos = sSavedHashes.find(atom);
-        if ( pos != sSavedHashes.end() )
-            return pos->second;
-
-        const unsigned instructionBytes = atom->size();
-        const uint8_t*	instructions = atom->rawContentPointer();
-        unsigned long hash = instructionBytes;
-        for (unsigned i=0; i < instructionBytes; ++i) {
-            hash = (hash * 33) + instructions[i];
+    // mixes in eight bytes at a time instead of one
+    static uint64_t hashBytes(uint64_t hash, const uint8_t* bytes, size_t length) {
+        const uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+        size_t i = 0;
+        for (; i+8 <= length; i += 8) {
+            uint64_t word;
+            memcpy(&word, &bytes[i], 8);
+            hash = (hash ^ word) * kMultiplier;
+            hash ^= (hash >> 29);
         }
+        uint64_t tail = length - i;
+        if ( i != length )
+            memcpy(&tail, &bytes[i], length - i);
+        hash = (hash ^ tail) * kMultiplier;
+        return hash ^ (hash >> 32);
+    }
+
+    static uint64_t computeHash(const ld::Atom* atom) {
+        const uint64_t instructionBytes = atom->size();
+        const uint8_t* instructions = atom->rawContentPointer();
+        uint64_t hash = instructionBytes;
+        if ( instructions != NULL )
+            hash = hashBytes(hash, instructions, instructionBytes);
 		for (ld::Fixup::iterator fit = atom->fixupsBegin(), end=atom->fixupsEnd(); fit != end; ++fit) {
             const Atom* target = NULL;
             switch ( fit->binding ) {
@@ -125,22 +136,23 @@ struct atom_hashing {
                 const char* name = target->name();
                 if ( target->contentType() == ld::Atom::typeCString )
                     name = (const char*)target->rawContentPointer();
-                for (const char* s = name; *s != '\0'; ++s)
-                    hash = (hash * 33) + *s;
+                hash = hashBytes(hash, (const uint8_t*)name, strlen(name));
             }
         }
-        ++sHashCount;
-        sSavedHashes[atom] = hash;
         return hash;
     }
 
-    unsigned long operator()(const ld::Atom* atom) const {
-        return hash(atom);
+    static uint64_t hash(const ld::Atom* atom) {
+        auto pos = sSavedHashes.find(atom);
+        if ( pos != sSavedHashes.end() )
+            return pos->second;
+        // not in __text, so not worth caching
+        return computeHash(atom);
     }
 };
 
 
-// A helper for std::unordered_map<> that compares functions
+// Compares functions, including the functions they call
 struct atom_equal {
 
     struct BackChain {
@@ -158,7 +170,6 @@ struct atom_equal {
     };
 
     static bool sameFixups(const ld::Atom* atom1, const ld::Atom* atom2, BackChain& backChain) {
-        ++sFixupCompareCount;
         //fprintf(stderr, "sameFixups(%s,%s)\n", atom1->name(), atom2->name());
         Fixup::iterator	f1   = atom1->fixupsBegin();
         Fixup::iterator	end1 = atom1->fixupsEnd();
@@ -279,51 +290,104 @@ void doPass(const Options& opts, ld::Internal& state)
     if ( textSection == NULL )
         return;
 
-    // build map of auto-hide functions and their duplicates
-    // the key for the map is always the first element in the value vector
-    // the key is always earlier in the atoms list then matching other atoms
+    // hash every function in __text once, in parallel.  Calls are compared by comparing the called
+    // functions, so all of __text is hashed and not just the auto-hide functions that can be removed.
     sState = &state;
-    std::unordered_map<const ld::Atom*, std::vector<const ld::Atom*>, atom_hashing, atom_equal> map;
-    std::unordered_set<const ld::Atom*> masterAtoms;
-    for (const ld::Atom* atom : textSection->atoms) {
+    std::vector<const ld::Atom*>& textAtoms = textSection->atoms;
+    const ld::Atom* const* textAtomArray = textAtoms.data();
+    std::vector<uint64_t> hashes(textAtoms.size());
+    uint64_t* hashArray = hashes.data();
+    dispatch_apply(textAtoms.size(), DISPATCH_APPLY_AUTO, ^(size_t index) {
+        hashArray[index] = atom_hashing::computeHash(textAtomArray[index]);
+    });
+    sSavedHashes.reserve(textAtoms.size());
+    for (size_t i=0; i < textAtoms.size(); ++i)
+        sSavedHashes[textAtoms[i]] = hashes[i];
+
+    // partition auto-hide functions into buckets with the same hash and size, in __text order within a bucket
+    struct Candidate { uint64_t hash; uint64_t size; uint32_t index; };
+    std::vector<Candidate> candidates;
+    for (uint32_t i=0; i < textAtoms.size(); ++i) {
+        const ld::Atom* atom = textAtoms[i];
         // ignore empty (alias) atoms
         if ( atom->size() == 0 )
             continue;
         if ( atom->autoHide() )
-            map[atom].push_back(atom);
-	  }
+            candidates.push_back({ hashes[i], atom->size(), i });
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+        if ( lhs.hash != rhs.hash )
+            return lhs.hash < rhs.hash;
+        if ( lhs.size != rhs.size )
+            return lhs.size < rhs.size;
+        return lhs.index < rhs.index;
+    });
+    std::vector<std::pair<size_t, size_t>> buckets;
+    for (size_t start=0, end; start < candidates.size(); start = end) {
+        for (end=start+1; end < candidates.size(); ++end) {
+            if ( (candidates[end].hash != candidates[start].hash) || (candidates[end].size != candidates[start].size) )
+                break;
+        }
+        if ( end - start > 1 )
+            buckets.push_back({ start, end });
+    }
 
-    if ( log ) {
-        for (auto& entry : map) {
-            if ( entry.second.size() > 1 ) {
-                printf("Found following matching functions:\n");
-                for (const ld::Atom* atom : entry.second) {
-                    printf("  %p %s\n", atom, atom->name());
+    // in each bucket, a function is a duplicate of the first earlier function it is equal to.
+    // Buckets are independent and comparing only reads atoms and hashes, so compare buckets in parallel.
+    struct DuplicateSet { uint32_t keptIndex; std::vector<const ld::Atom*> atoms; };   // first atom is the one kept
+    std::vector<std::vector<DuplicateSet>> bucketSets(buckets.size());
+    std::vector<DuplicateSet>* bucketSetsArray = bucketSets.data();
+    const Candidate* candidateArray = candidates.data();
+    const std::pair<size_t, size_t>* bucketArray = buckets.data();
+    dispatch_apply(buckets.size(), DISPATCH_APPLY_AUTO, ^(size_t bucketIndex) {
+        std::vector<DuplicateSet>& sets = bucketSetsArray[bucketIndex];
+        for (size_t i=bucketArray[bucketIndex].first; i < bucketArray[bucketIndex].second; ++i) {
+            const ld::Atom* atom = textAtomArray[candidateArray[i].index];
+            bool found = false;
+            for (DuplicateSet& set : sets) {
+                if ( atom_equal()(set.atoms.front(), atom) ) {
+                    set.atoms.push_back(atom);
+                    found = true;
+                    break;
                 }
             }
+            if ( !found )
+                sets.push_back({ candidateArray[i].index, { atom } });
+        }
+    });
+
+    // visit duplicate sets in __text order of the function kept, so output does not depend on hash values
+    std::vector<DuplicateSet*> duplicateSets;
+    for (std::vector<DuplicateSet>& sets : bucketSets) {
+        for (DuplicateSet& set : sets) {
+            if ( set.atoms.size() > 1 )
+                duplicateSets.push_back(&set);
+        }
+    }
+    std::sort(duplicateSets.begin(), duplicateSets.end(), [](const DuplicateSet* lhs, const DuplicateSet* rhs) {
+        return lhs->keptIndex < rhs->keptIndex;
+    });
+
+    if ( log ) {
+        for (const DuplicateSet* set : duplicateSets) {
+            printf("Found following matching functions:\n");
+            for (const ld::Atom* atom : set->atoms) {
+                printf("  %p %s\n", atom, atom->name());
+            }
         }
-        fprintf(stderr, "duplicate sets count:\n");
-        for (auto& entry : map)
-            fprintf(stderr, "  %p -> %lu\n", entry.first, entry.second.size());
     }
 
     // construct alias atoms to replace atoms found to be duplicates
-    unsigned atomsBeingComparedCount = 0;
     uint64_t dedupSavings = 0;
-    std::vector<const ld::Atom*>& textAtoms = textSection->atoms;
     std::unordered_map<const ld::Atom*, const ld::Atom*> replacementMap;
-    for (auto& entry : map) {
-        const ld::Atom* masterAtom = entry.first;
-        std::vector<const ld::Atom*>& dups = entry.second;
-        atomsBeingComparedCount += dups.size();
-        if ( dups.size() == 1 )
-            continue;
+    for (const DuplicateSet* set : duplicateSets) {
+        const ld::Atom* masterAtom = set->atoms.front();
         if ( verbose )  {
-            dedupSavings += ((dups.size() - 1) * masterAtom->size());
-            fprintf(stderr, "deduplicate the following %lu functions (%llu bytes apiece):\n", dups.size(), masterAtom->size());
+            dedupSavings += ((set->atoms.size() - 1) * masterAtom->size());
+            fprintf(stderr, "deduplicate the following %lu functions (%llu bytes apiece):\n", set->atoms.size(), masterAtom->size());
         }
 
-        for (const ld::Atom* dupAtom : dups) {
+        for (const ld::Atom* dupAtom : set->atoms) {
             if ( verbose )
                 fprintf(stderr, "    %s\n", dupAtom->name());
             if ( dupAtom == masterAtom )
@@ -385,8 +449,6 @@ void doPass(const Options& opts, ld::Internal& state)
         for (const ld::Atom* atom : textSection->atoms)
             fprintf(stderr, "  %p (size=%llu) %s\n", atom, atom->size(), atom->name());
     }
-
-   //fprintf(stderr, "hash-count=%lu, fixup-compares=%lu, atom-count=%u\n", sHashCount, sFixupCompareCount, atomsBeingComparedCount);
 }
 
 
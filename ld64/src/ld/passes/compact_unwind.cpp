@@ -32,6 +32,9 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <dispatch/dispatch.h>
 
 #include "ld.hpp"
 #include "compact_unwind.h"
@@ -63,6 +66,18 @@ struct LSDAEntry {
 	const ld::Atom*		lsda; 
 };
 
+// encoding to table index, sorted by encoding
+typedef std::vector<std::pair<compact_unwind_encoding_t, unsigned int> > EncodingIndexes;
+
+static bool findEncodingIndex(const EncodingIndexes& encodings, compact_unwind_encoding_t encoding, unsigned int& index)
+{
+	EncodingIndexes::const_iterator pos = std::lower_bound(encodings.begin(), encodings.end(), std::make_pair(encoding, 0U));
+	if ( (pos == encodings.end()) || (pos->first != encoding) )
+		return false;
+	index = pos->second;
+	return true;
+}
+
 
 template <typename A>
 class UnwindInfoAtom : public ld::Atom {
@@ -86,27 +101,41 @@ private:
 
 	typedef macho_unwind_info_compressed_second_level_page_header<P> CSLP;
 
+	// Which entries go on a second level page is decided serially (each page ends where
+	// the previous one starts), then all pages are filled in concurrently.
+	struct SecondLevelPage {
+		unsigned int										startIndex;
+		unsigned int										endIndex;
+		uint32_t											size;
+		bool												compressed;
+		uint8_t*											start;
+		std::map<compact_unwind_encoding_t, unsigned int>	pageSpecificEncodings;
+	};
+
 	bool						encodingMeansUseDwarf(compact_unwind_encoding_t enc);
 	bool						encodingCannotBeMerged(compact_unwind_encoding_t enc);
 	void						compressDuplicates(const std::vector<UnwindEntry>& entries,
 													std::vector<UnwindEntry>& uniqueEntries);
 	void						makePersonalityIndexes(std::vector<UnwindEntry>& entries, 
-														std::map<const ld::Atom*, uint32_t>& personalityIndexMap);
-	void						findCommonEncoding(const std::vector<UnwindEntry>& entries, 
-													std::map<compact_unwind_encoding_t, unsigned int>& commonEncodings);
+														std::vector<const ld::Atom*>& personalities);
+	void						findCommonEncoding(const std::vector<UnwindEntry>& entries, EncodingIndexes& commonEncodings);
 	void						makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, 
-																std::map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap);
-	unsigned int				makeCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
-													const std::map<compact_unwind_encoding_t,unsigned int> commonEncodings,  
-													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd);
-	unsigned int				makeRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
-															unsigned int endIndex, uint8_t*& pageEnd);
-	void						addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc);
-	void						addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde);
-	void						addRegularAddressFixup(uint32_t offset, const ld::Atom* func);
-	void						addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde);
-	void						addImageOffsetFixup(uint32_t offset, const ld::Atom* targ);
-	void						addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend);
+																std::vector<uint32_t>& lsdaIndexOffsets);
+	void						planCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const EncodingIndexes& commonEncodings,
+													uint32_t pageSize, unsigned int endIndex, SecondLevelPage& page);
+	void						planRegularSecondLevelPage(uint32_t pageSize, unsigned int endIndex, SecondLevelPage& page);
+	void						fillCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const EncodingIndexes& commonEncodings,
+													const SecondLevelPage& page, std::vector<ld::Fixup>& fixups);
+	void						fillRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const SecondLevelPage& page, std::vector<ld::Fixup>& fixups);
+	void						addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc);
+	void						addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde);
+	void						addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func);
+	void						addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde);
+	void						addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ);
+	void						addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend);
 
 	uint8_t*								_pagesForDelete;
 	uint8_t*								_pageAlignedPages;
@@ -142,20 +171,20 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	_fixups.reserve(uniqueEntries.size()*3);
 
 	// build personality index, update encodings with personality index
-	std::map<const ld::Atom*, uint32_t>	personalityIndexMap;
-	makePersonalityIndexes(uniqueEntries, personalityIndexMap);
-	if ( personalityIndexMap.size() > 3 ) {
+	std::vector<const ld::Atom*> personalities;
+	makePersonalityIndexes(uniqueEntries, personalities);
+	if ( personalities.size() > 3 ) {
 		throw "too many personality routines for compact unwind to encode";
 	}
 
 	// put the most common encodings into the common table, but at most 127 of them
-	std::map<compact_unwind_encoding_t, unsigned int> commonEncodings;
+	EncodingIndexes commonEncodings;
 	findCommonEncoding(uniqueEntries, commonEncodings);
 	
 	// build lsda index
-	std::map<const ld::Atom*, uint32_t> lsdaIndexOffsetMap;
+	std::vector<uint32_t> lsdaIndexOffsets;
 	std::vector<LSDAEntry>	lsdaIndex;
-	makeLsdaIndex(uniqueEntries, lsdaIndex, lsdaIndexOffsetMap);
+	makeLsdaIndex(uniqueEntries, lsdaIndex, lsdaIndexOffsets);
 	
 	// calculate worst case size for all unwind info pages when allocating buffer
 	const unsigned int entriesPerRegularPage = (4096-sizeof(unwind_info_regular_second_level_page_header))/sizeof(unwind_info_regular_second_level_entry);
@@ -176,24 +205,42 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 		maxLastPageSize = 4096;
 	}
 	
-	// fill in pages in reverse order
-	const ld::Atom* secondLevelFirstFuncs[pageCount*3];
-	uint8_t* secondLevelPagesStarts[pageCount*3];
+	// lay out pages in reverse order
+	std::vector<SecondLevelPage> secondLevelPages;
+	secondLevelPages.reserve(pageCount);
 	unsigned int endIndex = uniqueEntries.size();
-	unsigned int secondLevelPageCount = 0;
 	uint8_t* pageEnd = &_pageAlignedPages[pageCount*4096];
 	uint32_t pageSize = maxLastPageSize;
 	while ( endIndex > 0 ) {
-		endIndex = makeCompressedSecondLevelPage(uniqueEntries, commonEncodings, pageSize, endIndex, pageEnd);
-		secondLevelPagesStarts[secondLevelPageCount] = pageEnd;
-		secondLevelFirstFuncs[secondLevelPageCount] = uniqueEntries[endIndex].func;
-		++secondLevelPageCount;
+		secondLevelPages.emplace_back();
+		SecondLevelPage& page = secondLevelPages.back();
+		planCompressedSecondLevelPage(uniqueEntries, commonEncodings, pageSize, endIndex, page);
+		pageEnd -= page.size;
+		page.start = pageEnd;
+		endIndex = page.startIndex;
 		// if this requires more than one page, align so that next starts on page boundary
 		if ( (pageSize != 4096) && (endIndex > 0) ) {
 			pageEnd = (uint8_t*)((uintptr_t)(pageEnd) & -4096);
 			pageSize = 4096;  // last page can be odd size, make rest up to 4096 bytes in size
 		}
 	}
+	const unsigned int secondLevelPageCount = secondLevelPages.size();
+
+	// fill in pages concurrently, each with its own fixups which are then added in page layout order
+	std::vector<std::vector<ld::Fixup>> pageFixups(secondLevelPageCount);
+	std::vector<ld::Fixup>* pageFixupsArray = pageFixups.data();
+	const SecondLevelPage* pagesArray = secondLevelPages.data();
+	const std::vector<UnwindEntry>* uniqueEntriesPtr = &uniqueEntries;
+	const EncodingIndexes* commonEncodingsPtr = &commonEncodings;
+	dispatch_apply(secondLevelPageCount, DISPATCH_APPLY_AUTO, ^(size_t pageIndex) {
+		const SecondLevelPage& page = pagesArray[pageIndex];
+		if ( page.compressed )
+			this->fillCompressedSecondLevelPage(*uniqueEntriesPtr, *commonEncodingsPtr, page, pageFixupsArray[pageIndex]);
+		else
+			this->fillRegularSecondLevelPage(*uniqueEntriesPtr, page, pageFixupsArray[pageIndex]);
+	});
+	for (const std::vector<ld::Fixup>& fixups : pageFixups)
+		_fixups.insert(_fixups.end(), fixups.begin(), fixups.end());
 	_pages = pageEnd;
 	_pagesSize = &_pageAlignedPages[pageCount*4096] - pageEnd;
 
@@ -202,7 +249,7 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	const uint32_t commonEncodingsArrayCount = commonEncodings.size();
 	const uint32_t commonEncodingsArraySize = commonEncodingsArrayCount * sizeof(compact_unwind_encoding_t);
 	const uint32_t personalityArraySectionOffset = commonEncodingsArraySectionOffset + commonEncodingsArraySize;
-	const uint32_t personalityArrayCount = personalityIndexMap.size();
+	const uint32_t personalityArrayCount = personalities.size();
 	const uint32_t personalityArraySize = personalityArrayCount * sizeof(uint32_t);
 	const uint32_t indexSectionOffset = personalityArraySectionOffset + personalityArraySize;
 	const uint32_t indexCount = secondLevelPageCount+1;
@@ -233,38 +280,38 @@ UnwindInfoAtom<A>::UnwindInfoAtom(const std::vector<UnwindEntry>& entries, uint6
 	
 	// copy common encodings
 	uint32_t* commonEncodingsTable = (uint32_t*)&_header[commonEncodingsArraySectionOffset];
-	for (std::map<uint32_t, unsigned int>::iterator it=commonEncodings.begin(); it != commonEncodings.end(); ++it)
+	for (EncodingIndexes::const_iterator it=commonEncodings.begin(); it != commonEncodings.end(); ++it)
 		E::set32(commonEncodingsTable[it->second], it->first);
 		
 	// make references for personality entries
 	uint32_t* personalityArray = (uint32_t*)&_header[sectionHeader->personalityArraySectionOffset()];
-	for (std::map<const ld::Atom*, unsigned int>::iterator it=personalityIndexMap.begin(); it != personalityIndexMap.end(); ++it) {
-		uint32_t offset = (uint8_t*)&personalityArray[it->second-1] - _header;
-		this->addImageOffsetFixup(offset, it->first);
+	for (unsigned int i=0; i < personalities.size(); ++i) {
+		uint32_t offset = (uint8_t*)&personalityArray[i] - _header;
+		this->addImageOffsetFixup(_fixups, offset, personalities[i]);
 	}
 
 	// build first level index and references
 	macho_unwind_info_section_header_index_entry<P>* indexTable = (macho_unwind_info_section_header_index_entry<P>*)&_header[indexSectionOffset];
 	uint32_t refOffset;
 	for (unsigned int i=0; i < secondLevelPageCount; ++i) {
-		unsigned int reverseIndex = secondLevelPageCount - 1 - i;
+		const SecondLevelPage& page = secondLevelPages[secondLevelPageCount - 1 - i];
 		indexTable[i].set_functionOffset(0);
-		indexTable[i].set_secondLevelPagesSectionOffset(secondLevelPagesStarts[reverseIndex]-_pages+headerEndSectionOffset);
-		indexTable[i].set_lsdaIndexArraySectionOffset(lsdaIndexOffsetMap[secondLevelFirstFuncs[reverseIndex]]+lsdaIndexArraySectionOffset); 
+		indexTable[i].set_secondLevelPagesSectionOffset(page.start-_pages+headerEndSectionOffset);
+		indexTable[i].set_lsdaIndexArraySectionOffset(lsdaIndexOffsets[page.startIndex]+lsdaIndexArraySectionOffset); 
 		refOffset = (uint8_t*)&indexTable[i] - _header;
-		this->addImageOffsetFixup(refOffset, secondLevelFirstFuncs[reverseIndex]);
+		this->addImageOffsetFixup(_fixups, refOffset, uniqueEntries[page.startIndex].func);
 	}
 	indexTable[secondLevelPageCount].set_functionOffset(0);
 	indexTable[secondLevelPageCount].set_secondLevelPagesSectionOffset(0);
 	indexTable[secondLevelPageCount].set_lsdaIndexArraySectionOffset(lsdaIndexArraySectionOffset+lsdaIndexArraySize); 
 	refOffset = (uint8_t*)&indexTable[secondLevelPageCount] - _header;
-	this->addImageOffsetFixupPlusAddend(refOffset, entries.back().func, entries.back().func->size()+1);
+	this->addImageOffsetFixupPlusAddend(_fixups, refOffset, entries.back().func, entries.back().func->size()+1);
 	
 	// build lsda references
 	uint32_t lsdaEntrySectionOffset = lsdaIndexArraySectionOffset;
 	for (std::vector<LSDAEntry>::iterator it = lsdaIndex.begin(); it != lsdaIndex.end(); ++it) {
-		this->addImageOffsetFixup(lsdaEntrySectionOffset, it->func);
-		this->addImageOffsetFixup(lsdaEntrySectionOffset+4, it->lsda);
+		this->addImageOffsetFixup(_fixups, lsdaEntrySectionOffset, it->func);
+		this->addImageOffsetFixup(_fixups, lsdaEntrySectionOffset+4, it->lsda);
 		lsdaEntrySectionOffset += sizeof(unwind_info_section_header_lsda_index_entry);
 	}
 	
@@ -362,364 +409,374 @@ void UnwindInfoAtom<A>::compressDuplicates(const std::vector<UnwindEntry>& entri
 }
 
 template <typename A>
-void UnwindInfoAtom<A>::makePersonalityIndexes(std::vector<UnwindEntry>& entries, std::map<const ld::Atom*, uint32_t>& personalityIndexMap)
+void UnwindInfoAtom<A>::makePersonalityIndexes(std::vector<UnwindEntry>& entries, std::vector<const ld::Atom*>& personalities)
 {
+	// there can only be a handful of personality routines, so a linear search is fastest
 	for(std::vector<UnwindEntry>::iterator it=entries.begin(); it != entries.end(); ++it) {
 		if ( it->personalityPointer != NULL ) {
-			std::map<const ld::Atom*, uint32_t>::iterator pos = personalityIndexMap.find(it->personalityPointer);
-			if ( pos == personalityIndexMap.end() ) {
-				const uint32_t nextIndex = personalityIndexMap.size() + 1;
-				personalityIndexMap[it->personalityPointer] = nextIndex;
-			}
-			uint32_t personalityIndex = personalityIndexMap[it->personalityPointer];
+			std::vector<const ld::Atom*>::iterator pos = std::find(personalities.begin(), personalities.end(), it->personalityPointer);
+			if ( pos == personalities.end() )
+				pos = personalities.insert(personalities.end(), it->personalityPointer);
+			uint32_t personalityIndex = (uint32_t)(pos - personalities.begin()) + 1;
 			it->encoding |= (personalityIndex << (__builtin_ctz(UNWIND_PERSONALITY_MASK)) );
 		}
 	}
-	if (_s_log) fprintf(stderr, "makePersonalityIndexes() %lu personality routines used\n", personalityIndexMap.size()); 
+	if (_s_log) fprintf(stderr, "makePersonalityIndexes() %lu personality routines used\n", personalities.size());
 }
 
 
 template <typename A>
-void UnwindInfoAtom<A>::findCommonEncoding(const std::vector<UnwindEntry>& entries, 
-											std::map<compact_unwind_encoding_t, unsigned int>& commonEncodings)
+void UnwindInfoAtom<A>::findCommonEncoding(const std::vector<UnwindEntry>& entries, EncodingIndexes& commonEncodings)
 {
 	// scan infos to get frequency counts for each encoding
-	std::map<compact_unwind_encoding_t, unsigned int> encodingsUsed;
-	unsigned int mostCommonEncodingUsageCount = 0;
+	std::unordered_map<compact_unwind_encoding_t, unsigned int> encodingsUsed;
 	for(std::vector<UnwindEntry>::const_iterator it=entries.begin(); it != entries.end(); ++it) {
 		// never put dwarf into common table
 		if ( encodingMeansUseDwarf(it->encoding) )
 			continue;
-		std::map<compact_unwind_encoding_t, unsigned int>::iterator pos = encodingsUsed.find(it->encoding);
-		if ( pos == encodingsUsed.end() ) {
-			encodingsUsed[it->encoding] = 1;
-		}
-		else {
-			encodingsUsed[it->encoding] += 1;
-			if ( mostCommonEncodingUsageCount < encodingsUsed[it->encoding] )
-				mostCommonEncodingUsageCount = encodingsUsed[it->encoding];
-		}
+		encodingsUsed[it->encoding] += 1;
 	}
 	// put the most common encodings into the common table, but at most 127 of them
-	for(unsigned int usages=mostCommonEncodingUsageCount; usages > 1; --usages) {
-		for (std::map<compact_unwind_encoding_t, unsigned int>::iterator euit=encodingsUsed.begin(); euit != encodingsUsed.end(); ++euit) {
-			if ( euit->second == usages ) {
-				unsigned int sz = commonEncodings.size();
-				if ( sz < 127 ) {
-					commonEncodings[euit->first] = sz;
-				}
-			}
-		}
+	// (most used first, ties broken by encoding value)
+	std::vector<std::pair<compact_unwind_encoding_t, unsigned int> > candidates;
+	for (const auto& used : encodingsUsed) {
+		if ( used.second > 1 )
+			candidates.push_back(used);
 	}
-	if (_s_log) fprintf(stderr, "findCommonEncoding() %lu common encodings found\n", commonEncodings.size()); 
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<compact_unwind_encoding_t, unsigned int>& left,
+													   const std::pair<compact_unwind_encoding_t, unsigned int>& right) {
+		if ( left.second != right.second )
+			return ( left.second > right.second );
+		return ( left.first < right.first );
+	});
+	const unsigned int commonCount = std::min((unsigned int)candidates.size(), 127U);
+	commonEncodings.reserve(commonCount);
+	for (unsigned int i=0; i < commonCount; ++i)
+		commonEncodings.push_back(std::make_pair(candidates[i].first, i));
+	std::sort(commonEncodings.begin(), commonEncodings.end());
+	if (_s_log) fprintf(stderr, "findCommonEncoding() %lu common encodings found\n", commonEncodings.size());
 }
 
 
 template <typename A>
-void UnwindInfoAtom<A>::makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, std::map<const ld::Atom*, uint32_t>& lsdaIndexOffsetMap)
+void UnwindInfoAtom<A>::makeLsdaIndex(const std::vector<UnwindEntry>& entries, std::vector<LSDAEntry>& lsdaIndex, std::vector<uint32_t>& lsdaIndexOffsets)
 {
-	for(std::vector<UnwindEntry>::const_iterator it=entries.begin(); it != entries.end(); ++it) {
-		lsdaIndexOffsetMap[it->func] = lsdaIndex.size() * sizeof(unwind_info_section_header_lsda_index_entry);
-		if ( it->lsda != NULL ) {
+	lsdaIndexOffsets.resize(entries.size());
+	for(unsigned int i=0; i < entries.size(); ++i) {
+		lsdaIndexOffsets[i] = lsdaIndex.size() * sizeof(unwind_info_section_header_lsda_index_entry);
+		if ( entries[i].lsda != NULL ) {
 			LSDAEntry entry;
-			entry.func = it->func;
-			entry.lsda = it->lsda;
+			entry.func = entries[i].func;
+			entry.lsda = entries[i].lsda;
 			lsdaIndex.push_back(entry);
 		}
 	}
-	if (_s_log) fprintf(stderr, "makeLsdaIndex() %lu LSDAs found\n", lsdaIndex.size()); 
+	// a function with several unwind entries uses the lsda offset of its last entry
+	for(unsigned int i=entries.size(); i > 1; --i) {
+		if ( entries[i-2].func == entries[i-1].func )
+			lsdaIndexOffsets[i-2] = lsdaIndexOffsets[i-1];
+	}
+	if (_s_log) fprintf(stderr, "makeLsdaIndex() %lu LSDAs found\n", lsdaIndex.size());
 }
 
-
 template <>
-void UnwindInfoAtom<x86>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<x86>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<x86_64>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm64>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm64_32>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addCompressedAddressOffsetFixup(uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
+void UnwindInfoAtom<arm>::addCompressedAddressOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func, const ld::Atom* fromFunc)
 {
 	if ( fromFunc->isThumb() ) {
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of4, ld::Fixup::kindSetTargetAddress, func));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of4, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of4, ld::Fixup::kindSubtractAddend, 1));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k4of4, ld::Fixup::kindStoreLittleEndianLow24of32));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of4, ld::Fixup::kindSetTargetAddress, func));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of4, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of4, ld::Fixup::kindSubtractAddend, 1));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k4of4, ld::Fixup::kindStoreLittleEndianLow24of32));
 	}
 	else {
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
-		_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetAddress, func));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindSubtractTargetAddress, fromFunc));
+		fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndianLow24of32));
 	}
 }
 
 template <>
-void UnwindInfoAtom<x86>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86_64>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64_32>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addCompressedEncodingFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm>::addCompressedEncodingFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<x86>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<x86_64>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm64>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm64_32>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addRegularAddressFixup(uint32_t offset, const ld::Atom* func)
+void UnwindInfoAtom<arm>::addRegularAddressFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* func)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, func));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<x86_64>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm64_32>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addRegularFDEOffsetFixup(uint32_t offset, const ld::Atom* fde)
+void UnwindInfoAtom<arm>::addRegularFDEOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* fde)
 {
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
-	_fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k1of2, ld::Fixup::kindSetTargetSectionOffset, fde));
+	fixups.push_back(ld::Fixup(offset+4, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndianLow24of32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<x86>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<x86_64>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm64>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm64_32>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addImageOffsetFixup(uint32_t offset, const ld::Atom* targ)
+void UnwindInfoAtom<arm>::addImageOffsetFixup(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of2, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of2, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<x86>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<x86_64>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<x86_64>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 template <>
-void UnwindInfoAtom<arm64>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm64>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 #if SUPPORT_ARCH_arm64_32
 template <>
-void UnwindInfoAtom<arm64_32>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm64_32>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 #endif
 
 template <>
-void UnwindInfoAtom<arm>::addImageOffsetFixupPlusAddend(uint32_t offset, const ld::Atom* targ, uint32_t addend)
+void UnwindInfoAtom<arm>::addImageOffsetFixupPlusAddend(std::vector<ld::Fixup>& fixups, uint32_t offset, const ld::Atom* targ, uint32_t addend)
 {
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
-	_fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k1of3, ld::Fixup::kindSetTargetImageOffset, targ));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k2of3, ld::Fixup::kindAddAddend, addend));
+	fixups.push_back(ld::Fixup(offset, ld::Fixup::k3of3, ld::Fixup::kindStoreLittleEndian32));
 }
 
 
 
 
 template <typename A>
-unsigned int UnwindInfoAtom<A>::makeRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, uint32_t pageSize,  
-															unsigned int endIndex, uint8_t*& pageEnd)
+void UnwindInfoAtom<A>::planRegularSecondLevelPage(uint32_t pageSize, unsigned int endIndex, SecondLevelPage& page)
 {
 	const unsigned int maxEntriesPerPage = (pageSize - sizeof(unwind_info_regular_second_level_page_header))/sizeof(unwind_info_regular_second_level_entry);
 	const unsigned int entriesToAdd = ((endIndex > maxEntriesPerPage) ? maxEntriesPerPage : endIndex);
-	uint8_t* pageStart = pageEnd 
-						- entriesToAdd*sizeof(unwind_info_regular_second_level_entry) 
-						- sizeof(unwind_info_regular_second_level_page_header);
-	macho_unwind_info_regular_second_level_page_header<P>* page = (macho_unwind_info_regular_second_level_page_header<P>*)pageStart;
-	page->set_kind(UNWIND_SECOND_LEVEL_REGULAR);
-	page->set_entryPageOffset(sizeof(macho_unwind_info_regular_second_level_page_header<P>));
-	page->set_entryCount(entriesToAdd);
-	macho_unwind_info_regular_second_level_entry<P>* entryTable = (macho_unwind_info_regular_second_level_entry<P>*)(pageStart + page->entryPageOffset());
+	page.compressed = false;
+	page.startIndex = endIndex - entriesToAdd;
+	page.endIndex	= endIndex;
+	page.size		= entriesToAdd*sizeof(unwind_info_regular_second_level_entry) + sizeof(unwind_info_regular_second_level_page_header);
+	page.pageSpecificEncodings.clear();
+}
+
+
+template <typename A>
+void UnwindInfoAtom<A>::fillRegularSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos, const SecondLevelPage& page,
+													std::vector<ld::Fixup>& fixups)
+{
+	const unsigned int entriesToAdd = page.endIndex - page.startIndex;
+	uint8_t* pageStart = page.start;
+	macho_unwind_info_regular_second_level_page_header<P>* pageHeader = (macho_unwind_info_regular_second_level_page_header<P>*)pageStart;
+	pageHeader->set_kind(UNWIND_SECOND_LEVEL_REGULAR);
+	pageHeader->set_entryPageOffset(sizeof(macho_unwind_info_regular_second_level_page_header<P>));
+	pageHeader->set_entryCount(entriesToAdd);
+	macho_unwind_info_regular_second_level_entry<P>* entryTable = (macho_unwind_info_regular_second_level_entry<P>*)(pageStart + pageHeader->entryPageOffset());
+	fixups.reserve(entriesToAdd*2);
 	for (unsigned int i=0; i < entriesToAdd; ++i) {
-		const UnwindEntry& info = uniqueInfos[endIndex-entriesToAdd+i];
+		const UnwindEntry& info = uniqueInfos[page.startIndex+i];
 		entryTable[i].set_functionOffset(0);
 		entryTable[i].set_encoding(info.encoding);
 		// add fixup for address part of entry
 		uint32_t offset = (uint8_t*)(&entryTable[i]) - _pageAlignedPages;
-		this->addRegularAddressFixup(offset, info.func);
+		this->addRegularAddressFixup(fixups, offset, info.func);
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// add fixup for dwarf offset part of page specific encoding
 			uint32_t encOffset = (uint8_t*)(&entryTable[i]) - _pageAlignedPages;
-			this->addRegularFDEOffsetFixup(encOffset, info.fde);
+			this->addRegularFDEOffsetFixup(fixups, encOffset, info.fde);
 		}
 	}
 	if (_s_log) fprintf(stderr, "regular page with %u entries\n", entriesToAdd);
-	pageEnd = pageStart;
-	return endIndex - entriesToAdd;
 }
 
 
 template <typename A>
-unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,   
-													const std::map<compact_unwind_encoding_t,unsigned int> commonEncodings,  
-													uint32_t pageSize, unsigned int endIndex, uint8_t*& pageEnd)
+void UnwindInfoAtom<A>::planCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const EncodingIndexes& commonEncodings,
+													uint32_t pageSize, unsigned int endIndex, SecondLevelPage& page)
 {
-	if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(pageSize=%u, endIndex=%u)\n", pageSize, endIndex);
-	// first pass calculates how many compressed entries we could fit in this sized page
+	if (_s_log) fprintf(stderr, "planCompressedSecondLevelPage(pageSize=%u, endIndex=%u)\n", pageSize, endIndex);
+	// calculate how many compressed entries we could fit in this sized page
 	// keep adding entries to page until:
 	//  1) encoding table plus entry table plus header exceed page size
 	//  2) the file offset delta from the first to last function > 24 bits
 	//  3) custom encoding index reaches 255
 	//  4) run out of uniqueInfos to encode
-	std::map<compact_unwind_encoding_t, unsigned int> pageSpecificEncodings;
+	std::map<compact_unwind_encoding_t, unsigned int>& pageSpecificEncodings = page.pageSpecificEncodings;
 	uint32_t space4 =  (pageSize - sizeof(unwind_info_compressed_second_level_page_header))/sizeof(uint32_t);
 	int index = endIndex-1;
 	int entryCount = 0;
@@ -729,10 +786,8 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 		const UnwindEntry& info = uniqueInfos[index--];
 		// compute encoding index
 		unsigned int encodingIndex;
-		std::map<compact_unwind_encoding_t, unsigned int>::const_iterator pos = commonEncodings.find(info.encoding);
-		if ( pos != commonEncodings.end() ) {
-			encodingIndex = pos->second;
-			if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(): funcIndex=%d, re-use commonEncodings[%d]=0x%08X\n", index, encodingIndex, info.encoding);
+		if ( findEncodingIndex(commonEncodings, info.encoding, encodingIndex) ) {
+			if (_s_log) fprintf(stderr, "planCompressedSecondLevelPage(): funcIndex=%d, re-use commonEncodings[%d]=0x%08X\n", index, encodingIndex, info.encoding);
 		}
 		else {
 			// no commmon entry, so add one on this page
@@ -743,18 +798,18 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 			}
 			std::map<compact_unwind_encoding_t, unsigned int>::iterator ppos = pageSpecificEncodings.find(encoding);
 			if ( ppos != pageSpecificEncodings.end() ) {
-				encodingIndex = pos->second;
-				if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(): funcIndex=%d, re-use pageSpecificEncodings[%d]=0x%08X\n", index, encodingIndex, encoding);
+				encodingIndex = ppos->second;
+				if (_s_log) fprintf(stderr, "planCompressedSecondLevelPage(): funcIndex=%d, re-use pageSpecificEncodings[%d]=0x%08X\n", index, encodingIndex, encoding);
 			}
 			else {
 				encodingIndex = commonEncodings.size() + pageSpecificEncodings.size();
 				if ( encodingIndex <= 255 ) {
 					pageSpecificEncodings[encoding] = encodingIndex;
-					if (_s_log) fprintf(stderr, "makeCompressedSecondLevelPage(): funcIndex=%d, pageSpecificEncodings[%d]=0x%08X\n", index, encodingIndex, encoding);
+					if (_s_log) fprintf(stderr, "planCompressedSecondLevelPage(): funcIndex=%d, pageSpecificEncodings[%d]=0x%08X\n", index, encodingIndex, encoding);
 				}
 				else {
 					canDo = false; // case 3)
-					if (_s_log) fprintf(stderr, "end of compressed page with %u entries, %lu custom encodings because too many custom encodings\n", 
+					if (_s_log) fprintf(stderr, "end of compressed page with %u entries, %lu custom encodings because too many custom encodings\n",
 											entryCount, pageSpecificEncodings.size());
 				}
 			}
@@ -777,71 +832,82 @@ unsigned int UnwindInfoAtom<A>::makeCompressedSecondLevelPage(const std::vector<
 			++entryCount;
 		}
 	}
-	
+
 	// check for cases where it would be better to use a regular (non-compressed) page
-	const unsigned int compressPageUsed = sizeof(unwind_info_compressed_second_level_page_header) 
+	const unsigned int compressPageUsed = sizeof(unwind_info_compressed_second_level_page_header)
 								+ pageSpecificEncodings.size()*sizeof(uint32_t)
 								+ entryCount*sizeof(uint32_t);
 	if ( (compressPageUsed < (pageSize-4) && (index >= 0) ) ) {
 		const int regularEntriesPerPage = (pageSize - sizeof(unwind_info_regular_second_level_page_header))/sizeof(unwind_info_regular_second_level_entry);
 		if ( entryCount < regularEntriesPerPage ) {
-			return makeRegularSecondLevelPage(uniqueInfos, pageSize, endIndex, pageEnd);
+			planRegularSecondLevelPage(pageSize, endIndex, page);
+			return;
 		}
 	}
-	
+
 	// check if we need any padding because adding another entry would take 8 bytes but only have room for 4
 	uint32_t pad = 0;
 	if ( compressPageUsed == (pageSize-4) )
 		pad = 4;
 
-	// second pass fills in page 
-	uint8_t* pageStart = pageEnd - compressPageUsed - pad;
-	CSLP* page = (CSLP*)pageStart;
-	page->set_kind(UNWIND_SECOND_LEVEL_COMPRESSED);
-	page->set_entryPageOffset(sizeof(CSLP));
-	page->set_entryCount(entryCount);
-	page->set_encodingsPageOffset(page->entryPageOffset()+entryCount*sizeof(uint32_t));
-	page->set_encodingsCount(pageSpecificEncodings.size());
-	uint32_t* const encodingsArray = (uint32_t*)&pageStart[page->encodingsPageOffset()];
+	page.compressed = true;
+	page.startIndex = endIndex - entryCount;
+	page.endIndex	= endIndex;
+	page.size		= compressPageUsed + pad;
+}
+
+
+template <typename A>
+void UnwindInfoAtom<A>::fillCompressedSecondLevelPage(const std::vector<UnwindEntry>& uniqueInfos,
+													const EncodingIndexes& commonEncodings,
+													const SecondLevelPage& page, std::vector<ld::Fixup>& fixups)
+{
+	const std::map<compact_unwind_encoding_t, unsigned int>& pageSpecificEncodings = page.pageSpecificEncodings;
+	const unsigned int entryCount = page.endIndex - page.startIndex;
+	uint8_t* pageStart = page.start;
+	CSLP* pageHeader = (CSLP*)pageStart;
+	pageHeader->set_kind(UNWIND_SECOND_LEVEL_COMPRESSED);
+	pageHeader->set_entryPageOffset(sizeof(CSLP));
+	pageHeader->set_entryCount(entryCount);
+	pageHeader->set_encodingsPageOffset(pageHeader->entryPageOffset()+entryCount*sizeof(uint32_t));
+	pageHeader->set_encodingsCount(pageSpecificEncodings.size());
+	uint32_t* const encodingsArray = (uint32_t*)&pageStart[pageHeader->encodingsPageOffset()];
 	// fill in entry table
-	uint32_t* const entiresArray = (uint32_t*)&pageStart[page->entryPageOffset()];
-	const ld::Atom* firstFunc = uniqueInfos[endIndex-entryCount].func;
-	for(unsigned int i=endIndex-entryCount; i < endIndex; ++i) {
+	uint32_t* const entiresArray = (uint32_t*)&pageStart[pageHeader->entryPageOffset()];
+	const ld::Atom* firstFunc = uniqueInfos[page.startIndex].func;
+	fixups.reserve(entryCount*3);
+	for(unsigned int i=page.startIndex; i < page.endIndex; ++i) {
 		const UnwindEntry& info = uniqueInfos[i];
 		uint8_t encodingIndex;
+		unsigned int commonIndex;
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// dwarf entries are always in page specific encodings
 			assert(pageSpecificEncodings.find(info.encoding+i) != pageSpecificEncodings.end());
-			encodingIndex = pageSpecificEncodings[info.encoding+i];
+			encodingIndex = pageSpecificEncodings.find(info.encoding+i)->second;
+		}
+		else if ( findEncodingIndex(commonEncodings, info.encoding, commonIndex) ) {
+			encodingIndex = commonIndex;
 		}
 		else {
-			std::map<uint32_t, unsigned int>::const_iterator pos = commonEncodings.find(info.encoding);
-			if ( pos != commonEncodings.end() ) 
-				encodingIndex = pos->second;
-			else 
-				encodingIndex = pageSpecificEncodings[info.encoding];
+			encodingIndex = pageSpecificEncodings.find(info.encoding)->second;
 		}
-		uint32_t entryIndex = i - endIndex + entryCount;
+		uint32_t entryIndex = i - page.startIndex;
 		E::set32(entiresArray[entryIndex], encodingIndex << 24);
 		// add fixup for address part of entry
 		uint32_t offset = (uint8_t*)(&entiresArray[entryIndex]) - _pageAlignedPages;
-		this->addCompressedAddressOffsetFixup(offset, info.func, firstFunc);
+		this->addCompressedAddressOffsetFixup(fixups, offset, info.func, firstFunc);
 		if ( encodingMeansUseDwarf(info.encoding) ) {
 			// add fixup for dwarf offset part of page specific encoding
 			uint32_t encOffset = (uint8_t*)(&encodingsArray[encodingIndex-commonEncodings.size()]) - _pageAlignedPages;
-			this->addCompressedEncodingFixup(encOffset, info.fde);
+			this->addCompressedEncodingFixup(fixups, encOffset, info.fde);
 		}
 	}
 	// fill in encodings table
 	for(std::map<uint32_t, unsigned int>::const_iterator it = pageSpecificEncodings.begin(); it != pageSpecificEncodings.end(); ++it) {
 		E::set32(encodingsArray[it->second-commonEncodings.size()], it->first);
 	}
-	
+
 	if (_s_log) fprintf(stderr, "compressed page with %u entries, %lu custom encodings\n", entryCount, pageSpecificEncodings.size());
-	
-	// update pageEnd;
-	pageEnd = pageStart;
-	return endIndex-entryCount;  // endIndex for next page
 }
 
 
@@ -27,6 +27,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <mach-o/loader.h>
+#include <dispatch/dispatch.h>
+
+#include <algorithm>
 
 #include "ExportsTrie.h"
 
@@ -64,11 +67,29 @@ void GenericTrie::buildTrieBytes(size_t entriesCount, const std::vector<uint8_t>
     // build exports trie by splicing in each new symbol
     std::vector<Node*>  allNodes;
     Node* start = new Node("", allNodes);
-    for ( size_t i = 0; i < entriesCount; ++i ) {
-        Error err = start->addEntry(get(i), terminalBuffer, allNodes);
-        if ( err.hasError() ) {
-            _buildError = Error("%s", err.message());
-            return;
+    if ( entriesCount >= kMinParallelEntries ) {
+        // the getter is not required to be thread safe, so fetch all entries up front
+        std::vector<WriterEntry> entries;
+        entries.reserve(entriesCount);
+        for ( size_t i = 0; i < entriesCount; ++i )
+            entries.push_back(get(i));
+        if ( !addEntriesInParallel(entries, terminalBuffer, start, allNodes) ) {
+            for ( size_t i = 0; i < entriesCount; ++i ) {
+                Error err = start->addEntry(entries[i], terminalBuffer, allNodes);
+                if ( err.hasError() ) {
+                    _buildError = Error("%s", err.message());
+                    return;
+                }
+            }
+        }
+    }
+    else {
+        for ( size_t i = 0; i < entriesCount; ++i ) {
+            Error err = start->addEntry(get(i), terminalBuffer, allNodes);
+            if ( err.hasError() ) {
+                _buildError = Error("%s", err.message());
+                return;
+            }
         }
     }
 
@@ -102,6 +123,131 @@ void GenericTrie::buildTrieBytes(size_t entriesCount, const std::vector<uint8_t>
     _trieEnd   = &_trieBytes[_trieBytes.size()];
 }
 
+// When the entries are sorted, the trie for a run of names that share a prefix longer than the prefix
+// they share with the name before the run is a subtree hanging off the node (or edge) where the run
+// diverges from its predecessor.  Such runs are built concurrently from their own roots and then
+// spliced into the final trie in order.  Each entry adds at most one split node followed by one leaf,
+// so the nodes keep the same creation order, and therefore the same stream layout, as the serial build.
+bool GenericTrie::addEntriesInParallel(const std::vector<WriterEntry>& entries, const std::vector<uint8_t>& terminalBuffer,
+                                       Node* root, std::vector<Node*>& allNodes)
+{
+    const size_t entriesCount = entries.size();
+
+    // prefixLen[i] is the length of the prefix shared by entries i-1 and i, prefixLen[0] is zero so the first run attaches to the root
+    std::vector<uint32_t> prefixLen(entriesCount, 0);
+    for ( size_t i = 0; i < entriesCount; ++i ) {
+        std::string_view name = entries[i].name;
+        if ( name.empty() )
+            return false;
+        if ( i == 0 )
+            continue;
+        std::string_view prevName = entries[i-1].name;
+        size_t len = 0;
+        size_t maxLen = std::min(name.size(), prevName.size());
+        while ( (len < maxLen) && (name[len] == prevName[len]) )
+            ++len;
+        // the splice below relies on strictly sorted names, otherwise use the serial path (which also diagnoses duplicates)
+        if ( (len == name.size()) || ((len < prevName.size()) && ((uint8_t)prevName[len] > (uint8_t)name[len])) )
+            return false;
+        prefixLen[i] = (uint32_t)len;
+    }
+
+    // split entries into runs, a run may only continue while its names share more than the run's first prefix
+    struct Run { size_t start; size_t end; };
+    std::vector<Run> runs;
+    const size_t targetGroupSize = std::max(kMinParallelEntries / 4, entriesCount / 64);
+    for ( size_t runStart = 0; runStart < entriesCount; ) {
+        const uint32_t bound = prefixLen[runStart];
+        size_t runEnd = runStart + 1;
+        while ( (runEnd < entriesCount) && (prefixLen[runEnd] > bound) && (runEnd - runStart < targetGroupSize) )
+            ++runEnd;
+        if ( (runEnd < entriesCount) && (prefixLen[runEnd] > bound) ) {
+            // run is big enough, but prefer ending it where the next run diverges highest up in the trie
+            size_t bestEnd = runEnd;
+            for ( size_t i = runEnd + 1; (i < entriesCount) && (i < runEnd + targetGroupSize) && (prefixLen[i] > bound); ++i ) {
+                if ( prefixLen[i] < prefixLen[bestEnd] )
+                    bestEnd = i;
+            }
+            runEnd = bestEnd;
+        }
+        runs.push_back({ runStart, runEnd });
+        runStart = runEnd;
+    }
+    if ( runs.size() < 2 )
+        return false;
+
+    // build the subtree for each run
+    const size_t runCount = runs.size();
+    std::vector<std::vector<Node*>> runNodes(runCount);
+    std::vector<Node*> runRoots(runCount, nullptr);
+    __block bool failed = false;
+    const WriterEntry*      entriesData  = entries.data();
+    const Run*              runsData     = runs.data();
+    std::vector<Node*>*     runNodesData = runNodes.data();
+    Node**                  runRootsData = runRoots.data();
+    const std::vector<uint8_t>* terminals = &terminalBuffer;
+    dispatch_apply(runCount, DISPATCH_APPLY_AUTO, ^(size_t runIndex) {
+        std::vector<Node*> localRoot;
+        Node* runRoot = new Node("", localRoot);
+        runRootsData[runIndex] = runRoot;
+        for ( size_t i = runsData[runIndex].start; i < runsData[runIndex].end; ++i ) {
+            if ( runRoot->addEntry(entriesData[i], *terminals, runNodesData[runIndex]).hasError() ) {
+                failed = true;
+                break;
+            }
+        }
+    });
+
+    if ( !failed ) {
+        // splice each run into the trie in order
+        for ( size_t runIndex = 0; runIndex < runCount; ++runIndex ) {
+            const size_t     first      = runs[runIndex].start;
+            std::string_view name       = entries[first].name;
+            const uint32_t   divergeLen = prefixLen[first];
+            Node*            node       = root;
+            size_t           depth      = 0;
+            while ( depth < divergeLen ) {
+                Edge* match = nullptr;
+                for ( Edge& edge : node->children ) {
+                    if ( edge.partialString[0] == name[depth] ) {
+                        match = &edge;
+                        break;
+                    }
+                }
+                assert(match != nullptr && "run diverges from a path that is not in the trie");
+                if ( depth + match->partialString.size() <= divergeLen ) {
+                    depth += match->partialString.size();
+                    node   = match->child;
+                }
+                else {
+                    // run diverges in the middle of an edge, split it just like addEntry() would have
+                    size_t len   = divergeLen - depth;
+                    Node*  cNode = new Node(name.substr(0, divergeLen), allNodes);
+                    cNode->children.push_back(Edge(match->partialString.substr(len), match->child));
+                    match->partialString = match->partialString.substr(0, len);
+                    match->child         = cNode;
+                    node  = cNode;
+                    depth = divergeLen;
+                }
+            }
+            Node* runRoot = runRoots[runIndex];
+            assert(runRoot->children.size() == 1);
+            const Edge& topEdge = runRoot->children.front();
+            node->children.push_back(Edge(topEdge.partialString.substr(divergeLen), topEdge.child));
+            allNodes.insert(allNodes.end(), runNodes[runIndex].begin(), runNodes[runIndex].end());
+        }
+    }
+    else {
+        for ( std::vector<Node*>& nodes : runNodes ) {
+            for ( Node* node : nodes )
+                delete node;
+        }
+    }
+    for ( Node* runRoot : runRoots )
+        delete runRoot;
+    return !failed;
+}
+
 Error GenericTrie::Node::addEntry(const WriterEntry& newEntry, const std::vector<uint8_t>& terminalBuffer, std::vector<Node*>& allNodes)
 {
     std::string_view tail = newEntry.name.substr(cummulativeString.size());
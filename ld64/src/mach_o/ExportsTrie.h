@@ -75,6 +75,10 @@ protected:
 
     struct Node;
 
+    static const size_t kMinParallelEntries = 4096;
+    bool            addEntriesInParallel(const std::vector<WriterEntry>& entries, const std::vector<uint8_t>& terminalBuffer,
+                                         Node* root, std::vector<Node*>& allNodes);
+
     static void     append_uleb128(uint64_t value, std::vector<uint8_t>& out);
     static void     append_string(const std::string_view& str, std::vector<uint8_t>& out);
     void            dumpNodes(const std::vector<Node*>& allNodes, const std::vector<uint8_t>& terminalBuffer);
@@ -0,0 +1,405 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// ld-bench replays a link snapshot (see -benchmark_snapshot_dir) a number of
+// times with one or two linkers, and reports the per phase and per pass times
+// the linker records with -trace_file, the wall time and the peak RSS of each.
+//
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <errno.h>
+#include <spawn.h>
+#include <removefile.h>
+#include <mach/mach_time.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+extern char** environ;
+
+
+ __attribute__((noreturn, format(printf, 1, 2)))
+void throwf(const char* format, ...)
+{
+	va_list	list;
+	char*	p;
+	va_start(list, format);
+	vasprintf(&p, format, list);
+	va_end(list);
+
+	const char*	t = p;
+	throw t;
+}
+
+
+// names used in the snapshot, see Snapshot.cpp
+static const char* const kLinkCommandFile	= "link_command";
+static const char* const kArchFile			= "arch";
+static const char* const kCompileStubsFile	= "compile_stubs";
+static const char* const kOutputsDir		= "outputs";
+static const char* const kOutputFile		= "outputs/ld-bench.out";
+static const char* const kTraceFile			= "outputs/ld-bench-trace.json";
+
+
+struct Timing {
+	std::string				name;
+	std::vector<double>		milliseconds;	// one per iteration
+};
+
+struct Linker {
+	const char*				path;
+	std::vector<Timing>		timings;		// phases and passes in the order the linker reports them
+	std::vector<double>		wallMilliseconds;
+	uint64_t				peakRSS;
+};
+
+
+static bool fileExists(const char* path)
+{
+	struct stat statBuffer;
+	return ( stat(path, &statBuffer) == 0 );
+}
+
+static std::string readFile(const char* path)
+{
+	FILE* file = fopen(path, "r");
+	if ( file == NULL )
+		throwf("can't open %s, errno=%d", path, errno);
+	std::string content;
+	char buffer[4096];
+	size_t len;
+	while ( (len = fread(buffer, 1, sizeof(buffer), file)) > 0 )
+		content.append(buffer, len);
+	fclose(file);
+	return content;
+}
+
+// split the snapshot link command into arguments, arguments containing spaces are quoted
+static std::vector<std::string> readLinkCommand()
+{
+	std::string content = readFile(kLinkCommandFile);
+	std::vector<std::string> args;
+	size_t pos = 0;
+	while ( pos < content.size() ) {
+		while ( (pos < content.size()) && isspace(content[pos]) )
+			++pos;
+		if ( pos == content.size() )
+			break;
+		std::string arg;
+		if ( content[pos] == '"' ) {
+			size_t end = content.find('"', pos+1);
+			if ( end == std::string::npos )
+				throwf("unterminated quote in %s", kLinkCommandFile);
+			arg = content.substr(pos+1, end-pos-1);
+			pos = end+1;
+		}
+		else {
+			size_t end = pos;
+			while ( (end < content.size()) && !isspace(content[end]) )
+				++end;
+			arg = content.substr(pos, end-pos);
+			pos = end;
+		}
+		args.push_back(arg);
+	}
+	if ( args.empty() )
+		throwf("%s is empty", kLinkCommandFile);
+
+	// the arch is recorded separately when it was not on the command line
+	if ( (std::find(args.begin(), args.end(), "-arch") == args.end()) && fileExists(kArchFile) ) {
+		std::string arch = readFile(kArchFile);
+		arch.erase(std::remove_if(arch.begin(), arch.end(), isspace), arch.end());
+		args.push_back("-arch");
+		args.push_back(arch);
+	}
+	return args;
+}
+
+// runs a command, returns its exit status and peak RSS
+static int run(const std::vector<std::string>& args, uint64_t& peakRSS)
+{
+	std::vector<char*> argv;
+	for (const std::string& arg : args)
+		argv.push_back((char*)arg.c_str());
+	argv.push_back(NULL);
+	pid_t pid;
+	int err = posix_spawnp(&pid, argv[0], NULL, NULL, argv.data(), environ);
+	if ( err != 0 )
+		throwf("can't run %s, errno=%d", argv[0], err);
+	int status;
+	struct rusage usage;
+	while ( wait4(pid, &status, 0, &usage) == -1 ) {
+		if ( errno != EINTR )
+			throwf("wait for %s failed, errno=%d", argv[0], errno);
+	}
+	peakRSS = usage.ru_maxrss;
+	if ( !WIFEXITED(status) )
+		return -1;
+	return WEXITSTATUS(status);
+}
+
+// the trace file has one event per line: {"name":"...","cat":"phase","ph":"X","ts":...,"dur":...,...}
+static void parseTrace(Linker& linker, unsigned iteration)
+{
+	std::string content = readFile(kTraceFile);
+	size_t lineStart = 0;
+	while ( lineStart < content.size() ) {
+		size_t lineEnd = content.find('\n', lineStart);
+		if ( lineEnd == std::string::npos )
+			lineEnd = content.size();
+		std::string line = content.substr(lineStart, lineEnd-lineStart);
+		lineStart = lineEnd+1;
+		if ( (line.find("\"cat\":\"phase\"") == std::string::npos) && (line.find("\"cat\":\"pass\"") == std::string::npos) )
+			continue;
+		size_t nameStart = line.find("{\"name\":\"");
+		size_t durStart = line.find("\"dur\":");
+		if ( (nameStart == std::string::npos) || (durStart == std::string::npos) )
+			continue;
+		nameStart += strlen("{\"name\":\"");
+		size_t nameEnd = line.find('"', nameStart);
+		std::string name = line.substr(nameStart, nameEnd-nameStart);
+		double milliseconds = strtod(line.c_str()+durStart+strlen("\"dur\":"), NULL) / 1000.0;
+		std::vector<Timing>::iterator pos = std::find_if(linker.timings.begin(), linker.timings.end(), [&](const Timing& timing) {
+			return ( timing.name == name );
+		});
+		if ( pos == linker.timings.end() ) {
+			linker.timings.push_back(Timing());
+			pos = linker.timings.end()-1;
+			pos->name = name;
+		}
+		pos->milliseconds.resize(iteration+1);
+		pos->milliseconds[iteration] += milliseconds;
+	}
+}
+
+static void linkOnce(Linker& linker, const std::vector<std::string>& linkArgs, unsigned iteration, bool warm)
+{
+	// start each iteration without the caches and outputs of the previous one, unless asked not to
+	if ( !warm && fileExists(kOutputsDir) ) {
+		if ( removefile(kOutputsDir, NULL, REMOVEFILE_RECURSIVE) != 0 )
+			throwf("can't remove %s, errno=%d", kOutputsDir, errno);
+	}
+	mkdir(kOutputsDir, 0755);
+	unlink(kTraceFile);
+
+	std::vector<std::string> args = linkArgs;
+	args[0] = linker.path;
+	args.push_back("-o");
+	args.push_back(kOutputFile);
+	args.push_back("-trace_file");
+	args.push_back(kTraceFile);
+
+	mach_timebase_info_data_t timebaseInfo;
+	mach_timebase_info(&timebaseInfo);
+	uint64_t startTime = mach_absolute_time();
+	uint64_t peakRSS;
+	int status = run(args, peakRSS);
+	uint64_t endTime = mach_absolute_time();
+	if ( status != 0 )
+		throwf("link with %s failed, exit status %d", linker.path, status);
+	linker.wallMilliseconds.push_back((double)(endTime - startTime) * timebaseInfo.numer / timebaseInfo.denom / 1000000.0);
+	linker.peakRSS = std::max(linker.peakRSS, peakRSS);
+	parseTrace(linker, iteration);
+}
+
+static double median(std::vector<double> values)
+{
+	if ( values.empty() )
+		return 0;
+	std::sort(values.begin(), values.end());
+	size_t middle = values.size()/2;
+	if ( (values.size() % 2) == 0 )
+		return (values[middle-1] + values[middle]) / 2;
+	return values[middle];
+}
+
+static double minimum(const std::vector<double>& values)
+{
+	return values.empty() ? 0 : *std::min_element(values.begin(), values.end());
+}
+
+static const Timing* findTiming(const Linker& linker, const std::string& name)
+{
+	for (const Timing& timing : linker.timings) {
+		if ( timing.name == name )
+			return &timing;
+	}
+	return NULL;
+}
+
+static void printRow(const char* name, const std::vector<double>& first, const std::vector<double>* second)
+{
+	printf("%-28s %10.1f %10.1f", name, median(first), minimum(first));
+	if ( second != NULL ) {
+		double baseline = median(first);
+		double other = median(*second);
+		printf(" %10.1f %10.1f", other, minimum(*second));
+		if ( baseline != 0 )
+			printf(" %+8.1f%%", (other - baseline) * 100.0 / baseline);
+	}
+	printf("\n");
+}
+
+static void report(const std::vector<Linker>& linkers, unsigned iterations)
+{
+	const Linker& baseline = linkers[0];
+	const Linker* other = (linkers.size() > 1) ? &linkers[1] : NULL;
+	printf("%u iterations, times in milliseconds\n", iterations);
+	printf("ld #1: %s\n", baseline.path);
+	if ( other != NULL )
+		printf("ld #2: %s\n", other->path);
+	printf("%-28s %10s %10s", "", "median #1", "min #1");
+	if ( other != NULL )
+		printf(" %10s %10s %9s", "median #2", "min #2", "change");
+	printf("\n");
+	printRow("wall time", baseline.wallMilliseconds, other ? &other->wallMilliseconds : NULL);
+	for (const Timing& timing : baseline.timings) {
+		const Timing* otherTiming = other ? findTiming(*other, timing.name) : NULL;
+		printRow(timing.name.c_str(), timing.milliseconds, otherTiming ? &otherTiming->milliseconds : NULL);
+	}
+	// phases only the second linker reports
+	if ( other != NULL ) {
+		for (const Timing& timing : other->timings) {
+			if ( findTiming(baseline, timing.name) == NULL )
+				printf("%-28s %10s %10s %10.1f %10.1f\n", timing.name.c_str(), "-", "-", median(timing.milliseconds), minimum(timing.milliseconds));
+		}
+	}
+	printf("%-28s %10llu", "peak RSS (KB)", baseline.peakRSS/1024);
+	if ( other != NULL ) {
+		printf(" %10s %10llu", "", other->peakRSS/1024);
+		if ( baseline.peakRSS != 0 )
+			printf(" %+8.1f%%", ((double)other->peakRSS - (double)baseline.peakRSS) * 100.0 / baseline.peakRSS);
+	}
+	printf("\n");
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: ld-bench [-n <iterations>] [-warm] [-ld <linker>] [-ld <other-linker>] <snapshot-dir>\n");
+	exit(1);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	unsigned iterations = 5;
+	bool warm = false;
+	const char* snapshotDir = NULL;
+	std::vector<Linker> linkers;
+
+	try {
+		for(int i=1; i < argc; ++i) {
+			const char* arg = argv[i];
+			if ( strcmp(arg, "-n") == 0 ) {
+				if ( ++i == argc )
+					usage();
+				iterations = (unsigned)strtoul(argv[i], NULL, 0);
+				if ( iterations == 0 )
+					throwf("-n must be at least 1");
+			}
+			else if ( strcmp(arg, "-warm") == 0 ) {
+				warm = true;
+			}
+			else if ( strcmp(arg, "-ld") == 0 ) {
+				if ( ++i == argc )
+					usage();
+				if ( linkers.size() == 2 )
+					throwf("at most two linkers can be compared");
+				Linker linker;
+				linker.path = argv[i];
+				linker.peakRSS = 0;
+				linkers.push_back(linker);
+			}
+			else if ( (arg[0] != '-') && (snapshotDir == NULL) ) {
+				snapshotDir = arg;
+			}
+			else {
+				usage();
+			}
+		}
+		if ( snapshotDir == NULL )
+			usage();
+		if ( linkers.empty() ) {
+			Linker linker;
+			linker.path = "ld";
+			linker.peakRSS = 0;
+			linkers.push_back(linker);
+		}
+		// make relative linker paths independent of the snapshot directory
+		for (Linker& linker : linkers) {
+			if ( strchr(linker.path, '/') != NULL ) {
+				char* resolved = realpath(linker.path, NULL);
+				if ( resolved == NULL )
+					throwf("can't find linker %s", linker.path);
+				linker.path = resolved;
+			}
+		}
+
+		if ( chdir(snapshotDir) != 0 )
+			throwf("can't change to snapshot directory %s, errno=%d", snapshotDir, errno);
+		if ( !fileExists(kLinkCommandFile) )
+			throwf("%s is not a link snapshot, it has no %s", snapshotDir, kLinkCommandFile);
+
+		// build the stub dylibs the snapshot links against once
+		if ( (fileExists("dylib_stubs") && !fileExists("dylibs")) || (fileExists("framework_stubs") && !fileExists("frameworks")) ) {
+			uint64_t unusedRSS;
+			std::vector<std::string> compileStubs = { std::string("./") + kCompileStubsFile };
+			if ( run(compileStubs, unusedRSS) != 0 )
+				throwf("%s failed", kCompileStubsFile);
+		}
+
+		std::vector<std::string> linkArgs = readLinkCommand();
+		// a -warm hit in the whole-link cache would skip the link being measured
+		for (std::vector<std::string>::iterator it = linkArgs.begin(); it != linkArgs.end(); ) {
+			if ( (*it == "-incremental_cache_path") && (it+1 != linkArgs.end()) )
+				it = linkArgs.erase(it, it+2);
+			else
+				++it;
+		}
+
+		// alternate between the linkers so that machine noise affects both alike
+		for (unsigned iteration=0; iteration < iterations; ++iteration) {
+			for (Linker& linker : linkers)
+				linkOnce(linker, linkArgs, iteration, warm);
+		}
+		report(linkers, iterations);
+	}
+	catch (const char* msg) {
+		fprintf(stderr, "ld-bench failed: %s\n", msg);
+		return 1;
+	}
+
+	return 0;
+}
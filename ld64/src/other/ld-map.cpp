@@ -0,0 +1,346 @@
+/* -*- mode: C++; c-basic-offset: 4; tab-width: 4 -*-
+ *
+ * Copyright (c) 2026 Apple Inc. All rights reserved.
+ *
+ * @APPLE_LICENSE_HEADER_START@
+ *
+ * This file contains Original Code and/or Modifications of Original Code
+ * as defined in and that are subject to the Apple Public Source License
+ * Version 2.0 (the 'License'). You may not use this file except in
+ * compliance with the License. Please obtain a copy of the License at
+ * http://www.opensource.apple.com/apsl/ and read it before using this
+ * file.
+ *
+ * The Original Code and all software distributed under the License are
+ * distributed on an 'AS IS' basis, WITHOUT WARRANTY OF ANY KIND, EITHER
+ * EXPRESS OR IMPLIED, AND APPLE HEREBY DISCLAIMS ALL SUCH WARRANTIES,
+ * INCLUDING WITHOUT LIMITATION, ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, QUIET ENJOYMENT OR NON-INFRINGEMENT.
+ * Please see the License for the specific language governing rights and
+ * limitations under the License.
+ *
+ * @APPLE_LICENSE_HEADER_END@
+ */
+
+//
+// ld-map answers size questions about a link from the file written by -binary_map:
+// the largest symbols, or the sizes attributed to each file, archive or section,
+// and why a symbol was kept when dead stripping.
+//
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+#include "BinaryMap.h"
+
+
+ __attribute__((noreturn, format(printf, 1, 2)))
+void throwf(const char* format, ...)
+{
+	va_list	list;
+	char*	p;
+	va_start(list, format);
+	vasprintf(&p, format, list);
+	va_end(list);
+
+	const char*	t = p;
+	throw t;
+}
+
+
+class BinaryMap
+{
+public:
+								BinaryMap(const char* path);
+
+	uint32_t					atomCount() const		{ return _header->atomCount; }
+	bool						isDead(uint32_t i) const	{ return (_sectionIndexes[i] == ld::binarymap::kNone); }
+	uint64_t					address(uint32_t i) const	{ return _addresses[i]; }
+	uint64_t					size(uint32_t i) const	{ return _sizes[i]; }
+	const char*					name(uint32_t i) const	{ return string(_names[i]); }
+	const char*					filePath(uint32_t i) const	{ return string(_files[_fileIndexes[i]]); }
+	const char*					sectionName(uint32_t i) const;
+	uint32_t					aliasOf(uint32_t i) const	{ return _aliasOf[i]; }
+	uint32_t					liveReferrer(uint32_t i) const	{ return _liveReferrers[i]; }
+	const char*					outputPath() const		{ return string(_header->outputPath); }
+	const char*					arch() const			{ return string(_header->arch); }
+
+private:
+	template <typename T>
+	const T*					table(uint64_t offset, uint64_t count) const;
+	const char*					string(uint32_t offset) const;
+
+	const uint8_t*						_content;
+	uint64_t							_length;
+	const ld::binarymap::Header*		_header;
+	const ld::binarymap::Section*		_sections;
+	const uint32_t*						_files;
+	const uint64_t*						_addresses;
+	const uint64_t*						_sizes;
+	const uint32_t*						_names;
+	const uint32_t*						_sectionIndexes;
+	const uint32_t*						_fileIndexes;
+	const uint32_t*						_aliasOf;
+	const uint32_t*						_liveReferrers;
+	std::vector<std::string>			_sectionNames;
+};
+
+BinaryMap::BinaryMap(const char* path)
+{
+	int fd = ::open(path, O_RDONLY, 0);
+	if ( fd == -1 )
+		throwf("can't open file %s, errno=%d", path, errno);
+	struct stat stat_buf;
+	if ( fstat(fd, &stat_buf) != 0 )
+		throwf("fstat(%s) failed, errno=%d\n", path, errno);
+	_length = stat_buf.st_size;
+	if ( _length < sizeof(ld::binarymap::Header) )
+		throwf("%s is not a binary map file", path);
+	_content = (uint8_t*)::mmap(NULL, _length, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+	if ( _content == (uint8_t*)(-1) )
+		throwf("can't map file %s, errno=%d", path, errno);
+	::close(fd);
+
+	_header = (ld::binarymap::Header*)_content;
+	if ( memcmp(_header->magic, ld::binarymap::kMagic, sizeof(_header->magic)) != 0 )
+		throwf("%s is not a binary map file", path);
+	if ( _header->version != ld::binarymap::kVersion )
+		throwf("%s is binary map version %u, only version %u is supported", path, _header->version, ld::binarymap::kVersion);
+	if ( (_header->stringsOffset > _length) || (_header->stringsSize > _length - _header->stringsOffset) )
+		throwf("%s is truncated", path);
+	const uint32_t atomCount = _header->atomCount;
+	_sections		= table<ld::binarymap::Section>(_header->sectionsOffset, _header->sectionCount);
+	_files			= table<uint32_t>(_header->filesOffset, _header->fileCount);
+	_addresses		= table<uint64_t>(_header->addressesOffset, atomCount);
+	_sizes			= table<uint64_t>(_header->sizesOffset, atomCount);
+	_names			= table<uint32_t>(_header->namesOffset, atomCount);
+	_sectionIndexes	= table<uint32_t>(_header->sectionIndexesOffset, atomCount);
+	_fileIndexes	= table<uint32_t>(_header->fileIndexesOffset, atomCount);
+	_aliasOf		= table<uint32_t>(_header->aliasOfOffset, atomCount);
+	_liveReferrers	= table<uint32_t>(_header->liveReferrersOffset, atomCount);
+	for (uint32_t i=0; i < _header->sectionCount; ++i)
+		_sectionNames.push_back(std::string(string(_sections[i].segmentName)) + "," + string(_sections[i].sectionName));
+	for (uint32_t i=0; i < atomCount; ++i) {
+		if ( (_fileIndexes[i] >= _header->fileCount) || (!isDead(i) && (_sectionIndexes[i] >= _header->sectionCount)) )
+			throwf("%s has a bad file or section index for atom %u", path, i);
+		if ( ((_aliasOf[i] != ld::binarymap::kNone) && (_aliasOf[i] >= atomCount))
+		  || ((_liveReferrers[i] != ld::binarymap::kNone) && (_liveReferrers[i] >= atomCount)) )
+			throwf("%s has a bad atom index for atom %u", path, i);
+	}
+}
+
+template <typename T>
+const T* BinaryMap::table(uint64_t offset, uint64_t count) const
+{
+	if ( (offset > _length) || (count > (_length - offset)/sizeof(T)) || ((offset % alignof(T)) != 0) )
+		throwf("binary map file is truncated");
+	return (const T*)&_content[offset];
+}
+
+const char* BinaryMap::string(uint32_t offset) const
+{
+	if ( offset >= _header->stringsSize )
+		return "";
+	return (const char*)&_content[_header->stringsOffset + offset];
+}
+
+const char* BinaryMap::sectionName(uint32_t i) const
+{
+	if ( isDead(i) )
+		return "<<dead>>";
+	return _sectionNames[_sectionIndexes[i]].c_str();
+}
+
+
+enum GroupBy { groupBySymbol, groupByFile, groupByArchive, groupBySection };
+
+// archive members are recorded as "libfoo.a(bar.o)", group them under "libfoo.a"
+static std::string archivePath(const char* path)
+{
+	size_t len = strlen(path);
+	if ( (len > 0) && (path[len-1] == ')') ) {
+		if ( const char* paren = strrchr(path, '(') )
+			return std::string(path, paren - path);
+	}
+	return path;
+}
+
+static void printTop(const BinaryMap& map, GroupBy groupBy, bool dead, unsigned topCount)
+{
+	uint64_t total = 0;
+	if ( groupBy == groupBySymbol ) {
+		std::vector<uint32_t> atoms;
+		for (uint32_t i=0; i < map.atomCount(); ++i) {
+			if ( map.isDead(i) != dead )
+				continue;
+			if ( map.size(i) == 0 )
+				continue;
+			atoms.push_back(i);
+			total += map.size(i);
+		}
+		const size_t count = std::min((size_t)topCount, atoms.size());
+		std::partial_sort(atoms.begin(), atoms.begin()+count, atoms.end(), [&](uint32_t left, uint32_t right) {
+			if ( map.size(left) != map.size(right) )
+				return ( map.size(left) > map.size(right) );
+			return ( left < right );
+		});
+		printf("%12s %6s  %-24s %s\n", "size", "%", "section", "symbol [file]");
+		for (size_t i=0; i < count; ++i) {
+			uint32_t atom = atoms[i];
+			printf("%12llu %5.1f%%  %-24s %s [%s]\n", map.size(atom), (total != 0) ? map.size(atom)*100.0/total : 0.0,
+					map.sectionName(atom), map.name(atom), map.filePath(atom));
+		}
+	}
+	else {
+		std::unordered_map<std::string, uint64_t> sizes;
+		for (uint32_t i=0; i < map.atomCount(); ++i) {
+			if ( map.isDead(i) != dead )
+				continue;
+			switch ( groupBy ) {
+				case groupByFile:
+					sizes[map.filePath(i)] += map.size(i);
+					break;
+				case groupByArchive:
+					sizes[archivePath(map.filePath(i))] += map.size(i);
+					break;
+				case groupBySection:
+					sizes[map.sectionName(i)] += map.size(i);
+					break;
+				case groupBySymbol:
+					break;
+			}
+			total += map.size(i);
+		}
+		std::vector<std::pair<std::string, uint64_t>> groups(sizes.begin(), sizes.end());
+		const size_t count = std::min((size_t)topCount, groups.size());
+		std::partial_sort(groups.begin(), groups.begin()+count, groups.end(), [](const std::pair<std::string, uint64_t>& left,
+																				 const std::pair<std::string, uint64_t>& right) {
+			if ( left.second != right.second )
+				return ( left.second > right.second );
+			return ( left.first < right.first );
+		});
+		printf("%12s %6s  %s\n", "size", "%", (groupBy == groupBySection) ? "section" : "file");
+		for (size_t i=0; i < count; ++i) {
+			printf("%12llu %5.1f%%  %s\n", groups[i].second, (total != 0) ? groups[i].second*100.0/total : 0.0,
+					groups[i].first.empty() ? "linker synthesized" : groups[i].first.c_str());
+		}
+	}
+	printf("%12llu total %s\n", total, dead ? "dead stripped" : "in output");
+}
+
+static void printWhyLive(const BinaryMap& map, const char* symbolName)
+{
+	bool found = false;
+	for (uint32_t i=0; i < map.atomCount(); ++i) {
+		if ( strcmp(map.name(i), symbolName) != 0 )
+			continue;
+		found = true;
+		if ( map.isDead(i) ) {
+			printf("%s from %s was dead stripped\n", map.name(i), map.filePath(i));
+			continue;
+		}
+		// follow the referrer chain back to a dead strip root, guarding against cycles
+		std::vector<uint32_t> chain;
+		for (uint32_t atom = i; atom != ld::binarymap::kNone; atom = map.liveReferrer(atom)) {
+			if ( std::find(chain.begin(), chain.end(), atom) != chain.end() )
+				break;
+			chain.push_back(atom);
+		}
+		int depth = 0;
+		for (uint32_t atom : chain) {
+			for (int d=depth; d > 0; --d)
+				printf("  ");
+			printf("%s from %s\n", map.name(atom), map.filePath(atom));
+			++depth;
+		}
+		if ( map.aliasOf(i) != ld::binarymap::kNone )
+			printf("%s is an alias of %s\n", map.name(i), map.name(map.aliasOf(i)));
+	}
+	if ( !found )
+		throwf("symbol %s not found in binary map", symbolName);
+}
+
+static void usage()
+{
+	fprintf(stderr, "usage: ld-map [-top <count>] [-by symbol|file|archive|section] [-dead] [-why_live <symbol>] <binary-map-file>\n");
+	exit(1);
+}
+
+
+int main(int argc, const char* argv[])
+{
+	unsigned topCount = 20;
+	GroupBy groupBy = groupBySymbol;
+	bool dead = false;
+	const char* whyLiveSymbol = NULL;
+	const char* path = NULL;
+
+	try {
+		for(int i=1; i < argc; ++i) {
+			const char* arg = argv[i];
+			if ( strcmp(arg, "-top") == 0 ) {
+				if ( ++i == argc )
+					usage();
+				topCount = (unsigned)strtoul(argv[i], NULL, 0);
+			}
+			else if ( strcmp(arg, "-by") == 0 ) {
+				if ( ++i == argc )
+					usage();
+				const char* by = argv[i];
+				if ( strcmp(by, "symbol") == 0 )
+					groupBy = groupBySymbol;
+				else if ( strcmp(by, "file") == 0 )
+					groupBy = groupByFile;
+				else if ( strcmp(by, "archive") == 0 )
+					groupBy = groupByArchive;
+				else if ( strcmp(by, "section") == 0 )
+					groupBy = groupBySection;
+				else
+					throwf("unknown -by value: %s", by);
+			}
+			else if ( strcmp(arg, "-dead") == 0 ) {
+				dead = true;
+			}
+			else if ( strcmp(arg, "-why_live") == 0 ) {
+				if ( ++i == argc )
+					usage();
+				whyLiveSymbol = argv[i];
+			}
+			else if ( (arg[0] != '-') && (path == NULL) ) {
+				path = arg;
+			}
+			else {
+				usage();
+			}
+		}
+		if ( path == NULL )
+			usage();
+
+		BinaryMap map(path);
+		printf("# Path: %s\n", map.outputPath());
+		printf("# Arch: %s\n", map.arch());
+		if ( whyLiveSymbol != NULL )
+			printWhyLive(map, whyLiveSymbol);
+		else
+			printTop(map, groupBy, dead, topCount);
+	}
+	catch (const char* msg) {
+		fprintf(stderr, "ld-map failed: %s\n", msg);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,10 @@
+#include <stdio.h>
+
+// large enough that the image is measured in several chunks
+static char big[0x300000] = { 1 };
+
+int main()
+{
+	printf("%d\n", big[0]);
+	return 0;
+}
@@ -0,0 +1,7 @@
+extern int foo();
+extern int baz();
+
+int main()
+{
+	return foo() + baz();
+}
@@ -0,0 +1,8 @@
+#ifndef RESULT
+  #define RESULT 1
+#endif
+
+int main()
+{
+	return RESULT;
+}
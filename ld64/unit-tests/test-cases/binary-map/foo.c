@@ -0,0 +1,9 @@
+int foo(void)
+{
+	return 0;
+}
+
+int bar(void)
+{
+	return 1;
+}
@@ -0,0 +1,3 @@
+#define TYPE unsigned
+#define HELPER bar_helper
+#include "funcs.h"
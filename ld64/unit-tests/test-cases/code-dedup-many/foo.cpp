@@ -0,0 +1,3 @@
+#define TYPE int
+#define HELPER foo_helper
+#include "funcs.h"
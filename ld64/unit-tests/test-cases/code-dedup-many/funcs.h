@@ -0,0 +1,13 @@
+// The int and unsigned instantiations compile to identical code, so every
+// step<> below has a duplicate with a different name but the same size as
+// many non-identical neighbours.
+template<typename T, int N>
+__attribute__((noinline)) T step(T a) { return (a * N) ^ (a + N); }
+
+#define STEPS(x) step<TYPE, x>(a) + step<TYPE, x+1>(a) + step<TYPE, x+2>(a) + step<TYPE, x+3>(a)
+
+TYPE HELPER(TYPE a)
+{
+	return STEPS(1) + STEPS(10) + STEPS(20) + STEPS(30) + STEPS(40)
+	     + STEPS(50) + STEPS(60) + STEPS(70) + STEPS(80) + STEPS(90);
+}
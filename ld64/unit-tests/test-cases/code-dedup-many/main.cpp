@@ -0,0 +1,7 @@
+int foo_helper(int);
+unsigned bar_helper(unsigned);
+
+int main()
+{
+	return foo_helper(1) + (int)bar_helper(2);
+}
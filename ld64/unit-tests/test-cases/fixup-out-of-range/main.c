@@ -0,0 +1,7 @@
+// referenced pc-relative, not through the GOT, because it is static
+static volatile int farData __attribute__((section("__FAR,__data"))) = 1;
+
+int main()
+{
+	return farData;
+}
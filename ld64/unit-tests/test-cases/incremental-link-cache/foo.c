@@ -0,0 +1,13 @@
+int __attribute__((visibility("hidden"))) hidden_foo()
+{
+	return 2;
+}
+
+int foo()
+{
+#if CHANGED
+	return 1;
+#else
+	return 0;
+#endif
+}
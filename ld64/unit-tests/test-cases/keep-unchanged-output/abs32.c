@@ -0,0 +1,9 @@
+int value = 1;
+
+// a 32-bit absolute pointer, which only fits if the image is below 4GB
+__asm__(".data\n_value32: .long _value\n");
+
+int main()
+{
+	return 0;
+}
@@ -0,0 +1,2 @@
+int foo(int x) { return x + 1; }
+int bar(int x) { return x * 2; }
@@ -0,0 +1,3 @@
+extern int foo(int);
+
+int main() { return foo(1); }
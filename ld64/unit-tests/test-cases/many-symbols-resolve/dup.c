@@ -0,0 +1 @@
+int g17(void) { return 0; }
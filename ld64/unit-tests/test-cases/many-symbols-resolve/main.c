@@ -0,0 +1,6 @@
+extern int f1(void);
+
+int main()
+{
+	return f1();
+}
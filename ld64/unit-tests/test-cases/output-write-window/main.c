@@ -0,0 +1,9 @@
+#include <stdio.h>
+
+static char buffer[0x20000] = { 1 };
+
+int main()
+{
+	printf("%d\n", buffer[0]);
+	return 0;
+}
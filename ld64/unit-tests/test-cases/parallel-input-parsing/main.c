@@ -0,0 +1,7 @@
+extern int left();
+extern int right();
+
+int main()
+{
+	return left() + right();
+}
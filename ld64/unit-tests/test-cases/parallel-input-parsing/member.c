@@ -0,0 +1 @@
+int NAME() { return 0; }
@@ -25,7 +25,8 @@ class FileManager;
 
 class InterfaceFileManager {
 public:
-  InterfaceFileManager(FileManager &fm, bool isVolatile);
+  InterfaceFileManager(FileManager &fm, bool isVolatile,
+                       unsigned numThreads = 1);
   Expected<APIs &> readFile(const std::string &path);
   Error writeFile(const std::string &path, const InterfaceFile *file,
                   FileType fileType) const;
@@ -27,7 +27,8 @@ TAPI_NAMESPACE_INTERNAL_BEGIN
 
 class MachODylibReader final : public Reader {
 public:
-  MachODylibReader() : Reader(Binary) {}
+  explicit MachODylibReader(unsigned numThreads = 1)
+      : Reader(Binary), numThreads(numThreads) {}
   bool canRead(file_magic magic, MemoryBufferRef bufferRef,
                FileType types) const override;
   Expected<FileType> getFileType(file_magic magic,
@@ -39,6 +40,9 @@ public:
   static bool classof(const Reader *reader) {
     return reader->getKind() == Binary;
   }
+
+private:
+  unsigned numThreads;
 };
 
 TAPI_NAMESPACE_INTERNAL_END
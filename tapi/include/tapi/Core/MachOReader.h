@@ -30,6 +30,8 @@ struct MachOParseOption {
   bool parseSymbolTable = true;
   bool parseObjCMetadata = true;
   bool parseUndefined = true;
+  /// Read up to numThreads architecture slices at the same time.
+  unsigned numThreads = 1;
 };
 
 /// Returns macho file type. Unknown if the format is not supported.
@@ -46,8 +48,11 @@ std::vector<llvm::Triple>
 constructTripleFromMachO(llvm::object::MachOObjectFile *object);
 
 using SymbolToSourceLocMap = llvm::StringMap<APILoc>;
+/// Look up the source locations of the exported symbols in the dSYM's debug
+/// info, spreading the compile units over up to numThreads threads.
 SymbolToSourceLocMap accumulateSourceLocFromDSYM(const StringRef dSYMFile,
-                                                 const Target &triple);
+                                                 const Target &triple,
+                                                 unsigned numThreads = 1);
 
 TAPI_NAMESPACE_INTERNAL_END
 
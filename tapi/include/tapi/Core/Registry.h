@@ -103,7 +103,9 @@ public:
     _writers.emplace_back(std::move(writer));
   }
 
-  void addBinaryReaders();
+  /// Binary readers read up to numThreads architecture slices of a universal
+  /// file at the same time.
+  void addBinaryReaders(unsigned numThreads = 1);
   void addYAMLReaders();
   void addYAMLWriters();
   void addDiagnosticReader();
@@ -72,12 +72,23 @@ private:
   APIs coverageSymbols;
   std::map<SimpleSymbol, SimpleSymbol> aliases;
   const StringRef dSYMPath;
+  unsigned numThreads = 1;
   std::unique_ptr<SymbolSet> exports;
   bool verifiedSwift;
   VerifierContext ctx;
   struct SymbolContext;
   std::map<std::string, APIInfo> ignoredZipperedRecords;
 
+  // Records collected by a deferred verifier, see createDeferred().
+  enum class DeferredKind { Global, ObjCInterface, ObjCInstanceVariable };
+  struct DeferredRecord {
+    DeferredKind kind;
+    const APIRecord *record;
+    std::string superClass;
+  };
+  bool deferred = false;
+  std::vector<DeferredRecord> deferredRecords;
+
   bool canVerify(const APIRecord *record, SymbolContext &ctx);
   Result checkVisibility(const APIRecord *dRecord, const APIRecord *record,
                          SymbolContext &symCtx);
@@ -141,6 +152,9 @@ public:
 
   Result getFrontendState() const { return ctx.frontendState; }
 
+  /// Use up to numThreads threads to look up source locations in the dSYM.
+  void setNumThreads(unsigned threads) { numThreads = threads; }
+
   /// Compare remaining symbols for target slice.
   Result verifyRemainingSymbols(Architecture arch);
 
@@ -148,6 +162,15 @@ public:
   Result verify(const ObjCInterfaceRecord *record);
   Result verify(const ObjCInstanceVariableRecord *record, StringRef superClass);
 
+  /// Create a verifier that only collects the records it is asked to verify,
+  /// so a frontend job can run on its own thread. The records are verified
+  /// afterwards, in order, with verifyDeferred.
+  static std::unique_ptr<SymbolVerifier> createDeferred();
+
+  /// Verify the records collected by a deferred verifier for the current
+  /// target.
+  Result verifyDeferred(const SymbolVerifier &other);
+
   // Check all symbols in swift interface are in dylib, this is done for all
   // targets.
   Result verifySwift();
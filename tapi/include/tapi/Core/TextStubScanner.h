@@ -0,0 +1,48 @@
+//===- tapi/Core/TextStubScanner.h - Text Stub Scanner ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Fast reader for text-based stub files in the TBD v4 YAML format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef TAPI_CORE_TEXT_STUB_SCANNER_H
+#define TAPI_CORE_TEXT_STUB_SCANNER_H
+
+#include "tapi/Core/LLVM.h"
+#include "tapi/Defines.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/TextAPI/InterfaceFile.h"
+#include <memory>
+
+TAPI_NAMESPACE_INTERNAL_BEGIN
+
+/// \brief Check if the first document in the buffer carries the TBD v4 tag.
+///
+/// This only looks at the document start and doesn't validate the document.
+bool hasTextStubV4Tag(MemoryBufferRef bufferRef);
+
+/// \brief Read TBD v4 documents in a single pass without building a YAML node
+///        tree.
+///
+/// The scanner understands the block and flow layout text-based stubs are
+/// written in. Strings point into the buffer until they are added to the
+/// interface file; only quoted strings with escapes are copied. Anything
+/// outside of that subset, including malformed input, yields nullptr and is
+/// left to the generic reader, which also produces the diagnostics.
+std::unique_ptr<InterfaceFile> scanTextStub(MemoryBufferRef bufferRef);
+
+/// \brief Read a text-based stub file, trying the scanner before the generic
+///        YAML reader.
+llvm::Expected<std::unique_ptr<InterfaceFile>>
+readTextStub(MemoryBufferRef bufferRef);
+
+TAPI_NAMESPACE_INTERNAL_END
+
+#endif // TAPI_CORE_TEXT_STUB_SCANNER_H
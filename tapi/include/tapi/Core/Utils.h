@@ -17,6 +17,7 @@
 #include "tapi/Core/LLVM.h"
 #include "tapi/Defines.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Process.h"
 #include "llvm/TextAPI/InterfaceFile.h"
@@ -78,6 +79,12 @@ struct SimpleSymbol {
 
 SimpleSymbol parseSymbol(StringRef symbolName);
 
+/// Call task(0) ... task(count - 1) on up to numThreads threads and wait for
+/// all of them to finish. With a single thread the tasks run in order on the
+/// calling thread.
+void runConcurrently(unsigned numThreads, size_t count,
+                     llvm::function_ref<void(size_t)> task);
+
 TAPI_NAMESPACE_INTERNAL_END
 
 #endif // TAPI_CORE_UTILS_H
@@ -86,6 +86,9 @@ struct DriverOptions {
 
   /// Clang executable path.
   std::string clangExecutablePath;
+
+  /// Number of frontend jobs and binary reads to run in parallel.
+  unsigned numThreads = 1;
 };
 
 struct ArchiveOptions {
@@ -25,7 +25,8 @@
 
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
-struct FrontendJob {
+/// The settings of a frontend job, which copies of the job share.
+struct FrontendJobSettings {
   IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs;
   llvm::Triple target;
   clang::Language language = clang::Language::Unknown;
@@ -56,8 +57,14 @@ struct FrontendJob {
   std::vector<std::string> clangExtraArgs;
   HeaderType type;
   llvm::Optional<std::string> clangExecutablePath;
+};
+
+struct FrontendJob : FrontendJobSettings {
   std::unique_ptr<SymbolVerifier> verifier =
       std::make_unique<SymbolVerifier>(SymbolVerifier());
+  /// Where clang diagnostics and verbose output go, llvm::errs() if not set.
+  /// Only used while the job runs, so it is not copied.
+  llvm::raw_ostream *diagnosticStream = nullptr;
 };
 
 extern llvm::Expected<FrontendContext>
@@ -65,6 +72,24 @@ runFrontend(const FrontendJob &job, StringRef inputFilename = StringRef());
 
 bool canIgnoreFrontendError(llvm::Error &error);
 
+/// Copy the settings of a job. The copy gets a default symbol verifier and no
+/// diagnostic stream, so that the copies can run concurrently.
+std::unique_ptr<FrontendJob> copyFrontendJob(const FrontendJob &job);
+
+/// A frontend job to run on its own thread, and its result.
+struct FrontendTask {
+  std::unique_ptr<FrontendJob> job;
+  llvm::Optional<FrontendContext> result;
+  /// Set if the job failed with an error that cannot be ignored.
+  bool failed = false;
+  /// The clang diagnostics of the job. Concurrent tasks would interleave them,
+  /// so the caller prints them in task order.
+  std::string diagnostics;
+};
+
+/// Run the job of the task and record its result and diagnostics.
+void runFrontendTask(FrontendTask &task);
+
 TAPI_NAMESPACE_INTERNAL_END
 
 #endif // TAPI_FRONTEND_FRONTEND_H
@@ -128,6 +128,11 @@ public:
   /// Parses the content of the file with the given constrains for cpu type,
   /// cpu sub-type, flags, and minimum deployment version.
   ///
+  /// When the TAPI_LINKER_CACHE_DIR environment variable names a directory,
+  /// the parsed file is kept there in a binary form keyed by the file
+  /// contents, and later calls for the same contents map it instead of parsing
+  /// the file again.
+  ///
   /// \param[in] path path to the file.
   /// \param[in] cpuType The cpu type / architecture to check the file for.
   /// \param[in] cpuSubType The cpu sub type / sub architecture to check the
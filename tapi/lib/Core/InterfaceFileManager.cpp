@@ -23,11 +23,12 @@ using namespace llvm;
 TAPI_NAMESPACE_INTERNAL_BEGIN
 
 InterfaceFileManager::InterfaceFileManager(FileManager &fm,
-                                           const bool isVolatile)
+                                           const bool isVolatile,
+                                           unsigned numThreads)
     : _fm(fm), isVolatile(isVolatile) {
   _registry.addYAMLReaders();
   _registry.addYAMLWriters();
-  _registry.addBinaryReaders();
+  _registry.addBinaryReaders(numThreads);
   _registry.addJSONReaders();
   _registry.addJSONWriters();
 }
@@ -57,6 +57,7 @@ MachODylibReader::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                            ReadFlags readFlags, ArchitectureSet arches) const {
   MachOParseOption option;
   option.arches = arches;
+  option.numThreads = numThreads;
   if (readFlags < ReadFlags::ObjCMetadata)
     option.parseObjCMetadata = false;
   if (readFlags < ReadFlags::Symbols) {
@@ -12,7 +12,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "tapi/Core/MachOReader.h"
+#include "tapi/Core/Utils.h"
 #include "tapi/ObjCMetadata/ObjCMachOBinary.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/Magic.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
@@ -199,10 +201,33 @@ static Error readMachOHeader(MachOObjectFile *object, API &api) {
 static void DWARFErrorHandler(Error err) { /**/
 }
 
-static SymbolToSourceLocMap
-accumulateLocs(MachOObjectFile &obj,
-               const std::unique_ptr<DWARFContext> &diCtx) {
-  SymbolToSourceLocMap locMap;
+namespace {
+
+struct ExportedSymbol {
+  StringRef name;
+  uint64_t address;
+  bool isFunction;
+  uint64_t unitOffset;
+  size_t unitIndex;
+};
+
+} // end anonymous namespace.
+
+static std::unique_ptr<DWARFContext> createDWARFContext(MachOObjectFile &obj) {
+  return DWARFContext::create(obj,
+                              DWARFContext::ProcessDebugRelocations::Process,
+                              nullptr, "", DWARFErrorHandler,
+                              DWARFErrorHandler);
+}
+
+static SymbolToSourceLocMap accumulateLocs(MachOObjectFile &obj,
+                                           unsigned numThreads) {
+  auto diCtx = createDWARFContext(obj);
+
+  // Find the compile unit of every exported symbol. This only needs the
+  // address ranges of the units.
+  std::vector<ExportedSymbol> symbols;
+  std::vector<uint64_t> unitOffsets;
   for (const auto &symbol : obj.symbols()) {
     auto flagsOrErr = symbol.getFlags();
     if (!flagsOrErr) {
@@ -229,31 +254,75 @@ accumulateLocs(MachOObjectFile &obj,
       consumeError(typeOrErr.takeError());
       continue;
     }
-    const auto type = *typeOrErr;
-    const DWARFDie &die = (type & SymbolRef::ST_Function)
-                              ? dwarfCU->getSubroutineForAddress(address)
-                              : dwarfCU->getVariableForAddress(address);
-    const auto file = die.getDeclFile(
-        llvm::DILineInfoSpecifier::FileLineInfoKind::AbsoluteFilePath);
-    const auto line = die.getDeclLine();
 
     auto nameOrErr = symbol.getName();
     if (!nameOrErr) {
       consumeError(nameOrErr.takeError());
       continue;
     }
-    auto name = *nameOrErr;
-    auto [symName, _] = parseSymbol(name);
+    auto [symName, _] = parseSymbol(*nameOrErr);
+
+    symbols.push_back({symName, address,
+                       static_cast<bool>(*typeOrErr & SymbolRef::ST_Function),
+                       dwarfCU->getOffset(), 0});
+    unitOffsets.push_back(dwarfCU->getOffset());
+  }
+
+  llvm::sort(unitOffsets);
+  unitOffsets.erase(std::unique(unitOffsets.begin(), unitOffsets.end()),
+                    unitOffsets.end());
+  for (auto &symbol : symbols)
+    symbol.unitIndex =
+        llvm::lower_bound(unitOffsets, symbol.unitOffset) - unitOffsets.begin();
+
+  // Looking up the declarations extracts the DIEs and the line table of each
+  // compile unit, which is where the time goes on large dSYMs. The context
+  // parses all of that lazily and isn't thread safe, so every chunk of units
+  // gets a context of its own.
+  const size_t numChunks =
+      std::min<size_t>(std::max(numThreads, 1U), unitOffsets.size());
+  std::vector<std::pair<std::string, uint64_t>> locs(symbols.size());
+  runConcurrently(numThreads, numChunks, [&](size_t chunk) {
+    // The first chunk reuses the context that already found the units.
+    std::unique_ptr<DWARFContext> chunkCtx;
+    auto *ctx = diCtx.get();
+    if (chunk != 0) {
+      chunkCtx = createDWARFContext(obj);
+      ctx = chunkCtx.get();
+    }
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+      const auto &symbol = symbols[i];
+      if (symbol.unitIndex % numChunks != chunk)
+        continue;
+
+      auto *dwarfCU = ctx->getCompileUnitForOffset(symbol.unitOffset);
+      if (!dwarfCU)
+        continue;
 
+      auto die = symbol.isFunction
+                     ? dwarfCU->getSubroutineForAddress(symbol.address)
+                     : dwarfCU->getVariableForAddress(symbol.address);
+      locs[i] = {die.getDeclFile(DILineInfoSpecifier::FileLineInfoKind::
+                                     AbsoluteFilePath),
+                 die.getDeclLine()};
+    }
+  });
+
+  // Later symbols with the same name win, as they did when reading serially.
+  SymbolToSourceLocMap locMap;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    const auto &[file, line] = locs[i];
     if (!file.empty() && line != 0)
-      locMap[symName.str()] = APILoc(file, line, 0);
+      locMap[symbols[i].name.str()] = APILoc(file, line, 0);
   }
 
   return locMap;
 }
 
 SymbolToSourceLocMap accumulateSourceLocFromDSYM(const StringRef dSYMFile,
-                                                 const Target &target) {
+                                                 const Target &target,
+                                                 unsigned numThreads) {
   // Find sidecar file.
   auto dSYMsOrErr = MachOObjectFile::findDsymObjectMembers(dSYMFile);
   if (!dSYMsOrErr) {
@@ -274,13 +343,9 @@ SymbolToSourceLocMap accumulateSourceLocFromDSYM(const StringRef dSYMFile,
     return SymbolToSourceLocMap();
   }
   // Handle single arch.
-  if (auto *single = dyn_cast<MachOObjectFile>(binOrErr->get())) {
-    auto diCtx = DWARFContext::create(
-        *single, DWARFContext::ProcessDebugRelocations::Process, nullptr, "",
-        DWARFErrorHandler, DWARFErrorHandler);
+  if (auto *single = dyn_cast<MachOObjectFile>(binOrErr->get()))
+    return accumulateLocs(*single, numThreads);
 
-    return accumulateLocs(*single, diCtx);
-  }
   // Handle universal companion file.
   if (auto *fat = dyn_cast<MachOUniversalBinary>(binOrErr->get())) {
     auto objForArch = fat->getObjectForArch(getArchitectureName(target.Arch));
@@ -293,12 +358,7 @@ SymbolToSourceLocMap accumulateSourceLocFromDSYM(const StringRef dSYMFile,
       consumeError(machOOrErr.takeError());
       return SymbolToSourceLocMap();
     }
-    auto &obj = **machOOrErr;
-    auto diCtx = DWARFContext::create(
-        obj, DWARFContext::ProcessDebugRelocations::Process, nullptr, "",
-        DWARFErrorHandler, DWARFErrorHandler);
-
-    return accumulateLocs(obj, diCtx);
+    return accumulateLocs(**machOOrErr, numThreads);
   }
   return SymbolToSourceLocMap();
 }
@@ -853,6 +913,14 @@ llvm::Expected<MachOParseResult> readMachOFile(MemoryBufferRef memBuffer,
          "Expected a MachO universal binary.");
   auto *UB = cast<MachOUniversalBinary>(&binary);
 
+  struct Slice {
+    std::unique_ptr<MachOObjectFile> object;
+    Architecture arch;
+    MachOParseResult results;
+    Error error;
+  };
+  std::vector<Slice> slices;
+
   for (auto OI = UB->begin_objects(), OE = UB->end_objects(); OI != OE; ++OI) {
     // Skip the architecture that is not requested.
     auto arch =
@@ -873,24 +941,49 @@ llvm::Expected<MachOParseResult> readMachOFile(MemoryBufferRef memBuffer,
       continue;
     }
 
-    auto &object = *objOrErr.get();
-    auto triples = constructTripleFromMachO(&object);
-    switch (object.getHeader().filetype) {
+    switch ((*objOrErr)->getHeader().filetype) {
     default:
       break;
     case MachO::MH_BUNDLE:
     case MachO::MH_DYLIB:
     case MachO::MH_DYLIB_STUB:
-      for (const auto &target : triples) {
-        results.emplace_back(arch, std::make_shared<API>(API({target})));
-        auto error = load(&object, *results.back().second, option);
-        if (error)
-          return std::move(error);
-      }
+      slices.push_back(
+          {std::move(*objOrErr), arch, MachOParseResult(), Error::success()});
       break;
     }
   }
 
+  // Each slice has its own object file and its own APIs, so the slices can be
+  // read in parallel.
+  runConcurrently(option.numThreads, slices.size(), [&](size_t i) {
+    auto &slice = slices[i];
+    for (const auto &target : constructTripleFromMachO(slice.object.get())) {
+      slice.results.emplace_back(slice.arch,
+                                 std::make_shared<API>(API({target})));
+      if (auto error =
+              load(slice.object.get(), *slice.results.back().second, option)) {
+        cantFail(std::move(slice.error));
+        slice.error = std::move(error);
+        return;
+      }
+    }
+  });
+
+  // Report the error of the first slice that failed, like a serial read.
+  Error error = Error::success();
+  for (auto &slice : slices) {
+    if (!slice.error) {
+      llvm::append_range(results, slice.results);
+      continue;
+    }
+    if (error)
+      consumeError(std::move(slice.error));
+    else
+      error = std::move(slice.error);
+  }
+  if (error)
+    return std::move(error);
+
   if (results.empty())
     return make_error<StringError>(
         "Requested architectures don't exist",
@@ -14,12 +14,12 @@
 #include "tapi/Core/Registry.h"
 #include "tapi/Core/JSONReaderWriter.h"
 #include "tapi/Core/MachODylibReader.h"
+#include "tapi/Core/TextStubScanner.h"
 #include "tapi/Core/YAMLReaderWriter.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/TextAPI/TextAPIReader.h"
 
 using namespace llvm;
 using namespace llvm::MachO;
@@ -139,7 +139,7 @@ Registry::readTextFile(std::unique_ptr<MemoryBuffer> memBuffer, ReadFlags readFl
     if (!reader->canRead(fileType, memBuffer->getMemBufferRef()))
       continue;
 
-    auto interfaceOrErr = TextAPIReader::get(memBuffer->getMemBufferRef());
+    auto interfaceOrErr = readTextStub(memBuffer->getMemBufferRef());
     if (!interfaceOrErr)
       return interfaceOrErr.takeError();
 
@@ -209,8 +209,8 @@ Error Registry::writeFile(raw_ostream &os, const InterfaceFile *file,
       "unsupported file type", std::make_error_code(std::errc::not_supported));
 }
 
-void Registry::addBinaryReaders() {
-  add(std::unique_ptr<Reader>(new MachODylibReader));
+void Registry::addBinaryReaders(unsigned numThreads) {
+  add(std::unique_ptr<Reader>(new MachODylibReader(numThreads)));
 }
 
 void Registry::addYAMLReaders() {
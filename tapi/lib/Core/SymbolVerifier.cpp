@@ -127,6 +127,7 @@ class DylibAPIVerifier : public APIVisitor {
 private:
   struct DSYMContext {
     const StringRef path{};
+    unsigned numThreads{1};
     bool parsedDSYM{false};
     SymbolToSourceLocMap sourceLocs{};
   };
@@ -296,7 +297,8 @@ private:
     if (dSYMCtx.path.empty())
       return;
 
-    dSYMCtx.sourceLocs = accumulateSourceLocFromDSYM(dSYMCtx.path, ctx.target);
+    dSYMCtx.sourceLocs = accumulateSourceLocFromDSYM(dSYMCtx.path, ctx.target,
+                                                     dSYMCtx.numThreads);
   }
 
 public:
@@ -307,11 +309,12 @@ public:
                    VerificationMode mode, bool demangle, Demangler &demangler,
                    SymbolSet *verifiedSymbols,
                    std::map<std::string, APIInfo> &ignoredZipperedRecords,
-                   const StringRef dSYMPath)
+                   const StringRef dSYMPath, unsigned numThreads)
       : ctx(ctx), swiftFile(swiftFile), aliases(aliases), mode(mode),
         demangle(demangle), demangler(demangler),
         verifiedSymbols(verifiedSymbols),
-        ignoredZipperedRecords(ignoredZipperedRecords), dSYMCtx({dSYMPath}),
+        ignoredZipperedRecords(ignoredZipperedRecords),
+        dSYMCtx({dSYMPath, numThreads}),
         result(SymbolVerifier::Result::Ignore) {}
 
   SymbolVerifier::Result getResult() { return result; }
@@ -681,6 +684,11 @@ SymbolVerifier::Result SymbolVerifier::verifyImpl(const APIRecord *record,
 }
 
 SymbolVerifier::Result SymbolVerifier::verify(const GlobalRecord *record) {
+  if (deferred) {
+    deferredRecords.push_back({DeferredKind::Global, record, {}});
+    return Result::Ignore;
+  }
+
   // Global Symbol classifications could be obfusciated with `asm`
   auto sym = parseSymbol(record->name);
   SymbolContext symCtx;
@@ -696,6 +704,11 @@ SymbolVerifier::Result SymbolVerifier::verify(const GlobalRecord *record) {
 
 SymbolVerifier::Result
 SymbolVerifier::verify(const ObjCInterfaceRecord *record) {
+  if (deferred) {
+    deferredRecords.push_back({DeferredKind::ObjCInterface, record, {}});
+    return Result::Ignore;
+  }
+
   SymbolContext symCtx;
   symCtx.materializedName = record->name;
 
@@ -719,6 +732,12 @@ SymbolVerifier::verify(const ObjCInstanceVariableRecord *record,
       record->accessControl == clang::ObjCIvarDecl::Package)
     return Result::Ignore;
 
+  if (deferred) {
+    deferredRecords.push_back(
+        {DeferredKind::ObjCInstanceVariable, record, superClass.str()});
+    return Result::Ignore;
+  }
+
   auto fullName =
       ObjCInstanceVariableRecord::createName(superClass, record->name);
   std::string displayName =
@@ -732,6 +751,31 @@ SymbolVerifier::verify(const ObjCInstanceVariableRecord *record,
   return verifyImpl(record, symCtx);
 }
 
+std::unique_ptr<SymbolVerifier> SymbolVerifier::createDeferred() {
+  auto verifier = std::make_unique<SymbolVerifier>();
+  verifier->deferred = true;
+  return verifier;
+}
+
+SymbolVerifier::Result
+SymbolVerifier::verifyDeferred(const SymbolVerifier &other) {
+  for (const auto &entry : other.deferredRecords) {
+    switch (entry.kind) {
+    case DeferredKind::Global:
+      verify(static_cast<const GlobalRecord *>(entry.record));
+      break;
+    case DeferredKind::ObjCInterface:
+      verify(static_cast<const ObjCInterfaceRecord *>(entry.record));
+      break;
+    case DeferredKind::ObjCInstanceVariable:
+      verify(static_cast<const ObjCInstanceVariableRecord *>(entry.record),
+             entry.superClass);
+      break;
+    }
+  }
+  return ctx.frontendState;
+}
+
 std::unique_ptr<SymbolSet> SymbolVerifier::getExports() {
   for (auto &cov : coverageSymbols) {
     SimpleVisitor visitor{cov.get()};
@@ -780,7 +824,8 @@ SymbolVerifier::verifyRemainingSymbols(Architecture arch) {
   ctx.printArch = true;
   DylibAPIVerifier apiVerifier(ctx, verifiedSwift ? nullptr : swiftInterface,
                                aliases, mode, demangle, demangler,
-                               exports.get(), ignoredZipperedRecords, dSYMPath);
+                               exports.get(), ignoredZipperedRecords, dSYMPath,
+                               numThreads);
   ctx.target = api->getTarget();
   SimpleVisitor visitor{api.get()};
   visitor.visit(apiVerifier);
@@ -0,0 +1,713 @@
+//===- tapi/Core/TextStubScanner.cpp - Text Stub Scanner --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Implements the single-pass reader for TBD v4 documents.
+///
+/// The generic reader builds a YAML node tree for the whole stream and maps it
+/// through the YAML traits. Text-based stubs only use a small, regular subset
+/// of YAML: top-level keys, block sequences of flat mappings, and flow
+/// sequences of scalars. This scanner reads exactly that subset line by line
+/// and hands the strings to the InterfaceFile, which interns them. Anything it
+/// doesn't recognize makes it give up, so the generic reader stays the
+/// authority on what is valid and on the diagnostics.
+///
+//===----------------------------------------------------------------------===//
+
+#include "tapi/Core/TextStubScanner.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/TextAPI/PackedVersion.h"
+#include "llvm/TextAPI/Target.h"
+#include "llvm/TextAPI/TextAPIReader.h"
+#include <vector>
+
+using namespace llvm;
+using namespace llvm::MachO;
+
+TAPI_NAMESPACE_INTERNAL_BEGIN
+
+namespace {
+
+struct Line {
+  unsigned indent;
+  StringRef text; // Without indentation and trailing white space.
+};
+
+/// Read the next line that isn't blank or a comment. Tabs are not part of the
+/// supported subset and mark the input as failed.
+bool nextLine(StringRef buffer, size_t &pos, Line &line, bool &failed) {
+  while (pos < buffer.size()) {
+    auto end = buffer.find('\n', pos);
+    if (end == StringRef::npos)
+      end = buffer.size();
+    auto raw = buffer.slice(pos, end).rtrim(" \r");
+    pos = end + 1;
+
+    if (raw.contains('\t')) {
+      failed = true;
+      return false;
+    }
+
+    auto text = raw.ltrim(' ');
+    if (text.empty() || text.front() == '#')
+      continue;
+
+    line.indent = raw.size() - text.size();
+    line.text = text;
+    return true;
+  }
+
+  return false;
+}
+
+constexpr StringLiteral documentStartV4 = "--- !tapi-tbd";
+
+/// Sections that list symbols for the same targets.
+struct SymbolSection {
+  TargetList targets;
+  std::vector<StringRef> symbols;
+  std::vector<StringRef> classes;
+  std::vector<StringRef> classEHs;
+  std::vector<StringRef> ivars;
+  std::vector<StringRef> weakSymbols;
+  std::vector<StringRef> tlvSymbols;
+};
+
+/// Sections that list clients or libraries for the same targets.
+struct LibrarySection {
+  TargetList targets;
+  std::vector<StringRef> values;
+};
+
+struct UmbrellaSection {
+  TargetList targets;
+  StringRef umbrella;
+};
+
+class Scanner {
+public:
+  Scanner(MemoryBufferRef bufferRef)
+      : _buffer(bufferRef.getBuffer()), _path(bufferRef.getBufferIdentifier()),
+        _saver(_allocator) {}
+
+  std::unique_ptr<InterfaceFile> scan();
+
+private:
+  bool readLine(Line &line) {
+    _lastPos = _pos;
+    return nextLine(_buffer, _pos, line, _failed);
+  }
+  void unreadLine() { _pos = _lastPos; }
+
+  std::unique_ptr<InterfaceFile> scanDocument();
+  bool scanScalar(StringRef &text, bool inFlow, StringRef &value);
+  bool parseScalar(StringRef text, StringRef &value);
+  bool parseFlowSequence(StringRef text, std::vector<StringRef> &values);
+  bool parseTarget(StringRef text, Target &target);
+  bool parseTargets(StringRef text, TargetList &targets);
+  bool parseUUIDs(StringRef value);
+  bool parseUmbrellas(StringRef value, std::vector<UmbrellaSection> &sections);
+  bool parseLibraries(StringRef value, StringRef valuesKey,
+                      std::vector<LibrarySection> &sections);
+  bool parseSymbols(StringRef value, std::vector<SymbolSection> &sections);
+
+  template <typename Fn> bool scanBlockSequence(StringRef value, Fn handler);
+
+  StringRef _buffer;
+  StringRef _path;
+  size_t _pos = 0;
+  size_t _lastPos = 0;
+  bool _failed = false;
+
+  // Holds the few strings that need unescaping; everything else points into
+  // the buffer.
+  BumpPtrAllocator _allocator;
+  StringSaver _saver;
+  StringMap<Target> _targets;
+};
+
+} // end anonymous namespace.
+
+/// Split "key: value". Keys are plain lower case words.
+static bool splitKey(StringRef text, StringRef &key, StringRef &value) {
+  auto pos = text.find(':');
+  if (pos == StringRef::npos)
+    return false;
+
+  key = text.take_front(pos);
+  if (key.empty() ||
+      !all_of(key, [](char c) { return isAlnum(c) || c == '-'; }))
+    return false;
+
+  value = text.drop_front(pos + 1);
+  if (!value.empty() && value.front() != ' ')
+    return false;
+  value = value.ltrim(' ');
+  return true;
+}
+
+/// Scan a scalar at the start of the text and advance past it. Plain scalars
+/// end at the end of the line, or in flow context at ',' or ']'.
+bool Scanner::scanScalar(StringRef &text, bool inFlow, StringRef &value) {
+  if (text.empty())
+    return false;
+
+  if (text.front() == '\'') {
+    bool hasEscapes = false;
+    size_t i = 1;
+    for (;; ++i) {
+      if (i >= text.size())
+        return false;
+      if (text[i] != '\'')
+        continue;
+      if (i + 1 < text.size() && text[i + 1] == '\'') {
+        hasEscapes = true;
+        ++i;
+        continue;
+      }
+      break;
+    }
+    value = text.slice(1, i);
+    if (hasEscapes) {
+      std::string unescaped;
+      unescaped.reserve(value.size());
+      for (size_t j = 0; j < value.size(); ++j) {
+        unescaped.push_back(value[j]);
+        if (value[j] == '\'')
+          ++j;
+      }
+      value = _saver.save(unescaped);
+    }
+    text = text.drop_front(i + 1);
+    return true;
+  }
+
+  if (text.front() == '"') {
+    auto end = text.find_first_of("\"\\", 1);
+    if (end == StringRef::npos || text[end] != '"')
+      return false;
+    value = text.slice(1, end);
+    text = text.drop_front(end + 1);
+    return true;
+  }
+
+  // Indicators that start anything but a plain scalar.
+  if (StringRef("[]{},#&*!|>%@`").contains(text.front()))
+    return false;
+  if ((text.front() == '-' || text.front() == '?' || text.front() == ':') &&
+      (text.size() == 1 || text[1] == ' '))
+    return false;
+
+  size_t i = 0;
+  for (; i < text.size(); ++i) {
+    char c = text[i];
+    if (inFlow && StringRef(",[]{}").contains(c))
+      break;
+    if (c == ':' && (i + 1 == text.size() || text[i + 1] == ' ' ||
+                     (inFlow && StringRef(",[]{}").contains(text[i + 1]))))
+      return false;
+    if (c == '#' && text[i - 1] == ' ')
+      return false;
+  }
+
+  value = text.take_front(i).rtrim(' ');
+  text = text.drop_front(i);
+  return true;
+}
+
+/// Parse a value that must be a single scalar.
+bool Scanner::parseScalar(StringRef text, StringRef &value) {
+  return scanScalar(text, /*inFlow=*/false, value) && text.ltrim(' ').empty();
+}
+
+/// Parse a flow sequence of scalars, which may continue on the following lines.
+bool Scanner::parseFlowSequence(StringRef text,
+                                std::vector<StringRef> &values) {
+  if (!text.startswith("["))
+    return false;
+  text = text.drop_front(1);
+
+  bool expectItem = true;
+  while (true) {
+    text = text.ltrim(' ');
+    if (text.empty()) {
+      Line line;
+      if (!readLine(line) || line.indent == 0)
+        return false;
+      text = line.text;
+      continue;
+    }
+
+    if (text.front() == ']')
+      return text.drop_front(1).ltrim(' ').empty();
+
+    if (text.front() == ',') {
+      if (expectItem)
+        return false;
+      expectItem = true;
+      text = text.drop_front(1);
+      continue;
+    }
+
+    // Two scalars without a separator are one folded scalar in YAML.
+    StringRef value;
+    if (!expectItem || !scanScalar(text, /*inFlow=*/true, value))
+      return false;
+    values.push_back(value);
+    expectItem = false;
+  }
+}
+
+bool Scanner::parseTarget(StringRef text, Target &target) {
+  auto it = _targets.find(text);
+  if (it != _targets.end()) {
+    target = it->second;
+    return true;
+  }
+
+  auto result = Target::create(text);
+  if (!result) {
+    consumeError(result.takeError());
+    return false;
+  }
+  if (result->Arch == AK_unknown || result->Platform == PLATFORM_UNKNOWN)
+    return false;
+
+  target = *result;
+  _targets.try_emplace(text, target);
+  return true;
+}
+
+bool Scanner::parseTargets(StringRef text, TargetList &targets) {
+  std::vector<StringRef> names;
+  if (!parseFlowSequence(text, names))
+    return false;
+
+  for (auto name : names) {
+    Target target;
+    if (!parseTarget(name, target))
+      return false;
+    targets.emplace_back(target);
+  }
+  return true;
+}
+
+/// Scan the block sequence of mappings that follows a top-level key. The
+/// handler sees each key and value, and whether the key starts a new entry.
+template <typename Fn>
+bool Scanner::scanBlockSequence(StringRef value, Fn handler) {
+  if (!value.empty())
+    return value == "[]";
+
+  unsigned entryIndent = 0;
+  unsigned keyIndent = 0;
+  Line line;
+  while (readLine(line)) {
+    if (line.indent == 0) {
+      unreadLine();
+      break;
+    }
+
+    auto text = line.text;
+    bool isNewEntry = false;
+    if (text.startswith("-")) {
+      auto rest = text.drop_front(1);
+      auto entry = rest.ltrim(' ');
+      if (entry.size() == rest.size() || entry.empty())
+        return false;
+      unsigned indent = line.indent + 1 + (rest.size() - entry.size());
+      if (keyIndent == 0) {
+        entryIndent = line.indent;
+        keyIndent = indent;
+      } else if (line.indent != entryIndent || indent != keyIndent)
+        return false;
+      text = entry;
+      isNewEntry = true;
+    } else if (keyIndent == 0 || line.indent != keyIndent)
+      return false;
+
+    StringRef key, keyValue;
+    if (!splitKey(text, key, keyValue) || !handler(key, keyValue, isNewEntry))
+      return false;
+  }
+
+  return !_failed;
+}
+
+bool Scanner::parseUUIDs(StringRef value) {
+  // UUIDs are no longer recorded, but must still be well formed.
+  unsigned seen = 0;
+  bool isValid = scanBlockSequence(value, [&](StringRef key, StringRef text,
+                                              bool isNewEntry) {
+    if (isNewEntry) {
+      if (seen != 0 && seen != 3)
+        return false;
+      seen = 0;
+    }
+
+    unsigned bit = StringSwitch<unsigned>(key)
+                       .Case("target", 1)
+                       .Case("value", 2)
+                       .Default(0);
+    if (bit == 0 || (seen & bit))
+      return false;
+    seen |= bit;
+
+    StringRef scalar;
+    if (!parseScalar(text, scalar))
+      return false;
+    Target target;
+    return bit != 1 || parseTarget(scalar, target);
+  });
+  return isValid && (seen == 0 || seen == 3);
+}
+
+bool Scanner::parseUmbrellas(StringRef value,
+                             std::vector<UmbrellaSection> &sections) {
+  unsigned seen = 0;
+  bool isValid = scanBlockSequence(value, [&](StringRef key, StringRef text,
+                                              bool isNewEntry) {
+    if (isNewEntry) {
+      if (!sections.empty() && seen != 3)
+        return false;
+      sections.emplace_back();
+      seen = 0;
+    }
+
+    unsigned bit = StringSwitch<unsigned>(key)
+                       .Case("targets", 1)
+                       .Case("umbrella", 2)
+                       .Default(0);
+    if (bit == 0 || (seen & bit))
+      return false;
+    seen |= bit;
+
+    auto &section = sections.back();
+    if (bit == 1)
+      return parseTargets(text, section.targets);
+    return parseScalar(text, section.umbrella);
+  });
+  return isValid && (sections.empty() || seen == 3);
+}
+
+bool Scanner::parseLibraries(StringRef value, StringRef valuesKey,
+                             std::vector<LibrarySection> &sections) {
+  unsigned seen = 0;
+  bool isValid = scanBlockSequence(value, [&](StringRef key, StringRef text,
+                                              bool isNewEntry) {
+    if (isNewEntry) {
+      if (!sections.empty() && seen != 3)
+        return false;
+      sections.emplace_back();
+      seen = 0;
+    }
+
+    unsigned bit = key == "targets" ? 1 : key == valuesKey ? 2 : 0;
+    if (bit == 0 || (seen & bit))
+      return false;
+    seen |= bit;
+
+    auto &section = sections.back();
+    if (bit == 1)
+      return parseTargets(text, section.targets);
+    return parseFlowSequence(text, section.values);
+  });
+  return isValid && (sections.empty() || seen == 3);
+}
+
+bool Scanner::parseSymbols(StringRef value,
+                           std::vector<SymbolSection> &sections) {
+  unsigned seen = 0;
+  bool isValid = scanBlockSequence(value, [&](StringRef key, StringRef text,
+                                              bool isNewEntry) {
+    if (isNewEntry) {
+      if (!sections.empty() && !(seen & 1))
+        return false;
+      sections.emplace_back();
+      seen = 0;
+    }
+
+    unsigned index = StringSwitch<unsigned>(key)
+                         .Case("targets", 0)
+                         .Case("symbols", 1)
+                         .Case("objc-classes", 2)
+                         .Case("objc-eh-types", 3)
+                         .Case("objc-ivars", 4)
+                         .Case("weak-symbols", 5)
+                         .Case("thread-local-symbols", 6)
+                         .Default(~0U);
+    if (index == ~0U || (seen & (1U << index)))
+      return false;
+    seen |= 1U << index;
+
+    auto &section = sections.back();
+    switch (index) {
+    case 0:
+      return parseTargets(text, section.targets);
+    case 1:
+      return parseFlowSequence(text, section.symbols);
+    case 2:
+      return parseFlowSequence(text, section.classes);
+    case 3:
+      return parseFlowSequence(text, section.classEHs);
+    case 4:
+      return parseFlowSequence(text, section.ivars);
+    case 5:
+      return parseFlowSequence(text, section.weakSymbols);
+    default:
+      return parseFlowSequence(text, section.tlvSymbols);
+    }
+  });
+  return isValid && (sections.empty() || (seen & 1));
+}
+
+static void addSymbols(InterfaceFile &file,
+                       const std::vector<SymbolSection> &sections,
+                       SymbolFlags flags = SymbolFlags::None) {
+  auto weakFlag = flags == SymbolFlags::Undefined ? SymbolFlags::WeakReferenced
+                                                  : SymbolFlags::WeakDefined;
+  for (const auto &section : sections) {
+    for (auto name : section.symbols)
+      file.addSymbol(SymbolKind::GlobalSymbol, name, section.targets, flags);
+    for (auto name : section.classes)
+      file.addSymbol(SymbolKind::ObjectiveCClass, name, section.targets,
+                     flags);
+    for (auto name : section.classEHs)
+      file.addSymbol(SymbolKind::ObjectiveCClassEHType, name, section.targets,
+                     flags);
+    for (auto name : section.ivars)
+      file.addSymbol(SymbolKind::ObjectiveCInstanceVariable, name,
+                     section.targets, flags);
+    for (auto name : section.weakSymbols)
+      file.addSymbol(SymbolKind::GlobalSymbol, name, section.targets,
+                     flags | weakFlag);
+    for (auto name : section.tlvSymbols)
+      file.addSymbol(SymbolKind::GlobalSymbol, name, section.targets,
+                     flags | SymbolFlags::ThreadLocalValue);
+  }
+}
+
+std::unique_ptr<InterfaceFile> Scanner::scanDocument() {
+  enum Key : unsigned {
+    TBDVersion,
+    Targets,
+    UUIDs,
+    Flags,
+    InstallName,
+    CurrentVersion,
+    CompatibilityVersion,
+    SwiftABIVersion,
+    ParentUmbrella,
+    AllowableClients,
+    ReexportedLibraries,
+    Exports,
+    Reexports,
+    Undefineds,
+    Unknown,
+  };
+
+  unsigned seen = 0;
+  TargetList targets;
+  StringRef installName;
+  PackedVersion currentVersion(1, 0, 0);
+  PackedVersion compatibilityVersion(1, 0, 0);
+  unsigned swiftABIVersion = 0;
+  bool isFlatNamespace = false;
+  bool isNotAppExtensionSafe = false;
+  std::vector<UmbrellaSection> umbrellas;
+  std::vector<LibrarySection> allowableClients;
+  std::vector<LibrarySection> reexportedLibraries;
+  std::vector<SymbolSection> exports, reexports, undefineds;
+
+  Line line;
+  while (readLine(line)) {
+    if (line.indent != 0)
+      return nullptr;
+    if (line.text == "...")
+      break;
+    if (line.text.startswith("---")) {
+      unreadLine();
+      break;
+    }
+
+    StringRef key, value;
+    if (!splitKey(line.text, key, value))
+      return nullptr;
+
+    auto index = StringSwitch<Key>(key)
+                     .Case("tbd-version", TBDVersion)
+                     .Case("targets", Targets)
+                     .Case("uuids", UUIDs)
+                     .Case("flags", Flags)
+                     .Case("install-name", InstallName)
+                     .Case("current-version", CurrentVersion)
+                     .Case("compatibility-version", CompatibilityVersion)
+                     .Case("swift-abi-version", SwiftABIVersion)
+                     .Case("parent-umbrella", ParentUmbrella)
+                     .Case("allowable-clients", AllowableClients)
+                     .Case("reexported-libraries", ReexportedLibraries)
+                     .Case("exports", Exports)
+                     .Case("reexports", Reexports)
+                     .Case("undefineds", Undefineds)
+                     .Default(Unknown);
+    if (index == Unknown || (seen & (1U << index)))
+      return nullptr;
+    seen |= 1U << index;
+
+    bool isValid = false;
+    StringRef scalar;
+    switch (index) {
+    case TBDVersion:
+      isValid = parseScalar(value, scalar) && scalar == "4";
+      break;
+    case Targets:
+      isValid = parseTargets(value, targets);
+      break;
+    case UUIDs:
+      isValid = parseUUIDs(value);
+      break;
+    case Flags: {
+      std::vector<StringRef> flags;
+      isValid = parseFlowSequence(value, flags);
+      for (auto flag : flags) {
+        if (flag == "flat_namespace")
+          isFlatNamespace = true;
+        else if (flag == "not_app_extension_safe")
+          isNotAppExtensionSafe = true;
+        else if (flag != "installapi")
+          isValid = false;
+      }
+      break;
+    }
+    case InstallName:
+      isValid = parseScalar(value, installName);
+      break;
+    case CurrentVersion:
+      isValid = parseScalar(value, scalar) && currentVersion.parse32(scalar);
+      break;
+    case CompatibilityVersion:
+      isValid =
+          parseScalar(value, scalar) && compatibilityVersion.parse32(scalar);
+      break;
+    case SwiftABIVersion:
+      isValid = parseScalar(value, scalar) &&
+                !scalar.getAsInteger(10, swiftABIVersion) &&
+                swiftABIVersion <= UINT8_MAX;
+      break;
+    case ParentUmbrella:
+      isValid = parseUmbrellas(value, umbrellas);
+      break;
+    case AllowableClients:
+      isValid = parseLibraries(value, "clients", allowableClients);
+      break;
+    case ReexportedLibraries:
+      isValid = parseLibraries(value, "libraries", reexportedLibraries);
+      break;
+    case Exports:
+      isValid = parseSymbols(value, exports);
+      break;
+    case Reexports:
+      isValid = parseSymbols(value, reexports);
+      break;
+    case Undefineds:
+      isValid = parseSymbols(value, undefineds);
+      break;
+    case Unknown:
+      break;
+    }
+    if (!isValid)
+      return nullptr;
+  }
+
+  const unsigned required =
+      (1U << TBDVersion) | (1U << Targets) | (1U << InstallName);
+  if (_failed || (seen & required) != required)
+    return nullptr;
+
+  // Populate the file in the same order as the generic reader, which matters
+  // for symbols listed more than once.
+  auto file = std::make_unique<InterfaceFile>();
+  file->setPath(_path);
+  file->setFileType(FileType::TBD_V4);
+  for (const auto &target : targets)
+    file->addTarget(target);
+  file->setInstallName(installName);
+  file->setCurrentVersion(currentVersion);
+  file->setCompatibilityVersion(compatibilityVersion);
+  file->setSwiftABIVersion(swiftABIVersion);
+  for (const auto &section : umbrellas)
+    for (const auto &target : section.targets)
+      file->addParentUmbrella(target, section.umbrella);
+  file->setTwoLevelNamespace(!isFlatNamespace);
+  file->setApplicationExtensionSafe(!isNotAppExtensionSafe);
+
+  for (const auto &section : allowableClients)
+    for (auto lib : section.values)
+      for (const auto &target : section.targets)
+        file->addAllowableClient(lib, target);
+
+  for (const auto &section : reexportedLibraries)
+    for (auto lib : section.values)
+      for (const auto &target : section.targets)
+        file->addReexportedLibrary(lib, target);
+
+  addSymbols(*file, exports);
+  addSymbols(*file, reexports, SymbolFlags::Rexported);
+  addSymbols(*file, undefineds, SymbolFlags::Undefined);
+  return file;
+}
+
+std::unique_ptr<InterfaceFile> Scanner::scan() {
+  std::unique_ptr<InterfaceFile> file;
+  Line line;
+  while (readLine(line)) {
+    if (line.indent != 0 || line.text != documentStartV4)
+      return nullptr;
+
+    auto document = scanDocument();
+    if (!document)
+      return nullptr;
+
+    if (!file)
+      file = std::move(document);
+    else
+      file->addDocument(std::move(document));
+  }
+
+  if (_failed)
+    return nullptr;
+  return file;
+}
+
+bool hasTextStubV4Tag(MemoryBufferRef bufferRef) {
+  size_t pos = 0;
+  bool failed = false;
+  Line line;
+  return nextLine(bufferRef.getBuffer(), pos, line, failed) &&
+         line.indent == 0 && line.text == documentStartV4;
+}
+
+std::unique_ptr<InterfaceFile> scanTextStub(MemoryBufferRef bufferRef) {
+  return Scanner(bufferRef).scan();
+}
+
+Expected<std::unique_ptr<InterfaceFile>>
+readTextStub(MemoryBufferRef bufferRef) {
+  if (hasTextStubV4Tag(bufferRef))
+    if (auto file = scanTextStub(bufferRef))
+      return std::move(file);
+
+  return TextAPIReader::get(bufferRef);
+}
+
+TAPI_NAMESPACE_INTERNAL_END
@@ -22,6 +22,8 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 using namespace llvm;
 
@@ -262,4 +264,19 @@ SimpleSymbol parseSymbol(StringRef symbolName) {
   return {symbolName, SymbolKind::GlobalSymbol};
 }
 
+void runConcurrently(unsigned numThreads, size_t count,
+                     llvm::function_ref<void(size_t)> task) {
+  if (numThreads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; ++i)
+      task(i);
+    return;
+  }
+
+  llvm::ThreadPool pool(
+      llvm::hardware_concurrency(std::min<size_t>(numThreads, count)));
+  for (size_t i = 0; i < count; ++i)
+    pool.async([&task, i] { task(i); });
+  pool.wait();
+}
+
 TAPI_NAMESPACE_INTERNAL_END
@@ -13,6 +13,7 @@
 
 #include "tapi/Core/YAMLReaderWriter.h"
 #include "tapi/Core/Registry.h"
+#include "tapi/Core/TextStubScanner.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -32,6 +33,10 @@ bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
   if (!(types & FileType::TBD_V1))
     return false;
 
+  // Documents tagged for v4 can't be read as an older version.
+  if (hasTextStubV4Tag(memBufferRef))
+    return false;
+
   auto result = TextAPIReader::get(memBufferRef);
   if (!result) {
     consumeError(result.takeError());
@@ -67,6 +72,10 @@ bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
   if (!(types & FileType::TBD_V2))
     return false;
 
+  // Documents tagged for v4 can't be read as an older version.
+  if (hasTextStubV4Tag(memBufferRef))
+    return false;
+
   auto result = TextAPIReader::get(memBufferRef);
   if (!result) {
     consumeError(result.takeError());
@@ -98,6 +107,10 @@ bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
   if (!(types & FileType::TBD_V3))
     return false;
 
+  // Documents tagged for v4 can't be read as an older version.
+  if (hasTextStubV4Tag(memBufferRef))
+    return false;
+
   auto result = TextAPIReader::get(memBufferRef);
   if (!result) {
     consumeError(result.takeError());
@@ -131,6 +144,9 @@ bool YAMLDocumentHandler::canRead(MemoryBufferRef memBufferRef,
   if (!(types & FileType::TBD_V4))
     return false;
 
+  if (hasTextStubV4Tag(memBufferRef) && scanTextStub(memBufferRef))
+    return true;
+
   auto result = TextAPIReader::get(memBufferRef);
   if (!result) {
     consumeError(result.takeError());
@@ -296,7 +312,7 @@ void addInterfaceFileToAPIs(APIs &apis, const InterfaceFile *interface) {
 Expected<APIs> YAMLReader::readFile(std::unique_ptr<MemoryBuffer> memBuffer,
                                     ReadFlags readFlags,
                                     llvm::MachO::ArchitectureSet arches) const {
-  auto interfaceOrErr = TextAPIReader::get(memBuffer->getMemBufferRef());
+  auto interfaceOrErr = readTextStub(memBuffer->getMemBufferRef());
   if (!interfaceOrErr)
     return interfaceOrErr.takeError();
   auto interface = std::move(*interfaceOrErr);
@@ -498,7 +498,8 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
   const auto platforms = mapToPlatformSet(allTargets);
 
   // Lookup re-exported libraries.
-  InterfaceFileManager manager(fm, opts.tapiOptions.isBnI);
+  InterfaceFileManager manager(fm, opts.tapiOptions.isBnI,
+                               opts.driverOptions.numThreads);
   PathSeq frameworkSearchPaths;
   LibAttrs reexportedLibraries;
   std::vector<APIs> reexportedLibraryFiles;
@@ -1003,6 +1004,7 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
       autoZippered, hasMacOS && hasMacCatalyst,
       std::move(reexportedLibraryFiles), std::move(coverageSymbols),
       std::move(aliases), opts.tapiOptions.dSYM});
+  job.verifier->setNumThreads(opts.driverOptions.numThreads);
 
   // Ignore swift verification if option is not enabled.
   if (opts.tapiOptions.verifySwift) {
@@ -1041,7 +1043,12 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
     std::stable_sort(headerFiles.begin(), headerFiles.end());
   job.headerFiles = headerFiles;
 
-  std::vector<FrontendContext> frontendResults;
+  // Parse the headers of each target and header type as a separate task.
+  // The tasks only collect the records to verify, which are then verified
+  // in target order against the binary.
+  static const HeaderType headerTypes[] = {
+      HeaderType::Public, HeaderType::Private, HeaderType::Project};
+  std::vector<FrontendTask> tasks;
   for (auto &target : allTargets) {
     auto systemFrameworkPaths = getPathsForPlatform(
         opts.frontendOptions.systemFrameworkPaths, mapToPlatformType(target));
@@ -1052,20 +1059,43 @@ bool Driver::InstallAPI::run(DiagnosticsEngine &diag, Options &opts) {
                                 systemFrameworkPaths.size());
     job.systemFrameworkPaths = systemFrameworkPaths;
     job.target = target;
-    job.verifier->setTarget(target);
-    for (auto type :
-         {HeaderType::Public, HeaderType::Private, HeaderType::Project}) {
+    for (auto type : headerTypes) {
       job.type = type;
-      auto contextOrError = runFrontend(job);
-      if (auto err = contextOrError.takeError()) {
-        if (canIgnoreFrontendError(err))
-          continue;
-        return false;
-      }
-      frontendResults.emplace_back(std::move(*contextOrError));
+      tasks.emplace_back();
+      tasks.back().job = copyFrontendJob(job);
+      tasks.back().job->verifier = SymbolVerifier::createDeferred();
     }
   }
 
+  std::vector<FrontendContext> frontendResults;
+  auto addFrontendResult = [&](FrontendTask &task) {
+    if (task.failed)
+      return false;
+    if (!task.result)
+      return true;
+    job.verifier->setSourceManager(*task.result->sourceMgr);
+    job.verifier->verifyDeferred(*task.job->verifier);
+    frontendResults.emplace_back(std::move(*task.result));
+    return true;
+  };
+
+  // Verbose output from concurrent frontend jobs would be interleaved.
+  const unsigned numThreads = job.verbose ? 1 : opts.driverOptions.numThreads;
+  if (numThreads > 1)
+    runConcurrently(numThreads, tasks.size(),
+                    [&](size_t i) { runFrontendTask(tasks[i]); });
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    if (i % std::size(headerTypes) == 0)
+      job.verifier->setTarget(tasks[i].job->target);
+    // Without threads, verify each task before running the next, so its
+    // diagnostics directly follow the ones from parsing its headers.
+    if (numThreads <= 1)
+      runFrontendTask(tasks[i]);
+    errs() << tasks[i].diagnostics;
+    if (!addFrontendResult(tasks[i]))
+      return false;
+  }
+
   // Clean up module cache after clang invocations have fun.
   if (customModuleCache)
     llvm::sys::fs::remove_directories(job.moduleCachePath,
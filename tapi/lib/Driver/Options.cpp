@@ -385,6 +385,15 @@ bool Options::processDriverOptions(DiagnosticsEngine &diag,
     driverOptions.clangExecutablePath = getClangExecutablePath();
   }
 
+  if (auto *arg = args.getLastArg(OPT_jobs)) {
+    if (StringRef(arg->getValue()).getAsInteger(10, driverOptions.numThreads) ||
+        driverOptions.numThreads == 0) {
+      diag.report(clang::diag::err_drv_invalid_int_value)
+          << arg->getAsString(args) << arg->getValue();
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -120,6 +120,7 @@ public:
   SmallString<PATH_MAX> moduleCachePath;
 
   std::string projectName;
+  unsigned numThreads;
   bool hasSDKDBError = false;
   bool hasWrittenPartialOutput = false;
   bool scannedSwiftInterface = false;
@@ -135,6 +136,8 @@ public:
     action = opt.sdkdbOptions.action;
     diagnosticsFile = opt.sdkdbOptions.diagnosticsFile;
     verbose = opt.frontendOptions.verbose;
+    // Verbose output from concurrent frontend jobs would be interleaved.
+    numThreads = verbose ? 1 : opt.driverOptions.numThreads;
     verifyAPI = opt.tapiOptions.verifyAPI;
     verifyAPISkipExternalHeaders = opt.tapiOptions.verifyAPISkipExternalHeaders;
 
@@ -162,13 +165,9 @@ public:
     sys::fs::remove_directories(moduleCachePath);
   }
 
-  Error scanBinaryFile(StringRef path, std::vector<Triple> &triples,
-                       bool isPublic) {
-    if (!_fm->exists(path))
-      return make_error<StringError>(
-          "binary file doesn't exist", inconvertibleErrorCode());
-
-    auto bufferOrErr = _fm->getBufferForFile(path);
+  Expected<MachOParseResult> readBinaryFile(StringRef path,
+                                            unsigned sliceThreads = 1) const {
+    auto bufferOrErr = _fm->getVirtualFileSystem().getBufferForFile(path);
     if (auto ec = bufferOrErr.getError())
       return errorCodeToError(ec);
 
@@ -176,11 +175,13 @@ public:
     option.arches = config.getArchitectures();
     // Do not include undefined (external linkage) symbols in MachO.
     option.parseUndefined = false;
-    auto results = readMachOFile(bufferOrErr->get()->getMemBufferRef(), option);
-    if (!results)
-      return results.takeError();
+    option.numThreads = sliceThreads;
+    return readMachOFile(bufferOrErr->get()->getMemBufferRef(), option);
+  }
 
-    for (auto &result : *results) {
+  void addBinaryResults(MachOParseResult &results, std::vector<Triple> &triples,
+                        bool isPublic) {
+    for (auto &result : results) {
       const auto &target = result.second->getTriple();
       if (std::find(triples.begin(), triples.end(), target) ==
           std::end(triples))
@@ -198,8 +199,6 @@ public:
       else
         internalBinaryResults.emplace_back(std::move(*result.second));
     }
-
-    return Error::success();
   }
 
   Error performOutput(StringRef path,
@@ -307,6 +306,23 @@ private:
   API &api;
 };
 
+// A dynamic library of a framework.
+struct BinaryTask {
+  StringRef path;
+  Optional<Expected<MachOParseResult>> result;
+};
+
+// The scan of one framework. The scans of all frameworks are done
+// concurrently, and their results are then added to the context in the
+// order a serial scan would have added them.
+struct FrameworkScan {
+  Framework *framework;
+  std::vector<BinaryTask> binaries;
+  std::vector<Triple> triples;
+  std::vector<FrontendTask> frontends;
+  bool prepared = false;
+};
+
 } // namespace sdkdb
 
 static Expected<std::string>
@@ -384,9 +400,12 @@ static void inferTriplesFromEnvironment(sdkdb::Context &context,
   }
 }
 
-static bool computeFrontendResultFromFramework(
-    sdkdb::Context &context, const Framework &framework,
-    std::vector<Triple> &triples, bool isPublic) {
+// Collect the headers of the framework and create a frontend task for each
+// header type and target.
+static bool prepareFrontendTasks(sdkdb::Context &context,
+                                 const Framework &framework,
+                                 std::vector<Triple> &triples, bool isPublic,
+                                 std::vector<FrontendTask> &tasks) {
   // bail out of there is no triples.
   if (triples.empty())
     return true;
@@ -658,10 +677,7 @@ static bool computeFrontendResultFromFramework(
     job->vfs = overlay;
   }
 
-  auto &output =
-      isPublic ? context.publicSDKResults : context.internalSDKResults;
   for (auto type : {HeaderType::Public, HeaderType::Private}) {
-    std::vector<FrontendContext> results;
     for (auto &target : triples) {
       job->target = target;
       job->type = type;
@@ -692,14 +708,32 @@ static bool computeFrontendResultFromFramework(
       }
       job->createClangReproducer = true;
 
-      auto contextOrError = runFrontend(*job);
-      if (auto err = contextOrError.takeError()) {
-        if (canIgnoreFrontendError(err))
-          continue;
-        return false;
-      }
+      tasks.emplace_back();
+      tasks.back().job = copyFrontendJob(*job);
+    }
+  }
+
+  return true;
+}
 
-      results.emplace_back(std::move(*contextOrError));
+// Add the results of the frontend tasks of a framework, in task order.
+static bool addFrontendResults(sdkdb::Context &context,
+                               std::vector<FrontendTask> &tasks,
+                               bool isPublic) {
+  auto &diag = context.getDiag();
+  auto &output =
+      isPublic ? context.publicSDKResults : context.internalSDKResults;
+  for (auto type : {HeaderType::Public, HeaderType::Private}) {
+    std::vector<FrontendContext> results;
+    for (auto &task : tasks) {
+      if (task.job->type != type)
+        continue;
+      // The tasks ran concurrently, print their diagnostics in order here.
+      errs() << task.diagnostics;
+      if (task.failed)
+        return false;
+      if (task.result)
+        results.emplace_back(std::move(*task.result));
     }
     if (context.verifyAPI && results.size() == 2) {
       auto &api1 = results.front();
@@ -978,59 +1012,128 @@ static Error computeSwiftInterfacesFromFramework(sdkdb::Context &context,
   return Error::success();
 }
 
+// Collect the frameworks in the order they are scanned. First all
+// sub-frameworks, because we most likely will depend on them, then all
+// versions, then the framework itself.
+static void collectFrameworks(Framework &framework,
+                              std::vector<Framework *> &frameworks) {
+  for (auto &F : framework._subFrameworks)
+    collectFrameworks(F, frameworks);
+
+  for (auto &F : framework._versions)
+    collectFrameworks(F, frameworks);
+
+  frameworks.push_back(&framework);
+}
+
 static Error scanFramework(sdkdb::Context &context, Framework &framework,
                            bool isPublic, bool binaryOnly) {
-  //
-  // First scan all sub-frameworks, because we most likely will depend on them.
-  //
-  for (auto &F : framework._subFrameworks) {
-    if (auto err = scanFramework(context, F, isPublic, binaryOnly))
-      return err;
-  }
-
-  //
-  // Second scan all versions ...
-  //
-  for (auto &F : framework._versions) {
-    if (auto err = scanFramework(context, F, isPublic, binaryOnly))
-      return err;
+  auto &diag = context.getDiag();
+  std::vector<Framework *> frameworks;
+  collectFrameworks(framework, frameworks);
+
+  std::vector<sdkdb::FrameworkScan> scans(frameworks.size());
+  std::vector<sdkdb::BinaryTask *> binaries;
+  for (size_t i = 0; i < frameworks.size(); ++i) {
+    auto &scan = scans[i];
+    scan.framework = frameworks[i];
+    for (const auto &path : scan.framework->_dynamicLibraryFiles) {
+      scan.binaries.emplace_back();
+      scan.binaries.back().path = path;
+    }
+    for (auto &binary : scan.binaries) {
+      // The file manager caches lookups and is not thread safe.
+      if (!context.getFileManager().exists(binary.path))
+        binary.result.emplace(make_error<StringError>(
+            "binary file doesn't exist", inconvertibleErrorCode()));
+      else
+        binaries.push_back(&binary);
+    }
   }
 
   //
-  // Now scan the framework binary.
+  // Read the framework binaries.
   //
-  std::vector<Triple> triples;
-  for (const auto &path : framework._dynamicLibraryFiles) {
-    if (auto err = context.scanBinaryFile(path, triples, isPublic))
-      return err;
+  // The binaries are already spread over the threads. Only a single binary
+  // gets them for its slices instead.
+  const unsigned sliceThreads = binaries.size() == 1 ? context.numThreads : 1;
+  runConcurrently(context.numThreads, binaries.size(), [&](size_t i) {
+    binaries[i]->result.emplace(
+        context.readBinaryFile(binaries[i]->path, sliceThreads));
+  });
+
+  // A serial scan stops at the first binary it cannot read, so only the
+  // frameworks before that one are added.
+  Error error = Error::success();
+  size_t end = scans.size();
+  for (size_t i = 0; i < scans.size(); ++i) {
+    for (auto &binary : scans[i].binaries) {
+      auto &result = *binary.result;
+      if (!result) {
+        if (i < end) {
+          end = i;
+          cantFail(std::move(error));
+          error = result.takeError();
+        } else
+          consumeError(result.takeError());
+        continue;
+      }
+      if (i < end)
+        context.addBinaryResults(*result, scans[i].triples, isPublic);
+    }
   }
 
   if (binaryOnly)
-    return Error::success();
-
-  // If there are no binaries, guess the triple from environment.
-  if (triples.empty())
-    inferTriplesFromEnvironment(context, framework, triples);
+    return error;
 
+  //
   // Now scan the header files.
-  if (!computeFrontendResultFromFramework(context, framework, triples,
-        isPublic)) {
-    if (!context.hasSDKDBError) {
-      context.hasSDKDBError = true;
-      context.getDiag().report(diag::err_cannot_generate_sdkdb)
-          << "Failed to scan header interface";
+  //
+  std::vector<FrontendTask *> frontends;
+  for (size_t i = 0; i < end; ++i) {
+    auto &scan = scans[i];
+    // If there are no binaries, guess the triple from environment.
+    if (scan.triples.empty())
+      inferTriplesFromEnvironment(context, *scan.framework, scan.triples);
+
+    scan.prepared = prepareFrontendTasks(context, *scan.framework,
+                                         scan.triples, isPublic,
+                                         scan.frontends);
+    for (auto &task : scan.frontends)
+      frontends.push_back(&task);
+  }
+
+  runConcurrently(context.numThreads, frontends.size(),
+                  [&](size_t i) { runFrontendTask(*frontends[i]); });
+
+  // Preparing the header scans reports errors for all frameworks up front. A
+  // serial scan gives up on the headers of the remaining frameworks once an
+  // error has been reported, so do the same for errors reported below.
+  bool hadError = diag.hasErrorOccurred();
+  for (size_t i = 0; i < end; ++i) {
+    auto &scan = scans[i];
+    bool failed = !scan.prepared ||
+                  (!scan.frontends.empty() &&
+                   (context.hasSDKDBError ||
+                    (!hadError && diag.hasErrorOccurred())));
+    if (failed || !addFrontendResults(context, scan.frontends, isPublic)) {
+      if (!context.hasSDKDBError) {
+        context.hasSDKDBError = true;
+        diag.report(diag::err_cannot_generate_sdkdb)
+            << "Failed to scan header interface";
+      }
     }
-  }
 
-  // Scan swift interfaces.
-  if (auto err = computeSwiftInterfacesFromFramework(context, framework,
-                                                     triples, isPublic)) {
-    context.hasSDKDBError = true;
-    context.getDiag().report(diag::err_cannot_generate_sdkdb)
-        << toString(std::move(err));
+    // Scan swift interfaces.
+    if (auto err = computeSwiftInterfacesFromFramework(
+            context, *scan.framework, scan.triples, isPublic)) {
+      context.hasSDKDBError = true;
+      diag.report(diag::err_cannot_generate_sdkdb)
+          << toString(std::move(err));
+    }
   }
 
-  return Error::success();
+  return error;
 }
 
 static bool interfaceScan(sdkdb::Context &context, Options &opts) {
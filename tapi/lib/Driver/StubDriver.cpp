@@ -39,10 +39,12 @@ TAPI_NAMESPACE_INTERNAL_BEGIN
 namespace {
 
 struct Context {
-  Context(FileManager &fm, DiagnosticsEngine &diag, bool isBnI)
+  Context(FileManager &fm, DiagnosticsEngine &diag, bool isBnI,
+          unsigned numThreads)
       : fm(fm), diag(diag),
-        interfaceMgr(InterfaceFileManager(fm, /*isVolatile=*/isBnI)) {
-    registry.addBinaryReaders();
+        interfaceMgr(
+            InterfaceFileManager(fm, /*isVolatile=*/isBnI, numThreads)) {
+    registry.addBinaryReaders(numThreads);
     registry.addYAMLReaders();
     registry.addYAMLWriters();
     registry.addJSONReaders();
@@ -573,7 +575,8 @@ bool Driver::Stub::run(DiagnosticsEngine &diag, Options &opts) {
   }
 
   // FIME: Copy everything for now.
-  Context ctx(opts.getFileManager(), diag, opts.tapiOptions.isBnI);
+  Context ctx(opts.getFileManager(), diag, opts.tapiOptions.isBnI,
+              opts.driverOptions.numThreads);
   ctx.deleteInputFile = opts.tapiOptions.deleteInputFile;
   ctx.inlinePrivateFrameworks = opts.tapiOptions.inlinePrivateFrameworks;
   ctx.deletePrivateFrameworks = opts.tapiOptions.deletePrivateFrameworks;
@@ -129,8 +129,13 @@ CompilerInvocation *newInvocation(clang::DiagnosticsEngine *diagnostics,
   return invocation;
 }
 
+static raw_ostream &getDiagnosticStream(const FrontendJob &job) {
+  return job.diagnosticStream ? *job.diagnosticStream : llvm::errs();
+}
+
 static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
-                     std::unique_ptr<llvm::MemoryBuffer> input) {
+                     std::unique_ptr<llvm::MemoryBuffer> input,
+                     raw_ostream &diagnosticStream) {
   context.compiler = std::make_unique<CompilerInstance>();
   IntrusiveRefCntPtr<DiagnosticIDs> diagID(new DiagnosticIDs());
   IntrusiveRefCntPtr<DiagnosticOptions> diagOpts(new DiagnosticOptions());
@@ -144,7 +149,7 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
   llvm::opt::InputArgList parsedArgs = opts.ParseArgs(
       ArrayRef<const char *>(argv).slice(1), MissingArgIndex, MissingArgCount);
   ParseDiagnosticArgs(*diagOpts, parsedArgs);
-  TextDiagnosticPrinter diagnosticPrinter(llvm::errs(), &*diagOpts);
+  TextDiagnosticPrinter diagnosticPrinter(diagnosticStream, &*diagOpts);
   clang::DiagnosticsEngine diagnosticsEngine(diagID, &*diagOpts,
                                              &diagnosticPrinter, false);
 
@@ -167,9 +172,9 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
 
   // Show the invocation, with -v.
   if (invocation->getHeaderSearchOpts().Verbose) {
-    llvm::errs() << "clang Invocation:\n";
-    compilation->getJobs().Print(llvm::errs(), "\n", true);
-    llvm::errs() << "\n";
+    diagnosticStream << "clang Invocation:\n";
+    compilation->getJobs().Print(diagnosticStream, "\n", true);
+    diagnosticStream << "\n";
   }
 
   if (input)
@@ -182,35 +187,44 @@ static bool runClang(FrontendContext &context, ArrayRef<std::string> options,
   auto action = std::make_unique<APIVisitorAction>(context);
 
   // Create the compiler's actual diagnostics engine.
-  context.compiler->createDiagnostics();
+  context.compiler->createDiagnostics(new TextDiagnosticPrinter(
+      diagnosticStream, &context.compiler->getDiagnosticOpts()));
   if (!context.compiler->hasDiagnostics())
     return false;
+  context.compiler->setVerboseOutputStream(diagnosticStream);
 
   context.compiler->createSourceManager(*(context.fileManager));
   context.verifier->setSourceManager(context.compiler->getSourceManager());
 
-  return context.compiler->ExecuteAction(*action);
+  bool success = context.compiler->ExecuteAction(*action);
+
+  // The compiler outlives the job's stream, so anything it reports later
+  // goes to llvm::errs().
+  if (&diagnosticStream != &llvm::errs()) {
+    context.compiler->getDiagnostics().setClient(new TextDiagnosticPrinter(
+        llvm::errs(), &context.compiler->getDiagnosticOpts()));
+    context.compiler->setVerboseOutputStream(llvm::errs());
+  }
+  return success;
 }
 
 static std::string getClangExecutablePath() {
   static int staticSymbol;
-  static std::string clangExecutablePath;
-
-  if (!clangExecutablePath.empty())
-    return clangExecutablePath;
-
-  // Try to find clang first in the toolchain. If that fails, then fall-back to
-  // the default search PATH.
-  auto mainExecutable = sys::fs::getMainExecutable("tapi", &staticSymbol);
-  StringRef toolchainBinDir = sys::path::parent_path(mainExecutable);
-  auto clangBinary =
-      sys::findProgramByName("clang", makeArrayRef(toolchainBinDir));
-  if (clangBinary.getError())
-    clangBinary = sys::findProgramByName("clang");
-  if (auto ec = clangBinary.getError())
-    clangExecutablePath = "clang";
-  else
-    clangExecutablePath = clangBinary.get();
+  // Look it up only once. The initialization of a local static is thread
+  // safe, so frontend jobs running concurrently can share the result.
+  static const std::string clangExecutablePath = [] {
+    // Try to find clang first in the toolchain. If that fails, then fall-back
+    // to the default search PATH.
+    auto mainExecutable = sys::fs::getMainExecutable("tapi", &staticSymbol);
+    StringRef toolchainBinDir = sys::path::parent_path(mainExecutable);
+    auto clangBinary =
+        sys::findProgramByName("clang", makeArrayRef(toolchainBinDir));
+    if (clangBinary.getError())
+      clangBinary = sys::findProgramByName("clang");
+    if (auto ec = clangBinary.getError())
+      return std::string("clang");
+    return clangBinary.get();
+  }();
 
   return clangExecutablePath;
 }
@@ -269,9 +283,10 @@ static void createClangReproducer(const FrontendJob &job,
   tempFileTemplate += getFileExtension(job.language).str();
   SmallString<PATH_MAX> tempFile;
   int fd;
+  auto &os = getDiagnosticStream(job);
   auto ec = sys::fs::createUniqueFile(tempFileTemplate, fd, tempFile);
   if (ec) {
-    errs() << "Cannot create temporary file for clang reproducer\n";
+    os << "Cannot create temporary file for clang reproducer\n";
     return;
   }
   raw_fd_ostream fs(fd, /*shouldClose=*/ true);
@@ -282,7 +297,7 @@ static void createClangReproducer(const FrontendJob &job,
   sys::path::replace_extension(tempFile, "sh");
   raw_fd_ostream sh(tempFile, ec);
   if (ec) {
-    errs() << "Cannot create temporary file for clang reproducer\n";
+    os << "Cannot create temporary file for clang reproducer\n";
     return;
   }
   SmallString<2048> argStr;
@@ -298,11 +313,11 @@ static void createClangReproducer(const FrontendJob &job,
   sys::path::replace_extension(
       diagPath,
       "{" + getFileExtension(job.language).drop_front(1).str() + ",sh}");
-  errs() << "\nNote: a reproducer of the error is written to: \"" << diagPath
-         << "\".\n";
-  errs() << "Note: the reproducer is intended to help users to debug the issue "
-            "under a more familiar context using clang.\n";
-  errs() << "Note: the paths in the reproducer might need to be adjusted.\n";
+  os << "\nNote: a reproducer of the error is written to: \"" << diagPath
+     << "\".\n";
+  os << "Note: the reproducer is intended to help users to debug the issue "
+        "under a more familiar context using clang.\n";
+  os << "Note: the paths in the reproducer might need to be adjusted.\n";
 }
 
 extern Expected<FrontendContext> runFrontend(const FrontendJob &job,
@@ -451,7 +466,7 @@ extern Expected<FrontendContext> runFrontend(const FrontendJob &job,
     args.emplace_back(arg);
 
   args.emplace_back(inputFilePath);
-  if (runClang(context, args, std::move(input)))
+  if (runClang(context, args, std::move(input), getDiagnosticStream(job)))
     return context;
 
   // Create a reproducer.
@@ -472,4 +487,25 @@ bool canIgnoreFrontendError(llvm::Error &error) {
   return canIgnore;
 }
 
+std::unique_ptr<FrontendJob> copyFrontendJob(const FrontendJob &job) {
+  auto copy = std::make_unique<FrontendJob>();
+  static_cast<FrontendJobSettings &>(*copy) = job;
+  return copy;
+}
+
+void runFrontendTask(FrontendTask &task) {
+  raw_string_ostream diagnosticStream(task.diagnostics);
+  diagnosticStream.enable_colors(llvm::errs().has_colors());
+  task.job->diagnosticStream = &diagnosticStream;
+  auto contextOrError = runFrontend(*task.job);
+  task.job->diagnosticStream = nullptr;
+  diagnosticStream.flush();
+  if (auto err = contextOrError.takeError()) {
+    task.failed = !canIgnoreFrontendError(err);
+    return;
+  }
+
+  task.result.emplace(std::move(*contextOrError));
+}
+
 TAPI_NAMESPACE_INTERNAL_END
@@ -0,0 +1,6 @@
+__attribute__((visibility("default"))) int baz() {
+  int x = 3;
+  return x;
+}
+
+__attribute__((visibility("default"))) int qux = 1;
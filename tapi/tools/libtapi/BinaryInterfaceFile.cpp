@@ -0,0 +1,335 @@
+//===- libtapi/BinaryInterfaceFile.cpp - Binary Interface File --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Implements the compact binary encoding of a text-based stub file.
+///
+//===----------------------------------------------------------------------===//
+
+#include "BinaryInterfaceFile.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Alignment.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/TextAPI/PackedVersion.h"
+#include <cstring>
+#include <tapi/Version.h>
+#include <tuple>
+
+using namespace llvm;
+using namespace llvm::MachO;
+
+TAPI_NAMESPACE_INTERNAL_BEGIN
+
+namespace {
+
+struct SymbolRecord {
+  StringRef name;
+  SymbolKind kind;
+  SymbolFlags flags;
+
+  bool operator<(const SymbolRecord &o) const {
+    return std::tie(name, kind) < std::tie(o.name, o.kind);
+  }
+};
+
+class Encoder {
+public:
+  Encoder(SmallVectorImpl<char> &out) : _out(out) {}
+
+  uint32_t addString(StringRef str) {
+    auto result = _strings.try_emplace(str, _pool.size());
+    if (result.second) {
+      _pool.insert(_pool.end(), str.begin(), str.end());
+      _pool.push_back('\0');
+    }
+    return result.first->second;
+  }
+
+  template <typename T> uint64_t addArray(ArrayRef<T> values) {
+    _out.resize(alignTo(_out.size(), 8));
+    uint64_t offset = _out.size();
+    auto *bytes = reinterpret_cast<const char *>(values.data());
+    _out.append(bytes, bytes + values.size() * sizeof(T));
+    return offset;
+  }
+
+  template <typename T> void write(uint64_t offset, const T &value) {
+    std::memcpy(_out.data() + offset, &value, sizeof(T));
+  }
+
+  std::vector<binary::SymbolEntry>
+  addSymbols(std::vector<SymbolRecord> &records) {
+    llvm::sort(records);
+    std::vector<binary::SymbolEntry> entries;
+    entries.reserve(records.size());
+    for (const auto &record : records)
+      entries.push_back({addString(record.name),
+                         static_cast<uint16_t>(record.kind),
+                         static_cast<uint16_t>(record.flags)});
+    return entries;
+  }
+
+  binary::Arch addArch(const InterfaceFile &interface, Architecture arch);
+  binary::Document addDocument(const InterfaceFile &interface);
+  uint64_t addStringPool() { return addArray(makeArrayRef(_pool)); }
+  uint64_t getStringPoolSize() const { return _pool.size(); }
+
+private:
+  SmallVectorImpl<char> &_out;
+  StringMap<uint32_t> _strings;
+  std::vector<char> _pool;
+};
+
+} // end anonymous namespace.
+
+binary::Arch Encoder::addArch(const InterfaceFile &interface,
+                              Architecture arch) {
+  binary::Arch entry{};
+  entry.arch = arch;
+  entry.parentFrameworkName = binary::kNone;
+
+  std::vector<binary::Target> targets;
+  for (const auto &target : interface.targets()) {
+    if (target.Arch != arch || target.Platform == PLATFORM_UNKNOWN)
+      continue;
+    PackedVersion minDeployment;
+    minDeployment.parse32(target.MinDeployment.getAsString());
+    targets.push_back({static_cast<uint32_t>(target.Platform),
+                       minDeployment.rawValue()});
+  }
+
+  for (const auto &it : interface.umbrellas()) {
+    if (it.first.Arch != arch)
+      continue;
+    entry.parentFrameworkName = addString(it.second);
+    break;
+  }
+
+  std::vector<SymbolRecord> exports, undefineds;
+  for (const auto *symbol : interface.symbols()) {
+    if (!symbol->hasArchitecture(arch))
+      continue;
+    auto &records = symbol->isUndefined() ? undefineds : exports;
+    records.push_back(
+        {symbol->getName(), symbol->getKind(), symbol->getFlags()});
+  }
+  auto exportEntries = addSymbols(exports);
+  auto undefinedEntries = addSymbols(undefineds);
+
+  std::vector<uint32_t> allowableClients, reexportedLibraries, rpaths;
+  for (const auto &lib : interface.allowableClients())
+    for (const auto &target : lib.targets())
+      if (target.Arch == arch)
+        allowableClients.push_back(addString(lib.getInstallName()));
+
+  for (const auto &lib : interface.reexportedLibraries())
+    for (const auto &target : lib.targets())
+      if (target.Arch == arch)
+        reexportedLibraries.push_back(addString(lib.getInstallName()));
+
+  for (const auto &[target, path] : interface.rpaths())
+    if (target.Arch == arch)
+      rpaths.push_back(addString(path));
+
+  entry.targetCount = targets.size();
+  entry.targetsOffset = addArray(makeArrayRef(targets));
+  entry.exportCount = exportEntries.size();
+  entry.exportsOffset = addArray(makeArrayRef(exportEntries));
+  entry.undefinedCount = undefinedEntries.size();
+  entry.undefinedsOffset = addArray(makeArrayRef(undefinedEntries));
+  entry.allowableClientCount = allowableClients.size();
+  entry.allowableClientsOffset = addArray(makeArrayRef(allowableClients));
+  entry.reexportedLibraryCount = reexportedLibraries.size();
+  entry.reexportedLibrariesOffset = addArray(makeArrayRef(reexportedLibraries));
+  entry.rpathCount = rpaths.size();
+  entry.rpathsOffset = addArray(makeArrayRef(rpaths));
+  return entry;
+}
+
+binary::Document Encoder::addDocument(const InterfaceFile &interface) {
+  binary::Document document{};
+  document.installName = addString(interface.getInstallName());
+  document.currentVersion = interface.getCurrentVersion().rawValue();
+  document.compatibilityVersion =
+      interface.getCompatibilityVersion().rawValue();
+  document.swiftABIVersion = interface.getSwiftABIVersion();
+  if (interface.isTwoLevelNamespace())
+    document.flags |= binary::TwoLevelNamespace;
+  if (interface.isApplicationExtensionSafe())
+    document.flags |= binary::ApplicationExtensionSafe;
+
+  std::vector<uint32_t> platforms;
+  for (auto platform : interface.getPlatforms())
+    platforms.push_back(static_cast<uint32_t>(platform));
+  llvm::sort(platforms);
+  document.platformCount = platforms.size();
+  document.platformsOffset = addArray(makeArrayRef(platforms));
+
+  // ArchitectureSet iterates in architecture order, which keeps the table
+  // sorted for findArch.
+  std::vector<binary::Arch> archs;
+  for (auto arch : interface.getArchitectures())
+    archs.push_back(addArch(interface, arch));
+  document.archCount = archs.size();
+  document.archsOffset = addArray(makeArrayRef(archs));
+  return document;
+}
+
+/// \brief Identify the tapi that wrote an encoded file. A cached file written by
+///        a different tapi is not trusted, even if the encoding version matches.
+static uint64_t getToolVersion() {
+  static const uint64_t toolVersion =
+      xxHash64(tapi::Version::getFullVersionAsString());
+  return toolVersion;
+}
+
+void BinaryInterfaceFile::encode(const InterfaceFile &interface,
+                                 uint64_t contentHash, uint64_t contentSize,
+                                 SmallVectorImpl<char> &out) {
+  out.clear();
+  Encoder encoder(out);
+
+  binary::Header header{};
+  std::memcpy(header.magic, binary::kMagic, sizeof(header.magic));
+  header.version = binary::kVersion;
+  header.contentHash = contentHash;
+  header.contentSize = contentSize;
+  header.toolVersion = getToolVersion();
+  encoder.addArray(makeArrayRef(header));
+
+  // Only the file itself lists its inlined documents.
+  std::vector<binary::Document> documents;
+  documents.push_back(encoder.addDocument(interface));
+  for (const auto &document : interface.documents())
+    documents.push_back(encoder.addDocument(*document));
+
+  header.documentCount = documents.size();
+  header.documentsOffset = encoder.addArray(makeArrayRef(documents));
+  header.stringsSize = encoder.getStringPoolSize();
+  header.stringsOffset = encoder.addStringPool();
+  encoder.write(0, header);
+}
+
+template <typename T>
+bool BinaryInterfaceFile::isValidArray(uint64_t offset, uint32_t count) const {
+  if (offset % alignof(T) != 0)
+    return false;
+  uint64_t size = _buffer->getBufferSize();
+  return offset <= size && count <= (size - offset) / sizeof(T);
+}
+
+bool BinaryInterfaceFile::isValid() const {
+  // Tables are read in place, so the buffer itself must be suitably aligned.
+  if (reinterpret_cast<uintptr_t>(_buffer->getBufferStart()) % 8 != 0)
+    return false;
+  if (!isValidArray<char>(_header->stringsOffset, _header->stringsSize) ||
+      _header->stringsSize == 0 || _header->stringsSize > binary::kNone)
+    return false;
+  if (_buffer->getBufferStart()[_header->stringsOffset + _header->stringsSize -
+                                1] != '\0')
+    return false;
+  if (!isValidArray<binary::Document>(_header->documentsOffset,
+                                      _header->documentCount) ||
+      _header->documentCount == 0)
+    return false;
+
+  for (unsigned i = 0, e = getNumDocuments(); i != e; ++i) {
+    const auto &document = getDocument(i);
+    if (!isValidArray<uint32_t>(document.platformsOffset,
+                                document.platformCount) ||
+        !isValidArray<binary::Arch>(document.archsOffset, document.archCount))
+      return false;
+
+    for (const auto &arch : archs(document)) {
+      if (!isValidArray<binary::Target>(arch.targetsOffset,
+                                        arch.targetCount) ||
+          !isValidArray<binary::SymbolEntry>(arch.exportsOffset,
+                                             arch.exportCount) ||
+          !isValidArray<binary::SymbolEntry>(arch.undefinedsOffset,
+                                             arch.undefinedCount) ||
+          !isValidArray<uint32_t>(arch.allowableClientsOffset,
+                                  arch.allowableClientCount) ||
+          !isValidArray<uint32_t>(arch.reexportedLibrariesOffset,
+                                  arch.reexportedLibraryCount) ||
+          !isValidArray<uint32_t>(arch.rpathsOffset, arch.rpathCount))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+Expected<std::unique_ptr<const BinaryInterfaceFile>>
+BinaryInterfaceFile::create(std::unique_ptr<MemoryBuffer> buffer,
+                            uint64_t contentHash, uint64_t contentSize) {
+  auto makeError = [&](const Twine &reason) {
+    return make_error<StringError>(buffer->getBufferIdentifier() + ": " +
+                                       reason,
+                                   inconvertibleErrorCode());
+  };
+
+  if (buffer->getBufferSize() < sizeof(binary::Header))
+    return makeError("file too small");
+
+  const auto *header =
+      reinterpret_cast<const binary::Header *>(buffer->getBufferStart());
+  if (std::memcmp(header->magic, binary::kMagic, sizeof(header->magic)) != 0)
+    return makeError("invalid magic");
+  if (header->version != binary::kVersion)
+    return makeError("unsupported version " + Twine(header->version));
+  if (header->contentHash != contentHash || header->contentSize != contentSize)
+    return makeError("content mismatch");
+  if (header->toolVersion != getToolVersion())
+    return makeError("written by a different tapi");
+
+  std::unique_ptr<const BinaryInterfaceFile> file(
+      new BinaryInterfaceFile(std::move(buffer)));
+  if (!file->isValid())
+    return make_error<StringError>(
+        file->_buffer->getBufferIdentifier() + ": malformed file",
+        inconvertibleErrorCode());
+
+  return std::move(file);
+}
+
+const binary::Arch *
+BinaryInterfaceFile::findArch(const binary::Document &document,
+                              Architecture arch) const {
+  auto table = archs(document);
+  const auto *it = llvm::partition_point(
+      table, [&](const binary::Arch &entry) { return entry.arch < arch; });
+  if (it == table.end() || it->arch != arch)
+    return nullptr;
+  return it;
+}
+
+bool BinaryInterfaceFile::equalSymbols(const BinaryInterfaceFile &lhsFile,
+                                       ArrayRef<binary::SymbolEntry> lhs,
+                                       const BinaryInterfaceFile &rhsFile,
+                                       ArrayRef<binary::SymbolEntry> rhs) {
+  // Only compare the flags the linker sees.
+  const uint16_t mask =
+      static_cast<uint16_t>(SymbolFlags::ThreadLocalValue |
+                            SymbolFlags::WeakDefined |
+                            SymbolFlags::WeakReferenced);
+
+  if (lhs.size() != rhs.size())
+    return false;
+
+  for (size_t i = 0, e = lhs.size(); i != e; ++i) {
+    if (lhs[i].kind != rhs[i].kind ||
+        (lhs[i].flags & mask) != (rhs[i].flags & mask) ||
+        lhsFile.getString(lhs[i].name) != rhsFile.getString(rhs[i].name))
+      return false;
+  }
+
+  return true;
+}
+
+TAPI_NAMESPACE_INTERNAL_END
@@ -0,0 +1,203 @@
+//===- libtapi/BinaryInterfaceFile.h - Binary Interface File ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the compact binary encoding of a text-based stub file that
+///        backs the linker interface file.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef TAPI_LIBTAPI_BINARY_INTERFACE_FILE_H
+#define TAPI_LIBTAPI_BINARY_INTERFACE_FILE_H
+
+#include "tapi/Core/LLVM.h"
+#include "tapi/Defines.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/TextAPI/InterfaceFile.h"
+#include <cstdint>
+#include <memory>
+
+TAPI_NAMESPACE_INTERNAL_BEGIN
+
+namespace binary {
+
+// Layout of an encoded interface file. The encoding is meant to be mapped: a
+// header followed by tables that are each 8 byte aligned and in host byte
+// order. Everything the linker asks for is already split by architecture, so
+// loading a file for one architecture only touches that architecture's
+// tables. Names and paths are offsets into a pool of zero terminated strings.
+
+constexpr char kMagic[8] = {'t', 'a', 'p', 'i', 't', 'b', 'd', 'b'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kNone = 0xFFFFFFFF;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t documentCount;   // document 0 is the file, the rest are inlined
+  uint64_t contentHash;     // xxHash64 of the text-based stub file
+  uint64_t contentSize;     // size of the text-based stub file
+  uint64_t toolVersion;     // xxHash64 of the full version of the writing tapi
+  uint64_t documentsOffset; // Document[documentCount]
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+};
+
+enum DocumentFlags : uint32_t {
+  TwoLevelNamespace = 1U << 0,
+  ApplicationExtensionSafe = 1U << 1,
+};
+
+struct Document {
+  uint32_t installName;          // string offset
+  uint32_t currentVersion;       // packed version
+  uint32_t compatibilityVersion; // packed version
+  uint32_t swiftABIVersion;
+  uint32_t flags;                // DocumentFlags
+  uint32_t platformCount;
+  uint32_t archCount;
+  uint32_t reserved;
+  uint64_t platformsOffset;      // uint32_t[platformCount], sorted
+  uint64_t archsOffset;          // Arch[archCount], sorted by architecture
+};
+
+struct Arch {
+  uint32_t arch;                 // llvm::MachO::Architecture
+  uint32_t parentFrameworkName;  // string offset, or kNone
+  uint32_t targetCount;
+  uint32_t exportCount;
+  uint32_t undefinedCount;
+  uint32_t allowableClientCount;
+  uint32_t reexportedLibraryCount;
+  uint32_t rpathCount;
+  uint64_t targetsOffset;        // Target[targetCount]
+  uint64_t exportsOffset;        // SymbolEntry[exportCount], sorted
+  uint64_t undefinedsOffset;     // SymbolEntry[undefinedCount], sorted
+  uint64_t allowableClientsOffset;   // uint32_t[], string offsets
+  uint64_t reexportedLibrariesOffset; // uint32_t[], string offsets
+  uint64_t rpathsOffset;         // uint32_t[], string offsets
+};
+
+struct Target {
+  uint32_t platform;             // llvm::MachO::PlatformType
+  uint32_t minDeployment;        // packed version
+};
+
+struct SymbolEntry {
+  uint32_t name;                 // string offset
+  uint16_t kind;                 // llvm::MachO::SymbolKind
+  uint16_t flags;                // llvm::MachO::SymbolFlags
+};
+
+} // end namespace binary.
+
+/// \brief Read-only view of an encoded interface file.
+///
+/// Symbol tables are sorted by name and then by kind, which makes comparing
+/// two files a linear walk.
+class BinaryInterfaceFile {
+public:
+  /// \brief Encode the interface file and its inlined documents.
+  static void encode(const llvm::MachO::InterfaceFile &interface,
+                     uint64_t contentHash, uint64_t contentSize,
+                     SmallVectorImpl<char> &out);
+
+  /// \brief Validate the buffer and take ownership of it. The header must match
+  ///        the given content hash and size.
+  static llvm::Expected<std::unique_ptr<const BinaryInterfaceFile>>
+  create(std::unique_ptr<MemoryBuffer> buffer, uint64_t contentHash,
+         uint64_t contentSize);
+
+  unsigned getNumDocuments() const { return _header->documentCount; }
+
+  const binary::Document &getDocument(unsigned index) const {
+    return getArray<binary::Document>(_header->documentsOffset,
+                                      _header->documentCount)[index];
+  }
+
+  ArrayRef<binary::Arch> archs(const binary::Document &document) const {
+    return getArray<binary::Arch>(document.archsOffset, document.archCount);
+  }
+
+  ArrayRef<uint32_t> platforms(const binary::Document &document) const {
+    return getArray<uint32_t>(document.platformsOffset, document.platformCount);
+  }
+
+  /// \brief Find the tables for the architecture, or nullptr.
+  const binary::Arch *findArch(const binary::Document &document,
+                               llvm::MachO::Architecture arch) const;
+
+  ArrayRef<binary::Target> targets(const binary::Arch &arch) const {
+    return getArray<binary::Target>(arch.targetsOffset, arch.targetCount);
+  }
+
+  ArrayRef<binary::SymbolEntry> exports(const binary::Arch &arch) const {
+    return getArray<binary::SymbolEntry>(arch.exportsOffset, arch.exportCount);
+  }
+
+  ArrayRef<binary::SymbolEntry> undefineds(const binary::Arch &arch) const {
+    return getArray<binary::SymbolEntry>(arch.undefinedsOffset,
+                                         arch.undefinedCount);
+  }
+
+  ArrayRef<uint32_t> allowableClients(const binary::Arch &arch) const {
+    return getArray<uint32_t>(arch.allowableClientsOffset,
+                              arch.allowableClientCount);
+  }
+
+  ArrayRef<uint32_t> reexportedLibraries(const binary::Arch &arch) const {
+    return getArray<uint32_t>(arch.reexportedLibrariesOffset,
+                              arch.reexportedLibraryCount);
+  }
+
+  ArrayRef<uint32_t> rpaths(const binary::Arch &arch) const {
+    return getArray<uint32_t>(arch.rpathsOffset, arch.rpathCount);
+  }
+
+  /// \brief Get the string at the offset. Offsets outside of the string pool
+  ///        yield an empty string.
+  StringRef getString(uint32_t offset) const {
+    if (offset >= _header->stringsSize)
+      return {};
+    return StringRef(_buffer->getBufferStart() + _header->stringsOffset +
+                     offset);
+  }
+
+  /// \brief Compare the symbol tables of two architectures by name, kind, and
+  ///        flags.
+  static bool equalSymbols(const BinaryInterfaceFile &lhsFile,
+                           ArrayRef<binary::SymbolEntry> lhs,
+                           const BinaryInterfaceFile &rhsFile,
+                           ArrayRef<binary::SymbolEntry> rhs);
+
+private:
+  BinaryInterfaceFile(std::unique_ptr<MemoryBuffer> buffer)
+      : _buffer(std::move(buffer)),
+        _header(reinterpret_cast<const binary::Header *>(
+            _buffer->getBufferStart())) {}
+
+  template <typename T>
+  ArrayRef<T> getArray(uint64_t offset, uint32_t count) const {
+    return ArrayRef<T>(
+        reinterpret_cast<const T *>(_buffer->getBufferStart() + offset), count);
+  }
+
+  template <typename T> bool isValidArray(uint64_t offset, uint32_t count) const;
+  bool isValid() const;
+
+  std::unique_ptr<MemoryBuffer> _buffer;
+  const binary::Header *_header;
+};
+
+TAPI_NAMESPACE_INTERNAL_END
+
+#endif // TAPI_LIBTAPI_BINARY_INTERFACE_FILE_H
@@ -10,11 +10,17 @@
 /// \brief Implements the C++ linker interface file API.
 ///
 //===----------------------------------------------------------------------===//
+#include "BinaryInterfaceFile.h"
 #include "tapi/Core/LLVM.h"
 #include "tapi/Core/Registry.h"
 #include "tapi/Core/Utils.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Object/MachO.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include "llvm/TextAPI/InterfaceFile.h"
 #include <string>
 #include <tapi/LinkerInterfaceFile.h>
@@ -99,6 +105,8 @@ public:
   std::vector<Symbol> _undefineds;
   std::shared_ptr<const InterfaceFile> _interface;
   std::vector<std::shared_ptr<const InterfaceFile>> _inlinedFrameworks;
+  std::shared_ptr<const BinaryInterfaceFile> _file;
+  std::string _path;
 
   Impl() noexcept = default;
 
@@ -106,6 +114,11 @@ public:
             cpu_type_t cpuType, cpu_subtype_t cpuSubType, ParsingFlags flags,
             PackedVersion32 minOSVersion, std::string &errorMessage) noexcept;
 
+  bool init(const std::shared_ptr<const BinaryInterfaceFile> &file,
+            unsigned document, StringRef path, cpu_type_t cpuType,
+            cpu_subtype_t cpuSubType, ParsingFlags flags,
+            PackedVersion32 minOSVersion, std::string &errorMessage) noexcept;
+
   template <typename T>
   void addSymbol(T &&name, llvm::MachO::SymbolFlags flags) {
     if (find(_ignoreExports, name) == _ignoreExports.end())
@@ -178,6 +191,7 @@ static Architecture getArchForCPU(cpu_type_t cpuType, cpu_subtype_t cpuSubType,
   return AK_unknown;
 }
 
+
 LinkerInterfaceFile::LinkerInterfaceFile() noexcept
     : _pImpl{new LinkerInterfaceFile::Impl} {}
 LinkerInterfaceFile::~LinkerInterfaceFile() noexcept = default;
@@ -211,6 +225,70 @@ loadFile(std::unique_ptr<MemoryBuffer> buffer,
   return std::make_unique<const InterfaceFile>(InterfaceFile());
 }
 
+/// \brief Get the directory that caches encoded interface files, if the
+///        cache is enabled.
+static Optional<std::string> getCacheDirectory() {
+  auto dir = llvm::sys::Process::GetEnv("TAPI_LINKER_CACHE_DIR");
+  if (!dir || dir->empty())
+    return None;
+  return dir;
+}
+
+/// \brief Load the encoded form of the text-based stub file in the buffer.
+///
+/// Encoded files are cached by the hash of the text-based stub file contents.
+/// A cache hit maps the encoded file without parsing the text-based stub file.
+static Expected<std::shared_ptr<const BinaryInterfaceFile>>
+loadBinaryFile(std::unique_ptr<MemoryBuffer> buffer) {
+  auto contents = buffer->getBuffer();
+  auto contentHash = xxHash64(contents);
+  uint64_t contentSize = contents.size();
+
+  SmallString<PATH_MAX> cachePath;
+  if (auto dir = getCacheDirectory()) {
+    cachePath = *dir;
+    sys::path::append(cachePath, utohexstr(contentHash, /*LowerCase=*/true) +
+                                     "-" + utostr(contentSize) + ".tbdb");
+    auto cachedOrError = MemoryBuffer::getFile(
+        cachePath, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (cachedOrError) {
+      auto file = BinaryInterfaceFile::create(std::move(cachedOrError.get()),
+                                              contentHash, contentSize);
+      if (file)
+        return std::shared_ptr<const BinaryInterfaceFile>(std::move(*file));
+      // A stale or damaged entry is replaced below.
+      consumeError(file.takeError());
+    }
+  }
+
+  auto identifier = buffer->getBufferIdentifier().str();
+  auto interfaceOrError = loadFile(std::move(buffer));
+  if (!interfaceOrError)
+    return interfaceOrError.takeError();
+
+  SmallVector<char, 0> data;
+  BinaryInterfaceFile::encode(**interfaceOrError, contentHash, contentSize,
+                              data);
+
+  // Failing to update the cache is not an error; the next link tries again.
+  if (!cachePath.empty()) {
+    auto ec = sys::fs::create_directories(sys::path::parent_path(cachePath));
+    if (!ec)
+      consumeError(writeToOutput(cachePath, [&](raw_ostream &os) {
+        os.write(data.data(), data.size());
+        return Error::success();
+      }));
+  }
+
+  auto file = BinaryInterfaceFile::create(
+      MemoryBuffer::getMemBufferCopy(StringRef(data.data(), data.size()),
+                                     identifier),
+      contentHash, contentSize);
+  if (!file)
+    return file.takeError();
+  return std::shared_ptr<const BinaryInterfaceFile>(std::move(*file));
+}
+
 bool LinkerInterfaceFile::isSupported(const std::string &path,
                                       const uint8_t *data,
                                       size_t size) noexcept {
@@ -230,7 +308,62 @@ bool LinkerInterfaceFile::shouldPreferTextBasedStubFile(
 
 bool LinkerInterfaceFile::areEquivalent(const std::string &tbdPath,
                                         const std::string &dylibPath) noexcept {
-  return false;
+  auto tbdBufferOrError = MemoryBuffer::getFile(tbdPath, /*IsText=*/true);
+  if (!tbdBufferOrError)
+    return false;
+  auto tbdOrError = loadBinaryFile(std::move(tbdBufferOrError.get()));
+  if (!tbdOrError) {
+    consumeError(tbdOrError.takeError());
+    return false;
+  }
+
+  auto dylibBufferOrError = MemoryBuffer::getFile(dylibPath);
+  if (!dylibBufferOrError)
+    return false;
+  auto contents = dylibBufferOrError.get()->getBuffer();
+  auto contentHash = xxHash64(contents);
+  uint64_t contentSize = contents.size();
+
+  Registry registry;
+  registry.addBinaryReaders();
+  auto apis = registry.readFile(std::move(dylibBufferOrError.get()),
+                                ReadFlags::Symbols);
+  if (!apis) {
+    consumeError(apis.takeError());
+    return false;
+  }
+
+  SmallVector<char, 0> data;
+  BinaryInterfaceFile::encode(*convertToInterfaceFile(*apis), contentHash,
+                              contentSize, data);
+  auto dylibOrError = BinaryInterfaceFile::create(
+      MemoryBuffer::getMemBufferCopy(StringRef(data.data(), data.size()),
+                                     dylibPath),
+      contentHash, contentSize);
+  if (!dylibOrError) {
+    consumeError(dylibOrError.takeError());
+    return false;
+  }
+
+  const auto &tbd = **tbdOrError;
+  const auto &dylib = **dylibOrError;
+  const auto &lhs = tbd.getDocument(0);
+  const auto &rhs = dylib.getDocument(0);
+  if (tbd.getString(lhs.installName) != dylib.getString(rhs.installName) ||
+      lhs.currentVersion != rhs.currentVersion ||
+      lhs.compatibilityVersion != rhs.compatibilityVersion ||
+      lhs.archCount != rhs.archCount)
+    return false;
+
+  // Both architecture tables are sorted, and so are the symbol tables.
+  for (auto [lhsArch, rhsArch] : zip(tbd.archs(lhs), dylib.archs(rhs))) {
+    if (lhsArch.arch != rhsArch.arch ||
+        !BinaryInterfaceFile::equalSymbols(tbd, tbd.exports(lhsArch), dylib,
+                                           dylib.exports(rhsArch)))
+      return false;
+  }
+
+  return true;
 }
 
 bool LinkerInterfaceFile::Impl::init(
@@ -397,6 +530,151 @@ bool LinkerInterfaceFile::Impl::init(
   return true;
 }
 
+bool LinkerInterfaceFile::Impl::init(
+    const std::shared_ptr<const BinaryInterfaceFile> &file, unsigned index,
+    StringRef path, cpu_type_t cpuType, cpu_subtype_t cpuSubType,
+    ParsingFlags flags, PackedVersion32 minOSVersion,
+    std::string &errorMessage) noexcept {
+  _file = file;
+  _path = path.str();
+  const auto &document = file->getDocument(index);
+  auto arch = getArchitectureFromCpuType(cpuType, cpuSubType);
+  const auto *tables = file->findArch(document, arch);
+  if (tables == nullptr) {
+    auto count = document.archCount;
+    if (count > 1)
+      errorMessage = "missing required architecture " +
+                     getArchitectureName(arch).str() + " in file " + _path +
+                     " (" + std::to_string(count) + " slices)";
+    else
+      errorMessage = "missing required architecture " +
+                     getArchitectureName(arch).str() + " in file " + _path;
+    return false;
+  }
+
+  // Remove the patch level.
+
+  auto minOSPackedVersion =
+      PackedVersion(minOSVersion.getMajor(), minOSVersion.getMinor(), 0);
+
+  for (const auto &target : file->targets(*tables)) {
+    _platforms.emplace_back(target.platform);
+    PackedVersion32 minDeployment = target.minDeployment;
+    _platformAndMinOS.emplace_back(target.platform, minDeployment);
+  }
+  llvm::sort(_platforms);
+  _installName = file->getString(document.installName).str();
+  _currentVersion = PackedVersion(document.currentVersion);
+  _compatibilityVersion = PackedVersion(document.compatibilityVersion);
+  _hasTwoLevelNamespace = document.flags & binary::TwoLevelNamespace;
+  _isAppExtensionSafe = document.flags & binary::ApplicationExtensionSafe;
+  _swiftABIVersion = document.swiftABIVersion;
+  if (tables->parentFrameworkName != binary::kNone)
+    _parentFrameworkName =
+        file->getString(tables->parentFrameworkName).str();
+
+  // Pre-scan for special linker symbols. Exports are sorted by name, so they
+  // are all in one run.
+  auto exports = file->exports(*tables);
+  const auto *first =
+      llvm::partition_point(exports, [&](const binary::SymbolEntry &entry) {
+        return file->getString(entry.name) < "$ld$";
+      });
+  for (const auto &entry : make_range(first, exports.end())) {
+    auto name = file->getString(entry.name);
+    if (!name.startswith("$ld$"))
+      break;
+    if (static_cast<SymbolKind>(entry.kind) != SymbolKind::GlobalSymbol)
+      continue;
+
+    processSymbol(name, minOSPackedVersion,
+                  flags & ParsingFlags::DisallowWeakImports);
+  }
+  sort(_ignoreExports);
+  auto last = std::unique(_ignoreExports.begin(), _ignoreExports.end());
+  _ignoreExports.erase(last, _ignoreExports.end());
+
+  bool useObjC1ABI =
+      is_contained(file->platforms(document),
+                   static_cast<uint32_t>(PLATFORM_MACOS)) &&
+      (arch == AK_i386);
+  for (const auto &entry : exports) {
+    auto name = file->getString(entry.name);
+    auto symbolFlags = static_cast<llvm::MachO::SymbolFlags>(entry.flags);
+
+    switch (static_cast<SymbolKind>(entry.kind)) {
+    case SymbolKind::GlobalSymbol:
+      if (name.startswith("$ld$") && !name.startswith("$ld$previous"))
+        continue;
+      addSymbol(name, symbolFlags);
+      break;
+    case SymbolKind::ObjectiveCClass:
+      if (useObjC1ABI) {
+        addSymbol(".objc_class_name_" + name.str(), symbolFlags);
+      } else {
+        addSymbol("_OBJC_CLASS_$_" + name.str(), symbolFlags);
+        addSymbol("_OBJC_METACLASS_$_" + name.str(), symbolFlags);
+      }
+      break;
+    case SymbolKind::ObjectiveCClassEHType:
+      addSymbol("_OBJC_EHTYPE_$_" + name.str(), symbolFlags);
+      break;
+    case SymbolKind::ObjectiveCInstanceVariable:
+      addSymbol("_OBJC_IVAR_$_" + name.str(), symbolFlags);
+      break;
+    }
+
+    if ((symbolFlags & llvm::MachO::SymbolFlags::WeakDefined) ==
+        llvm::MachO::SymbolFlags::WeakDefined)
+      _hasWeakDefExports = true;
+  }
+
+  for (const auto &entry : file->undefineds(*tables)) {
+    auto name = file->getString(entry.name);
+    auto symbolFlags = static_cast<SymbolFlags>(entry.flags);
+
+    switch (static_cast<SymbolKind>(entry.kind)) {
+    case SymbolKind::GlobalSymbol:
+      _undefineds.emplace_back(name, symbolFlags);
+      break;
+    case SymbolKind::ObjectiveCClass:
+      if (useObjC1ABI) {
+        _undefineds.emplace_back(".objc_class_name_" + name.str(),
+                                 symbolFlags);
+      } else {
+        _undefineds.emplace_back("_OBJC_CLASS_$_" + name.str(), symbolFlags);
+        _undefineds.emplace_back("_OBJC_METACLASS_$_" + name.str(),
+                                 symbolFlags);
+      }
+      break;
+    case SymbolKind::ObjectiveCClassEHType:
+      _undefineds.emplace_back("_OBJC_EHTYPE_$_" + name.str(), symbolFlags);
+      break;
+    case SymbolKind::ObjectiveCInstanceVariable:
+      _undefineds.emplace_back("_OBJC_IVAR_$_" + name.str(), symbolFlags);
+      break;
+    }
+  }
+
+  for (auto offset : file->allowableClients(*tables))
+    _allowableClients.emplace_back(file->getString(offset));
+
+  for (auto offset : file->reexportedLibraries(*tables))
+    _reexportedLibraries.emplace_back(file->getString(offset));
+
+  for (auto offset : file->rpaths(*tables))
+    _rPaths.emplace_back(file->getString(offset));
+
+  // Only the file itself lists its inlined frameworks.
+  if (index == 0) {
+    for (unsigned i = 1, e = file->getNumDocuments(); i != e; ++i)
+      _inlinedFrameworkNames.emplace_back(
+          file->getString(file->getDocument(i).installName));
+  }
+
+  return true;
+}
+
 LinkerInterfaceFile *
 LinkerInterfaceFile::create(const std::string &path, cpu_type_t cpuType,
                             cpu_subtype_t cpuSubType, ParsingFlags flags,
@@ -411,9 +689,36 @@ LinkerInterfaceFile::create(const std::string &path, cpu_type_t cpuType,
     return nullptr;
   }
 
-  auto interfaceOrError = loadFile(std::move(errorOr.get()));
-  if (!interfaceOrError) {
-    errorMessage = toString(interfaceOrError.takeError());
+  // Without a cache directory the text-based stub file is parsed and used
+  // directly; encoding it would only add work.
+  if (!getCacheDirectory()) {
+    auto interfaceOrError = loadFile(std::move(errorOr.get()));
+    if (!interfaceOrError) {
+      errorMessage = toString(interfaceOrError.takeError());
+      return nullptr;
+    }
+
+    auto *file = new LinkerInterfaceFile;
+    if (file == nullptr) {
+      errorMessage = "could not allocate memory";
+      return nullptr;
+    }
+
+    std::shared_ptr<const InterfaceFile> interface =
+        std::move(interfaceOrError.get());
+
+    if (file->_pImpl->init(interface, cpuType, cpuSubType, flags, minOSVersion,
+                           errorMessage)) {
+      return file;
+    }
+
+    delete file;
+    return nullptr;
+  }
+
+  auto fileOrError = loadBinaryFile(std::move(errorOr.get()));
+  if (!fileOrError) {
+    errorMessage = toString(fileOrError.takeError());
     return nullptr;
   }
 
@@ -423,11 +728,8 @@ LinkerInterfaceFile::create(const std::string &path, cpu_type_t cpuType,
     return nullptr;
   }
 
-  std::shared_ptr<const InterfaceFile> interface =
-      std::move(interfaceOrError.get());
-
-  if (file->_pImpl->init(interface, cpuType, cpuSubType, flags, minOSVersion,
-                         errorMessage)) {
+  if (file->_pImpl->init(*fileOrError, /*index=*/0, path, cpuType, cpuSubType,
+                         flags, minOSVersion, errorMessage)) {
     return file;
   }
 
@@ -527,13 +829,8 @@ LinkerInterfaceFile *LinkerInterfaceFile::getInlinedFramework(
     cpu_subtype_t cpuSubType, ParsingFlags flags, PackedVersion32 minOSVersion,
     std::string &errorMessage) const noexcept {
 
-  auto it = std::find_if(_pImpl->_inlinedFrameworks.begin(),
-                         _pImpl->_inlinedFrameworks.end(),
-                         [&](const std::shared_ptr<const InterfaceFile> &it) {
-                           return it->getInstallName() == installName;
-                         });
-
-  if (it == _pImpl->_inlinedFrameworks.end()) {
+  auto it = find(_pImpl->_inlinedFrameworkNames, installName);
+  if (it == _pImpl->_inlinedFrameworkNames.end()) {
     errorMessage = "no such inlined framework";
     return nullptr;
   }
@@ -544,9 +841,17 @@ LinkerInterfaceFile *LinkerInterfaceFile::getInlinedFramework(
     return nullptr;
   }
 
-  if (file->_pImpl->init(*it, cpuType, cpuSubType, flags, minOSVersion,
-                         errorMessage))
+  // Inlined frameworks follow the file in document order.
+  unsigned index = it - _pImpl->_inlinedFrameworkNames.begin();
+  if (_pImpl->_file) {
+    if (file->_pImpl->init(_pImpl->_file, 1 + index, _pImpl->_path, cpuType,
+                           cpuSubType, flags, minOSVersion, errorMessage))
+      return file;
+  } else if (file->_pImpl->init(_pImpl->_inlinedFrameworks[index], cpuType,
+                                cpuSubType, flags, minOSVersion,
+                                errorMessage)) {
     return file;
+  }
 
   delete file;
   return nullptr;
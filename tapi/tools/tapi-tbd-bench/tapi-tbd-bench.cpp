@@ -0,0 +1,201 @@
+//===- tapi-tbd-bench/tapi-tbd-bench.cpp ------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+///
+/// A tool to measure how fast text-based stub files are read.
+///
+/// All .tbd files below the given directories are loaded into memory first, so
+/// only reading is measured. Each run uses one reader, which keeps the peak
+/// memory reported by the process specific to that reader:
+///
+///   tapi-tbd-bench -reader=generic $SDKROOT
+///   tapi-tbd-bench -reader=scanner $SDKROOT
+///
+//===----------------------------------------------------------------------===//
+#include "tapi/Core/TextStubScanner.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/TextAPI/TextAPIReader.h"
+#include <sys/resource.h>
+
+using namespace llvm;
+using namespace llvm::MachO;
+using namespace TAPI_INTERNAL;
+
+enum class ReaderKind { Generic, Scanner };
+
+static cl::OptionCategory tapiCategory("tapi-tbd-bench options");
+
+static cl::opt<ReaderKind> readerKind(
+    "reader", cl::desc("reader to measure"), cl::init(ReaderKind::Scanner),
+    cl::values(clEnumValN(ReaderKind::Generic, "generic",
+                          "generic YAML reader"),
+               clEnumValN(ReaderKind::Scanner, "scanner",
+                          "text stub scanner with generic fallback")),
+    cl::cat(tapiCategory));
+
+static cl::opt<unsigned> iterations("iterations",
+                                    cl::desc("number of passes over the files"),
+                                    cl::init(5), cl::cat(tapiCategory));
+
+static cl::opt<bool> verify(
+    "verify", cl::desc("check that both readers agree instead of measuring"),
+    cl::cat(tapiCategory));
+
+static cl::list<std::string> inputs(cl::Positional, cl::OneOrMore,
+                                    cl::desc("<directory or file>..."),
+                                    cl::cat(tapiCategory));
+
+static void collectFiles(StringRef path,
+                         std::vector<std::unique_ptr<MemoryBuffer>> &buffers) {
+  auto addFile = [&](StringRef file) {
+    auto buffer = MemoryBuffer::getFile(file);
+    if (!buffer) {
+      errs() << "warning: cannot read " << file << ": "
+             << buffer.getError().message() << "\n";
+      return;
+    }
+    buffers.emplace_back(std::move(*buffer));
+  };
+
+  if (!sys::fs::is_directory(path)) {
+    addFile(path);
+    return;
+  }
+
+  std::error_code ec;
+  for (sys::fs::recursive_directory_iterator i(path, ec), e; i != e && !ec;
+       i.increment(ec)) {
+    if (sys::path::extension(i->path()) != ".tbd")
+      continue;
+    if (i->type() == sys::fs::file_type::directory_file)
+      continue;
+    addFile(i->path());
+  }
+  if (ec)
+    errs() << "warning: cannot walk " << path << ": " << ec.message() << "\n";
+}
+
+/// Peak resident set size of the process in bytes.
+static uint64_t getPeakMemory() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+int main(int argc, const char *argv[]) {
+  // Standard set up, so program fails gracefully.
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram stackPrinter(argc, argv);
+  llvm_shutdown_obj shutdown;
+
+  if (sys::Process::FixupStandardFileDescriptors())
+    return 1;
+
+  cl::HideUnrelatedOptions(tapiCategory);
+  cl::ParseCommandLineOptions(argc, argv, "TAPI Text Stub Benchmark\n");
+
+  std::vector<std::unique_ptr<MemoryBuffer>> buffers;
+  for (const auto &input : inputs)
+    collectFiles(input, buffers);
+
+  uint64_t totalBytes = 0;
+  unsigned scanned = 0;
+  for (const auto &buffer : buffers) {
+    totalBytes += buffer->getBufferSize();
+    auto bufferRef = buffer->getMemBufferRef();
+    if (hasTextStubV4Tag(bufferRef) && scanTextStub(bufferRef))
+      ++scanned;
+  }
+
+  if (verify) {
+    unsigned mismatches = 0;
+    for (const auto &buffer : buffers) {
+      auto bufferRef = buffer->getMemBufferRef();
+      auto expected = TextAPIReader::get(bufferRef);
+      auto file = readTextStub(bufferRef);
+      if (!expected || !file) {
+        // Both readers must reject the same files.
+        if (!expected != !file) {
+          errs() << "error: readers disagree on validity: "
+                 << buffer->getBufferIdentifier() << "\n";
+          ++mismatches;
+        }
+        if (!expected)
+          consumeError(expected.takeError());
+        if (!file)
+          consumeError(file.takeError());
+        continue;
+      }
+      if (!(**expected == **file)) {
+        errs() << "error: readers disagree on contents: "
+               << buffer->getBufferIdentifier() << "\n";
+        ++mismatches;
+      }
+    }
+    outs() << buffers.size() << " files, " << mismatches << " mismatches\n";
+    return mismatches != 0 ? 1 : 0;
+  }
+
+  uint64_t baseMemory = getPeakMemory();
+  unsigned failures = 0;
+  auto start = TimeRecord::getCurrentTime(/*Start=*/true);
+  for (unsigned i = 0; i < iterations; ++i) {
+    for (const auto &buffer : buffers) {
+      auto bufferRef = buffer->getMemBufferRef();
+      auto file = readerKind == ReaderKind::Generic
+                      ? TextAPIReader::get(bufferRef)
+                      : readTextStub(bufferRef);
+      if (!file) {
+        consumeError(file.takeError());
+        ++failures;
+      }
+    }
+  }
+  auto end = TimeRecord::getCurrentTime(/*Start=*/false);
+  uint64_t peakMemory = getPeakMemory();
+
+  double seconds = end.getWallTime() - start.getWallTime();
+  double megabytes = double(totalBytes) * iterations / (1024 * 1024);
+  outs() << "reader:        "
+         << (readerKind == ReaderKind::Generic ? "generic" : "scanner") << "\n"
+         << "files:         " << buffers.size() << " ("
+         << format("%.1f", double(totalBytes) / (1024 * 1024)) << " MB, "
+         << scanned << " handled by the scanner)\n"
+         << "iterations:    " << iterations << "\n"
+         << "failures:      " << failures / std::max(1U, iterations.getValue())
+         << "\n"
+         << "time:          " << format("%.3f", seconds) << " s\n"
+         << "throughput:    "
+         << format("%.1f", seconds > 0 ? megabytes / seconds : 0.0)
+         << " MB/s\n"
+         << "peak memory:   "
+         << format("%.1f", double(peakMemory) / (1024 * 1024)) << " MB ("
+         << format("%.1f",
+                   double(peakMemory - std::min(peakMemory, baseMemory)) /
+                       (1024 * 1024))
+         << " MB while reading)\n";
+
+  return 0;
+}
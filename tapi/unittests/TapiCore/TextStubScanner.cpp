@@ -0,0 +1,174 @@
+//===- unittests/TapiCore/TextStubScanner.cpp - Scanner Tests -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+#include "tapi/Core/TextStubScanner.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/TextAPI/TextAPIReader.h"
+#include "gtest/gtest.h"
+#define DEBUG_TYPE "text-stub-scanner-test"
+
+using namespace llvm;
+using namespace llvm::MachO;
+using namespace tapi::internal;
+
+static const char tbdV4File[] =
+    "--- !tapi-tbd\n"
+    "tbd-version:     4\n"
+    "targets:         [ x86_64-macos, arm64-macos, arm64-maccatalyst ]\n"
+    "uuids:\n"
+    "  - target:          x86_64-macos\n"
+    "    value:           11111111-1111-1111-1111-111111111111\n"
+    "  - target:          arm64-macos\n"
+    "    value:           22222222-2222-2222-2222-222222222222\n"
+    "flags:           [ flat_namespace, installapi ]\n"
+    "install-name:    '/System/Library/Frameworks/Umbrella.framework/"
+    "Umbrella'\n"
+    "current-version: 1.2.3\n"
+    "compatibility-version: 1.2\n"
+    "swift-abi-version: 5\n"
+    "parent-umbrella:\n"
+    "  - targets:         [ x86_64-macos, arm64-macos ]\n"
+    "    umbrella:        System\n"
+    "allowable-clients:\n"
+    "  - targets:         [ x86_64-macos ]\n"
+    "    clients:         [ ClientA, 'Client B' ]\n"
+    "reexported-libraries:\n"
+    "  - targets:         [ x86_64-macos, arm64-macos ]\n"
+    "    libraries:       [ '/System/Library/Frameworks/A.framework/A' ]\n"
+    "exports:\n"
+    "  - targets:         [ x86_64-macos, arm64-macos ]\n"
+    "    symbols:         [ '$ld$hide$os10.4$_sym', _symA, _symB,\n"
+    "                       _symC ]\n"
+    "    objc-classes:    [ ClassA ]\n"
+    "    objc-eh-types:   [ ClassA ]\n"
+    "    objc-ivars:      [ ClassA.ivar ]\n"
+    "    weak-symbols:    [ _weak ]\n"
+    "    thread-local-symbols: [ _tlv ]\n"
+    "  - targets:         [ arm64-maccatalyst ]\n"
+    "    symbols:         [ \"_quoted\", 'it''s' ]\n"
+    "# A comment line.\n"
+    "reexports:\n"
+    "  - targets:         [ x86_64-macos ]\n"
+    "    symbols:         [ _reexported ]\n"
+    "undefineds:\n"
+    "  - targets:         [ x86_64-macos ]\n"
+    "    symbols:         [ _symA, _undef ]\n"
+    "    weak-symbols:    [ _weakUndef ]\n"
+    "...\n"
+    "--- !tapi-tbd\n"
+    "tbd-version:     4\n"
+    "targets:         [ x86_64-macos ]\n"
+    "install-name:    '/System/Library/Frameworks/Inlined.framework/Inlined'\n"
+    "exports:\n"
+    "  - targets:         [ x86_64-macos ]\n"
+    "    symbols:         [ _inlined ]\n"
+    "...\n";
+
+static std::unique_ptr<InterfaceFile> readGeneric(StringRef input) {
+  auto file = TextAPIReader::get(MemoryBufferRef(input, "Test.tbd"));
+  EXPECT_TRUE(!!file);
+  if (!file) {
+    consumeError(file.takeError());
+    return nullptr;
+  }
+  return std::move(*file);
+}
+
+TEST(TextStubScanner, MatchesGenericReader) {
+  MemoryBufferRef buffer(tbdV4File, "Test.tbd");
+  EXPECT_TRUE(hasTextStubV4Tag(buffer));
+
+  auto scanned = scanTextStub(buffer);
+  ASSERT_NE(nullptr, scanned);
+  auto expected = readGeneric(tbdV4File);
+  ASSERT_NE(nullptr, expected);
+  EXPECT_TRUE(*expected == *scanned);
+
+  EXPECT_EQ(FileType::TBD_V4, scanned->getFileType());
+  EXPECT_EQ("Test.tbd", scanned->getPath());
+  EXPECT_FALSE(scanned->isTwoLevelNamespace());
+  EXPECT_EQ(1U, scanned->documents().size());
+
+  auto hasSymbol = [&](StringRef name) {
+    return any_of(scanned->symbols(), [&](const Symbol *symbol) {
+      return symbol->getName() == name;
+    });
+  };
+  EXPECT_TRUE(hasSymbol("it's"));
+  EXPECT_TRUE(hasSymbol("_quoted"));
+}
+
+TEST(TextStubScanner, FallsBack) {
+  // Each of these is valid for the generic reader, but outside of what the
+  // scanner reads.
+  static const char *inputs[] = {
+      // Older versions.
+      "--- !tapi-tbd-v3\n"
+      "archs:           [ x86_64 ]\n"
+      "platform:        macosx\n"
+      "install-name:    /usr/lib/libfoo.dylib\n"
+      "...\n",
+      // Trailing comment.
+      "--- !tapi-tbd\n"
+      "tbd-version:     4\n"
+      "targets:         [ x86_64-macos ] # comment\n"
+      "install-name:    /usr/lib/libfoo.dylib\n"
+      "...\n",
+      // Double quoted escape.
+      "--- !tapi-tbd\n"
+      "tbd-version:     4\n"
+      "targets:         [ x86_64-macos ]\n"
+      "install-name:    \"/usr/lib/lib\\x66oo.dylib\"\n"
+      "...\n",
+      // Folded plain scalar.
+      "--- !tapi-tbd\n"
+      "tbd-version:     4\n"
+      "targets:         [ x86_64-macos ]\n"
+      "install-name:    /usr/lib/libfoo.dylib\n"
+      "exports:\n"
+      "  - targets:         [ x86_64-macos ]\n"
+      "    symbols:         [ _foo\n"
+      "                       _bar ]\n"
+      "...\n",
+      // Block sequence entry at the same indentation as the key.
+      "--- !tapi-tbd\n"
+      "tbd-version:     4\n"
+      "targets:         [ x86_64-macos ]\n"
+      "install-name:    /usr/lib/libfoo.dylib\n"
+      "exports:\n"
+      "- targets:         [ x86_64-macos ]\n"
+      "  symbols:         [ _foo ]\n"
+      "...\n",
+  };
+
+  for (const auto *input : inputs) {
+    MemoryBufferRef buffer(input, "Test.tbd");
+    EXPECT_EQ(nullptr, scanTextStub(buffer)) << input;
+
+    auto expected = readGeneric(input);
+    ASSERT_NE(nullptr, expected);
+    auto file = readTextStub(buffer);
+    ASSERT_TRUE(!!file) << toString(file.takeError());
+    EXPECT_TRUE(*expected == **file) << input;
+  }
+}
+
+TEST(TextStubScanner, LeavesErrorsToGenericReader) {
+  static const char input[] = "--- !tapi-tbd\n"
+                              "tbd-version:     4\n"
+                              "targets:         [ x86_64-unknown ]\n"
+                              "install-name:    /usr/lib/libfoo.dylib\n"
+                              "...\n";
+  MemoryBufferRef buffer(input, "Test.tbd");
+  EXPECT_TRUE(hasTextStubV4Tag(buffer));
+  EXPECT_EQ(nullptr, scanTextStub(buffer));
+
+  auto file = readTextStub(buffer);
+  EXPECT_FALSE(!!file);
+  consumeError(file.takeError());
+}
@@ -165,6 +165,60 @@ TEST_F(LibTapiTest_TBDv4, LIF_LoadSymbols_x86_64) {
   checkSyms(tbd_v4_undefs, file->undefineds());
 }
 
+TEST_F(LibTapiTest_TBDv4, LIF_LoadSymbols_Cached) {
+  llvm::SmallString<PATH_MAX> cacheDir;
+  ASSERT_NO_ERROR(
+      llvm::sys::fs::createUniqueDirectory("tbd-cache", cacheDir));
+  ASSERT_EQ(0, ::setenv("TAPI_LINKER_CACHE_DIR", cacheDir.c_str(), 1));
+  writeTempFile(tbd_v4_file);
+
+  ExportedSymbolSeq tbd_v4_exports = {
+      {"_symAB", false, false, false}, {"_symB", false, false, false},
+      {"_weak0", true, false, false},  {"_weak1", true, false, false},
+      {"_weak2", true, false, false},
+  };
+
+  auto load = [&]() {
+    std::string errorMessage;
+    auto file =
+        std::unique_ptr<LinkerInterfaceFile>(LinkerInterfaceFile::create(
+            getTempFilePath(), CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL,
+            ParsingFlags::None, PackedVersion32(10, 15, 0), errorMessage));
+    ASSERT_TRUE(errorMessage.empty());
+    ASSERT_NE(nullptr, file);
+    EXPECT_EQ(
+        std::string("/System/Library/Frameworks/Umbrella.framework/Umbrella"),
+        file->getInstallName());
+    EXPECT_EQ(std::string("System"), file->getParentFrameworkName());
+    checkSyms(tbd_v4_exports, file->exports());
+  };
+
+  // The first load fills the cache and the second one maps the entry.
+  load();
+  std::error_code ec;
+  llvm::sys::fs::directory_iterator it(cacheDir, ec), end;
+  ASSERT_NO_ERROR(ec);
+  ASSERT_TRUE(it != end);
+  std::string entryPath = it->path();
+  EXPECT_TRUE(llvm::StringRef(entryPath).endswith(".tbdb"));
+  load();
+
+  // A damaged entry is ignored and replaced.
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream entry(entryPath, ec);
+    ASSERT_NO_ERROR(ec);
+    entry << "garbage";
+  }
+  load();
+  uint64_t size = 0;
+  ASSERT_NO_ERROR(llvm::sys::fs::file_size(entryPath, size));
+  EXPECT_LT(7U, size);
+
+  ::unsetenv("TAPI_LINKER_CACHE_DIR");
+  ASSERT_NO_ERROR(llvm::sys::fs::remove_directories(cacheDir));
+}
+
 TEST_F(LibTapiTest_TBDv4, LIF_LoadSymbols_i386) {
   writeTempFile(tbd_v4_file);
   std::string errorMessage;